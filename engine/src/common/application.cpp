@@ -3,12 +3,68 @@
 // ============================================================================
 
 #include "application.h"
+#include "frame_profiler.h"
+#include "program_cache.h"
+#include "shader_watcher.h"
+#include "texture_cache.h"
+#include "texture_residency.h"
+#include "texture_streamer.h"
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
 
+// ============================================================================
+// 无头模式默认值
+// ============================================================================
+namespace
+{
+    const unsigned int DEFAULT_HEADLESS_FRAMES = 300;        // 默认渲染帧数
+    const float HEADLESS_DELTA_TIME = 1.0f / 60.0f;          // 固定时间步长
+
+    bool s_headlessDefault = false;
+    unsigned int s_headlessFramesDefault = 0;
+    unsigned int s_widthDefault = 0;
+    unsigned int s_heightDefault = 0;
+
+    // 环境变量 OPENGL_HEADLESS 是否开启（非空且不为 "0"）
+    bool HeadlessFromEnv()
+    {
+        const char* value = std::getenv("OPENGL_HEADLESS");
+        return value && value[0] != '\0' && std::strcmp(value, "0") != 0;
+    }
+
+    // 解析帧数：显式参数 > 进程默认值 > 环境变量 > 默认值
+    unsigned int ResolveFrameCount(unsigned int requested)
+    {
+        if (requested > 0)
+            return requested;
+        if (s_headlessFramesDefault > 0)
+            return s_headlessFramesDefault;
+        if (const char* value = std::getenv("OPENGL_HEADLESS_FRAMES"))
+        {
+            long frames = std::strtol(value, nullptr, 10);
+            if (frames > 0)
+                return static_cast<unsigned int>(frames);
+        }
+        return DEFAULT_HEADLESS_FRAMES;
+    }
+
+    // 是否显式设置了帧数（参数、进程默认值或环境变量），而不是使用默认值
+    bool FrameCountSet(unsigned int requested)
+    {
+        if (requested > 0 || s_headlessFramesDefault > 0)
+            return true;
+        const char* value = std::getenv("OPENGL_HEADLESS_FRAMES");
+        return value && std::strtol(value, nullptr, 10) > 0;
+    }
+}
+
 // ============================================================================
 // 构造函数
 // ============================================================================
-Application::Application(unsigned int width, unsigned int height, const std::string& title)
+Application::Application(unsigned int width, unsigned int height, const std::string& title,
+                         bool headless)
     : m_width(width)
     , m_height(height)
     , m_title(title)
@@ -19,7 +75,50 @@ Application::Application(unsigned int width, unsigned int height, const std::str
     , m_lastX(width / 2.0f)
     , m_lastY(height / 2.0f)
     , m_mouseCaptured(false)
+    , m_headless(headless || s_headlessDefault || HeadlessFromEnv())
+    , m_frameCount(ResolveFrameCount(0))
+    , m_frameCountSet(FrameCountSet(0))
+    , m_frameIndex(0)
+    , m_simulatedTime(0.0f)
+    , m_offscreenFBO(0)
+    , m_offscreenColor(0)
+    , m_offscreenDepth(0)
 {
+    // 基准测试等工具可以统一覆盖 lesson 的分辨率
+    if (s_widthDefault > 0 && s_heightDefault > 0)
+    {
+        m_width = s_widthDefault;
+        m_height = s_heightDefault;
+        m_lastX = m_width / 2.0f;
+        m_lastY = m_height / 2.0f;
+    }
+}
+
+// ============================================================================
+// 设置无头模式
+// ============================================================================
+void Application::SetHeadless(bool headless, unsigned int frameCount)
+{
+    if (m_window)
+    {
+        std::cout << "SetHeadless() must be called before Initialize()" << std::endl;
+        return;
+    }
+    m_headless = headless;
+    m_frameCount = ResolveFrameCount(frameCount);
+    m_frameCountSet = FrameCountSet(frameCount);
+}
+
+void Application::SetHeadlessDefault(bool headless, unsigned int frameCount)
+{
+    s_headlessDefault = headless;
+    s_headlessFramesDefault = frameCount;
+}
+
+void Application::SetResolutionDefault(unsigned int width, unsigned int height)
+{
+    s_widthDefault = width;
+    s_heightDefault = height;
 }
 
 // ============================================================================
@@ -35,6 +134,13 @@ Application::~Application()
 // ============================================================================
 bool Application::Initialize()
 {
+    auto initStart = std::chrono::steady_clock::now();
+    ProgramCacheStats shaderStart = ProgramCache::stats();
+
+    // 选择平台：无头模式使用 null 平台（不需要显示服务器）
+    // 注意：init hint 在 glfwTerminate 之后依然保留，所以两种模式都要显式设置
+    glfwInitHint(GLFW_PLATFORM, m_headless ? GLFW_PLATFORM_NULL : GLFW_ANY_PLATFORM);
+
     // 初始化 GLFW
     if (!glfwInit())
     {
@@ -42,18 +148,8 @@ bool Application::Initialize()
         return false;
     }
 
-    // 配置 GLFW
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
-    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
-
-#ifdef __APPLE__
-    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
-#endif
-
     // 创建窗口
-    m_window = glfwCreateWindow(m_width, m_height, m_title.c_str(), NULL, NULL);
-    if (m_window == NULL)
+    if (!CreateContextWindow())
     {
         std::cout << "Failed to create GLFW window" << std::endl;
         glfwTerminate();
@@ -78,15 +174,118 @@ bool Application::Initialize()
         return false;
     }
 
+    // 无头模式：创建离屏渲染目标
+    if (m_headless && !CreateOffscreenTarget())
+    {
+        std::cout << "Failed to create offscreen framebuffer" << std::endl;
+        return false;
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, m_offscreenFBO);
+    glViewport(0, 0, m_width, m_height);
+
     // 启用深度测试
     glEnable(GL_DEPTH_TEST);
 
+    // 基准测试：安装绘制调用计数钩子和 GPU 计时查询
+    // 同时关闭垂直同步，避免帧时间被显示器刷新率限制
+    if (FrameProfiler* profiler = FrameProfiler::Active())
+    {
+        profiler->Attach();
+        glfwSwapInterval(0);
+    }
+
     // 调用子类的初始化函数
     OnInitialize();
 
+    // 基准测试：记录启动耗时（着色器在 OnInitialize 中创建）
+    if (FrameProfiler* profiler = FrameProfiler::Active())
+    {
+        const ProgramCacheStats& shaderEnd = ProgramCache::stats();
+        StartupSample startup;
+        startup.initMs = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - initStart).count();
+        startup.shaderMs = shaderEnd.buildMs - shaderStart.buildMs;
+        startup.shaderCacheHits = shaderEnd.hits - shaderStart.hits;
+        startup.shaderCacheMisses = shaderEnd.misses - shaderStart.misses;
+        profiler->SetStartup(startup);
+    }
+
     return true;
 }
 
+// ============================================================================
+// 创建窗口和 OpenGL 上下文
+// ============================================================================
+bool Application::CreateContextWindow()
+{
+    // 配置 GLFW
+    glfwDefaultWindowHints();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+#ifdef __APPLE__
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+
+    if (!m_headless)
+    {
+        m_window = glfwCreateWindow(m_width, m_height, m_title.c_str(), NULL, NULL);
+        return m_window != NULL;
+    }
+
+    // 无头模式：不可见窗口 + 软件渲染上下文
+    // 优先 OSMesa，不可用时退回 EGL（null 平台下为 surfaceless）
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_OSMESA_CONTEXT_API);
+    m_window = glfwCreateWindow(m_width, m_height, m_title.c_str(), NULL, NULL);
+    if (m_window == NULL)
+    {
+        std::cout << "OSMesa context unavailable, falling back to EGL" << std::endl;
+        glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_EGL_CONTEXT_API);
+        m_window = glfwCreateWindow(m_width, m_height, m_title.c_str(), NULL, NULL);
+    }
+    return m_window != NULL;
+}
+
+// ============================================================================
+// 创建/销毁离屏渲染目标（无头模式）
+// ============================================================================
+bool Application::CreateOffscreenTarget()
+{
+    glGenFramebuffers(1, &m_offscreenFBO);
+    glBindFramebuffer(GL_FRAMEBUFFER, m_offscreenFBO);
+
+    // 颜色附件
+    glGenRenderbuffers(1, &m_offscreenColor);
+    glBindRenderbuffer(GL_RENDERBUFFER, m_offscreenColor);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, m_width, m_height);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, m_offscreenColor);
+
+    // 深度和模板附件（模板缓冲 lesson 需要）
+    glGenRenderbuffers(1, &m_offscreenDepth);
+    glBindRenderbuffer(GL_RENDERBUFFER, m_offscreenDepth);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, m_width, m_height);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, m_offscreenDepth);
+
+    bool complete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+    return complete;
+}
+
+void Application::DestroyOffscreenTarget()
+{
+    if (m_offscreenFBO)
+    {
+        glDeleteFramebuffers(1, &m_offscreenFBO);
+        glDeleteRenderbuffers(1, &m_offscreenColor);
+        glDeleteRenderbuffers(1, &m_offscreenDepth);
+        m_offscreenFBO = 0;
+        m_offscreenColor = 0;
+        m_offscreenDepth = 0;
+    }
+}
+
 // ============================================================================
 // 运行应用程序
 // ============================================================================
@@ -98,25 +297,65 @@ void Application::Run()
         return;
     }
 
+    m_frameIndex = 0;
+    m_simulatedTime = 0.0f;
+    FrameProfiler* profiler = FrameProfiler::Active();
+
     while (!glfwWindowShouldClose(m_window))
     {
-        // 计算时间差
-        float currentFrame = static_cast<float>(glfwGetTime());
-        m_deltaTime = currentFrame - m_lastFrame;
-        m_lastFrame = currentFrame;
+        // 无头模式、设置了帧数或正在做基准测试（--bench --windowed）时：渲染固定帧数后退出
+        if ((m_headless || m_frameCountSet || profiler) && m_frameIndex >= m_frameCount)
+            break;
+
+        // 计算时间差（无头模式使用固定步长，保证结果可复现）
+        if (m_headless)
+        {
+            m_deltaTime = HEADLESS_DELTA_TIME;
+            m_simulatedTime += HEADLESS_DELTA_TIME;
+        }
+        else
+        {
+            float currentFrame = static_cast<float>(glfwGetTime());
+            m_deltaTime = currentFrame - m_lastFrame;
+            m_lastFrame = currentFrame;
+        }
 
         // 处理输入
         glfwPollEvents();
 
+        // 着色器热重载：在帧边界替换源文件发生变化的着色器
+        if (ShaderWatcher::IsActive())
+            ShaderWatcher::Instance().Poll();
+
+        if (profiler)
+            profiler->BeginFrame();
+
+        // 按显存预算释放或补回纹理的 mip 级别，再按每帧预算上传排队的纹理（耗时计入这一帧）
+        TextureResidency::Instance().update();
+        TextureStreamer::Instance().update();
+
         // 更新
         OnUpdate(m_deltaTime);
 
         // 渲染
+        glBindFramebuffer(GL_FRAMEBUFFER, m_offscreenFBO);
         OnRender();
 
-        // 交换缓冲区
-        glfwSwapBuffers(m_window);
+        // 交换缓冲区（离屏渲染不需要交换，只提交命令）
+        if (m_headless)
+            glFlush();
+        else
+            glfwSwapBuffers(m_window);
+
+        if (profiler)
+            profiler->EndFrame();
+
+        m_frameIndex++;
     }
+
+    // 等待最后一帧完成
+    if (m_headless)
+        glFinish();
 }
 
 // ============================================================================
@@ -127,6 +366,14 @@ void Application::Cleanup()
     if (m_window)
     {
         OnCleanup();
+        OnReleaseResources();
+        // 共享纹理缓存中剩下的纹理和上传用的 PBO 属于这个上下文，销毁上下文之前删除
+        TextureResidency::Instance().clear();
+        TextureStreamer::Instance().clear();
+        TextureCache::Instance().clear();
+        if (FrameProfiler* profiler = FrameProfiler::Active())
+            profiler->Detach();
+        DestroyOffscreenTarget();
         glfwTerminate();
         m_window = nullptr;
     }
@@ -137,6 +384,10 @@ void Application::Cleanup()
 // ============================================================================
 void Application::OnFramebufferSize(int width, int height)
 {
+    // 无头模式下离屏目标尺寸固定，忽略窗口尺寸变化
+    if (m_headless)
+        return;
+
     m_width = width;
     m_height = height;
     glViewport(0, 0, width, height);
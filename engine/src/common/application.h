@@ -7,6 +7,7 @@
 // 3. 输入处理（键盘、鼠标、滚轮）
 // 4. 渲染循环
 // 5. 时间管理（deltaTime）
+// 6. 无头模式（Headless）：无显示/无 GPU 的机器上离屏渲染固定帧数
 // ============================================================================
 
 #pragma once
@@ -28,8 +29,10 @@ public:
     // ========================================================================
     // 构造函数和析构函数
     // ========================================================================
+    // headless 为 true 时使用无头模式；也可以通过环境变量 OPENGL_HEADLESS=1 开启
     Application(unsigned int width = 800, unsigned int height = 600, 
-                const std::string& title = "OpenGL Application");
+                const std::string& title = "OpenGL Application",
+                bool headless = false);
     virtual ~Application();
 
     // ========================================================================
@@ -44,6 +47,28 @@ public:
     // 清理资源
     void Cleanup();
 
+    // ========================================================================
+    // 无头模式（必须在 Initialize() 之前设置）
+    // ========================================================================
+    // 无头模式下使用 GLFW 的 null 平台 + OSMesa（失败时退回 EGL）创建上下文，
+    // 场景渲染到离屏 FBO，Run() 以固定时间步长执行 frameCount 帧后返回
+    // frameCount 为 0 时使用环境变量 OPENGL_HEADLESS_FRAMES 或默认值
+    void SetHeadless(bool headless, unsigned int frameCount = 0);
+    bool IsHeadless() const { return m_headless; }
+    unsigned int GetFrameCount() const { return m_frameCount; }
+    unsigned int GetFrameIndex() const { return m_frameIndex; }
+
+    // 进程级默认值：之后构造的 Application 都会使用无头模式
+    static void SetHeadlessDefault(bool headless, unsigned int frameCount = 0);
+
+    // 进程级分辨率覆盖（基准测试用）：之后构造的 Application 使用该分辨率
+    // width/height 为 0 表示使用构造函数参数
+    static void SetResolutionDefault(unsigned int width, unsigned int height);
+
+    // 场景最终输出的帧缓冲（窗口模式为 0，无头模式为离屏 FBO）
+    // 需要"渲染回屏幕"的 lesson 应绑定它而不是直接绑定 0
+    unsigned int GetDefaultFramebuffer() const { return m_offscreenFBO; }
+
     // ========================================================================
     // 获取窗口信息
     // ========================================================================
@@ -51,7 +76,8 @@ public:
     unsigned int GetWidth() const { return m_width; }
     unsigned int GetHeight() const { return m_height; }
     float GetDeltaTime() const { return m_deltaTime; }
-    float GetTime() const { return static_cast<float>(glfwGetTime()); }
+    // 无头模式下返回模拟时间，保证每次运行结果一致
+    float GetTime() const { return m_headless ? m_simulatedTime : static_cast<float>(glfwGetTime()); }
 
 protected:
     // ========================================================================
@@ -70,6 +96,10 @@ protected:
     // 清理资源（在窗口关闭前调用）
     virtual void OnCleanup() {}
     
+    // 释放基类自己持有的 GL 资源（在 OnCleanup 之后、上下文销毁之前调用）
+    // 子类的 OnCleanup 通常不调用基类实现，所以基类资源单独在这里释放
+    virtual void OnReleaseResources() {}
+    
     // 窗口大小改变回调
     virtual void OnFramebufferSize(int width, int height);
     
@@ -103,7 +133,22 @@ protected:
     float m_lastY;
     bool m_mouseCaptured;
 
+    // 无头模式
+    bool m_headless;
+    unsigned int m_frameCount;      // 无头模式下要渲染的帧数
+    bool m_frameCountSet;           // 显式设置了帧数：窗口模式下也在 m_frameCount 帧后退出
+    unsigned int m_frameIndex;      // 当前帧序号
+    float m_simulatedTime;          // 无头模式下的模拟时间
+    unsigned int m_offscreenFBO;    // 离屏帧缓冲
+    unsigned int m_offscreenColor;  // 离屏颜色附件（渲染缓冲）
+    unsigned int m_offscreenDepth;  // 离屏深度/模板附件（渲染缓冲）
+
 private:
+    // 创建窗口和上下文（窗口模式 / 无头模式）
+    bool CreateContextWindow();
+    bool CreateOffscreenTarget();
+    void DestroyOffscreenTarget();
+
     // ========================================================================
     // 静态回调函数（GLFW 需要 C 风格函数）
     // ========================================================================
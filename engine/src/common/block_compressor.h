@@ -0,0 +1,437 @@
+// ============================================================================
+// BlockCompressor - BC1/BC3/BC4/BC5/BC7 块压缩编码
+// ============================================================================
+// 块压缩纹理以 4x4 像素为一块，显卡直接采样压缩数据：
+//   BC1  RGB，    每块 8 字节（4 bpp，RGB8 的 1/6）
+//   BC3  RGBA，   每块 16 字节（BC4 编码的 alpha + BC1 编码的颜色）
+//   BC4  单通道， 每块 8 字节
+//   BC5  双通道， 每块 16 字节（两个 BC4）
+//   BC7  RGBA，   每块 16 字节，质量比 BC1/BC3 好得多
+//
+// 编码器追求的是简单和足够快，不是最好的质量：
+//   - BC1/BC7 用主成分方向上的两个极值作为端点，按端点选索引后再用最小二乘
+//     重新拟合一次端点，保留误差更小的结果
+//   - BC7 只使用模式 6（单个子集，RGBA 端点 7 位 + p 位，4 位索引）
+//
+// 所有函数只读写传入的内存，可以在任意线程调用
+// ============================================================================
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+class BlockCompressor
+{
+public:
+    // ========================================================================
+    // BC1：rgba 为 16 个像素（按行排列，每个像素 4 字节，alpha 忽略）
+    // ========================================================================
+    static void encodeBC1(const uint8_t rgba[64], uint8_t out[8])
+    {
+        float pixels[16][4];
+        toFloat(rgba, pixels, 3);
+
+        float lo[4], hi[4];
+        principalExtremes(pixels, 3, lo, hi);
+        inset(lo, hi, 3, 1.0f / 16.0f);
+
+        uint16_t c0 = to565(hi), c1 = to565(lo);
+        uint32_t indices = 0;
+        float error = fitBC1(pixels, c0, c1, indices);
+
+        // 按当前索引用最小二乘重新求端点
+        static const float WEIGHTS[4] = { 0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f };   // c1 的权重
+        uint8_t selectors[16];
+        for (int i = 0; i < 16; i++)
+            selectors[i] = (indices >> (2 * i)) & 3;
+        float refinedLo[4], refinedHi[4];
+        if (leastSquares(pixels, 3, selectors, WEIGHTS, refinedHi, refinedLo))
+        {
+            uint16_t r0 = to565(refinedHi), r1 = to565(refinedLo);
+            uint32_t refinedIndices = 0;
+            float refinedError = fitBC1(pixels, r0, r1, refinedIndices);
+            if (refinedError < error)
+            {
+                c0 = r0;
+                c1 = r1;
+                indices = refinedIndices;
+            }
+        }
+
+        out[0] = c0 & 0xFF;
+        out[1] = c0 >> 8;
+        out[2] = c1 & 0xFF;
+        out[3] = c1 >> 8;
+        for (int i = 0; i < 4; i++)
+            out[4 + i] = (indices >> (8 * i)) & 0xFF;
+    }
+
+    // ========================================================================
+    // BC4：values 为 16 个单通道值（stride 为相邻像素的字节间隔）
+    // ========================================================================
+    static void encodeBC4(const uint8_t* values, int stride, uint8_t out[8])
+    {
+        int lo = 255, hi = 0;
+        for (int i = 0; i < 16; i++)
+        {
+            lo = std::min(lo, int(values[i * stride]));
+            hi = std::max(hi, int(values[i * stride]));
+        }
+
+        // a0 > a1：8 个值的模式（两个端点 + 6 个插值）
+        int palette[8];
+        palette[0] = hi;
+        palette[1] = lo;
+        for (int i = 1; i < 7; i++)
+            palette[i + 1] = ((7 - i) * hi + i * lo + 3) / 7;
+
+        uint64_t bits = 0;
+        for (int i = 0; i < 16; i++)
+        {
+            int value = values[i * stride];
+            int best = 0, bestError = 256;
+            for (int p = 0; p < 8 && hi != lo; p++)
+            {
+                int error = std::abs(palette[p] - value);
+                if (error < bestError)
+                {
+                    bestError = error;
+                    best = p;
+                }
+            }
+            bits |= uint64_t(best) << (3 * i);
+        }
+
+        out[0] = static_cast<uint8_t>(hi);
+        out[1] = static_cast<uint8_t>(lo);
+        for (int i = 0; i < 6; i++)
+            out[2 + i] = (bits >> (8 * i)) & 0xFF;
+    }
+
+    // BC3 = alpha 的 BC4 块 + 颜色的 BC1 块
+    static void encodeBC3(const uint8_t rgba[64], uint8_t out[16])
+    {
+        encodeBC4(rgba + 3, 4, out);
+        encodeBC1(rgba, out + 8);
+    }
+
+    // BC5 = 红、绿两个 BC4 块
+    static void encodeBC5(const uint8_t rgba[64], uint8_t out[16])
+    {
+        encodeBC4(rgba, 4, out);
+        encodeBC4(rgba + 1, 4, out + 8);
+    }
+
+    // ========================================================================
+    // BC7 模式 6
+    // ========================================================================
+    static void encodeBC7(const uint8_t rgba[64], uint8_t out[16])
+    {
+        float pixels[16][4];
+        toFloat(rgba, pixels, 4);
+
+        float lo[4], hi[4];
+        principalExtremes(pixels, 4, lo, hi);
+        inset(lo, hi, 4, 1.0f / 32.0f);
+
+        Bc7Endpoints endpoints;
+        quantizeBC7(lo, endpoints.q[0], endpoints.p[0]);
+        quantizeBC7(hi, endpoints.q[1], endpoints.p[1]);
+        uint8_t selectors[16];
+        float error = fitBC7(pixels, endpoints, selectors);
+
+        float weights[16];
+        for (int i = 0; i < 16; i++)
+            weights[i] = BC7_WEIGHTS[i] / 64.0f;
+        float refinedLo[4], refinedHi[4];
+        if (leastSquares(pixels, 4, selectors, weights, refinedLo, refinedHi))
+        {
+            Bc7Endpoints refined;
+            quantizeBC7(refinedLo, refined.q[0], refined.p[0]);
+            quantizeBC7(refinedHi, refined.q[1], refined.p[1]);
+            uint8_t refinedSelectors[16];
+            float refinedError = fitBC7(pixels, refined, refinedSelectors);
+            if (refinedError < error)
+            {
+                endpoints = refined;
+                std::memcpy(selectors, refinedSelectors, sizeof(selectors));
+            }
+        }
+
+        // 第一个像素的索引（锚点）只存 3 位，最高位必须为 0：否则交换端点、反转索引
+        if (selectors[0] & 8)
+        {
+            std::swap(endpoints.q[0], endpoints.q[1]);
+            std::swap(endpoints.p[0], endpoints.p[1]);
+            for (int i = 0; i < 16; i++)
+                selectors[i] = 15 - selectors[i];
+        }
+
+        BitWriter writer(out);
+        writer.write(1 << 6, 7);                       // 模式 6
+        for (int c = 0; c < 4; c++)
+        {
+            writer.write(endpoints.q[0][c], 7);
+            writer.write(endpoints.q[1][c], 7);
+        }
+        writer.write(endpoints.p[0], 1);
+        writer.write(endpoints.p[1], 1);
+        writer.write(selectors[0], 3);
+        for (int i = 1; i < 16; i++)
+            writer.write(selectors[i], 4);
+    }
+
+private:
+    // BC7 4 位索引的插值权重（/64）
+    static constexpr int BC7_WEIGHTS[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+    struct Bc7Endpoints {
+        int q[2][4];     // 7 位端点
+        int p[2];        // p 位
+    };
+
+    struct BitWriter {
+        explicit BitWriter(uint8_t* out) : out(out), position(0) { std::memset(out, 0, 16); }
+        void write(uint32_t value, int bits)
+        {
+            for (int i = 0; i < bits; i++, position++)
+                out[position >> 3] |= ((value >> i) & 1) << (position & 7);
+        }
+        uint8_t* out;
+        int position;
+    };
+
+    static void toFloat(const uint8_t rgba[64], float pixels[16][4], int channels)
+    {
+        for (int i = 0; i < 16; i++)
+        {
+            for (int c = 0; c < 4; c++)
+                pixels[i][c] = c < channels ? float(rgba[i * 4 + c]) : 0.0f;
+        }
+    }
+
+    // 主成分方向（幂迭代）上投影最小和最大的两个点
+    static void principalExtremes(const float pixels[16][4], int channels, float lo[4], float hi[4])
+    {
+        float mean[4] = {};
+        for (int i = 0; i < 16; i++)
+            for (int c = 0; c < channels; c++)
+                mean[c] += pixels[i][c] / 16.0f;
+
+        float covariance[4][4] = {};
+        for (int i = 0; i < 16; i++)
+            for (int a = 0; a < channels; a++)
+                for (int b = 0; b < channels; b++)
+                    covariance[a][b] += (pixels[i][a] - mean[a]) * (pixels[i][b] - mean[b]);
+
+        float axis[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+        for (int iteration = 0; iteration < 8; iteration++)
+        {
+            float next[4] = {};
+            float length = 0.0f;
+            for (int a = 0; a < channels; a++)
+            {
+                for (int b = 0; b < channels; b++)
+                    next[a] += covariance[a][b] * axis[b];
+                length = std::max(length, std::fabs(next[a]));
+            }
+            if (length < 1e-6f)
+                break;
+            for (int a = 0; a < channels; a++)
+                axis[a] = next[a] / length;
+        }
+
+        float minProjection = 1e30f, maxProjection = -1e30f;
+        int minIndex = 0, maxIndex = 0;
+        for (int i = 0; i < 16; i++)
+        {
+            float projection = 0.0f;
+            for (int c = 0; c < channels; c++)
+                projection += (pixels[i][c] - mean[c]) * axis[c];
+            if (projection < minProjection)
+            {
+                minProjection = projection;
+                minIndex = i;
+            }
+            if (projection > maxProjection)
+            {
+                maxProjection = projection;
+                maxIndex = i;
+            }
+        }
+        for (int c = 0; c < 4; c++)
+        {
+            lo[c] = pixels[minIndex][c];
+            hi[c] = pixels[maxIndex][c];
+        }
+    }
+
+    // 端点向内收缩一点，减小量化后两端的误差
+    static void inset(float lo[4], float hi[4], int channels, float amount)
+    {
+        for (int c = 0; c < channels; c++)
+        {
+            float delta = (hi[c] - lo[c]) * amount;
+            lo[c] += delta;
+            hi[c] -= delta;
+        }
+    }
+
+    // ========================================================================
+    // 已知每个像素的索引（对应的 hi 端点权重为 weights[索引]），最小二乘求两个端点
+    // ========================================================================
+    static bool leastSquares(const float pixels[16][4], int channels, const uint8_t selectors[16],
+                             const float* weights, float lo[4], float hi[4])
+    {
+        // 像素 = (1 - w) * lo + w * hi
+        float aa = 0.0f, ab = 0.0f, bb = 0.0f;
+        float ax[4] = {}, bx[4] = {};
+        for (int i = 0; i < 16; i++)
+        {
+            float w = weights[selectors[i]];
+            float a = 1.0f - w, b = w;
+            aa += a * a;
+            ab += a * b;
+            bb += b * b;
+            for (int c = 0; c < channels; c++)
+            {
+                ax[c] += a * pixels[i][c];
+                bx[c] += b * pixels[i][c];
+            }
+        }
+        float determinant = aa * bb - ab * ab;
+        if (std::fabs(determinant) < 1e-6f)
+            return false;
+        for (int c = 0; c < 4; c++)
+        {
+            lo[c] = c < channels ? std::clamp((ax[c] * bb - bx[c] * ab) / determinant, 0.0f, 255.0f) : 0.0f;
+            hi[c] = c < channels ? std::clamp((bx[c] * aa - ax[c] * ab) / determinant, 0.0f, 255.0f) : 0.0f;
+        }
+        return true;
+    }
+
+    static uint16_t to565(const float color[4])
+    {
+        int r = std::clamp(int(color[0] * 31.0f / 255.0f + 0.5f), 0, 31);
+        int g = std::clamp(int(color[1] * 63.0f / 255.0f + 0.5f), 0, 63);
+        int b = std::clamp(int(color[2] * 31.0f / 255.0f + 0.5f), 0, 31);
+        return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+    }
+
+    static void from565(uint16_t color, int out[3])
+    {
+        int r = (color >> 11) & 31, g = (color >> 5) & 63, b = color & 31;
+        out[0] = (r << 3) | (r >> 2);
+        out[1] = (g << 2) | (g >> 4);
+        out[2] = (b << 3) | (b >> 2);
+    }
+
+    // ========================================================================
+    // 给定端点，选每个像素最近的调色板颜色，返回总误差
+    // ========================================================================
+    // 4 色模式要求 c0 > c1，这里必要时交换端点；c0 == c1 时所有索引为 0
+    // ========================================================================
+    static float fitBC1(const float pixels[16][4], uint16_t& c0, uint16_t& c1, uint32_t& indices)
+    {
+        if (c0 < c1)
+            std::swap(c0, c1);
+
+        int palette[4][3];
+        from565(c0, palette[0]);
+        from565(c1, palette[1]);
+        for (int c = 0; c < 3; c++)
+        {
+            palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+            palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+        }
+        int count = c0 == c1 ? 1 : 4;
+
+        indices = 0;
+        float total = 0.0f;
+        for (int i = 0; i < 16; i++)
+        {
+            int best = 0;
+            float bestError = 1e30f;
+            for (int p = 0; p < count; p++)
+            {
+                float error = 0.0f;
+                for (int c = 0; c < 3; c++)
+                {
+                    float d = pixels[i][c] - palette[p][c];
+                    error += d * d;
+                }
+                if (error < bestError)
+                {
+                    bestError = error;
+                    best = p;
+                }
+            }
+            indices |= uint32_t(best) << (2 * i);
+            total += bestError;
+        }
+        return total;
+    }
+
+    // 把端点量化为 7 位 + p 位（4 个通道共用 p 位，选误差小的）
+    static void quantizeBC7(const float color[4], int q[4], int& p)
+    {
+        float bestError = 1e30f;
+        for (int bit = 0; bit < 2; bit++)
+        {
+            int candidate[4];
+            float error = 0.0f;
+            for (int c = 0; c < 4; c++)
+            {
+                candidate[c] = std::clamp(int((color[c] - bit) / 2.0f + 0.5f), 0, 127);
+                float d = float((candidate[c] << 1) | bit) - color[c];
+                error += d * d;
+            }
+            if (error < bestError)
+            {
+                bestError = error;
+                p = bit;
+                std::memcpy(q, candidate, sizeof(candidate));
+            }
+        }
+    }
+
+    static float fitBC7(const float pixels[16][4], const Bc7Endpoints& endpoints, uint8_t selectors[16])
+    {
+        int e[2][4];
+        for (int k = 0; k < 2; k++)
+            for (int c = 0; c < 4; c++)
+                e[k][c] = (endpoints.q[k][c] << 1) | endpoints.p[k];
+
+        int palette[16][4];
+        for (int i = 0; i < 16; i++)
+            for (int c = 0; c < 4; c++)
+                palette[i][c] = ((64 - BC7_WEIGHTS[i]) * e[0][c] + BC7_WEIGHTS[i] * e[1][c] + 32) >> 6;
+
+        float total = 0.0f;
+        for (int i = 0; i < 16; i++)
+        {
+            int best = 0;
+            float bestError = 1e30f;
+            for (int p = 0; p < 16; p++)
+            {
+                float error = 0.0f;
+                for (int c = 0; c < 4; c++)
+                {
+                    float d = pixels[i][c] - palette[p][c];
+                    error += d * d;
+                }
+                if (error < bestError)
+                {
+                    bestError = error;
+                    best = p;
+                }
+            }
+            selectors[i] = static_cast<uint8_t>(best);
+            total += bestError;
+        }
+        return total;
+    }
+};
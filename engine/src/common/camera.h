@@ -157,6 +157,19 @@ public:
         updateCameraVectors();
     }
 
+    // ========================================================================
+    // 朝向指定目标点
+    // ========================================================================
+    // 根据目标方向反算欧拉角（用于脚本化的相机路径）
+    // ========================================================================
+    void LookAt(const glm::vec3& target)
+    {
+        glm::vec3 direction = glm::normalize(target - Position);
+        Pitch = glm::degrees(asin(glm::clamp(direction.y, -1.0f, 1.0f)));
+        Yaw   = glm::degrees(atan2(direction.z, direction.x));
+        updateCameraVectors();
+    }
+
     // ========================================================================
     // 处理鼠标滚轮
     // ========================================================================
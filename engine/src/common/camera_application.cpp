@@ -3,6 +3,12 @@
 // ============================================================================
 
 #include "camera_application.h"
+#include <glm/gtc/constants.hpp>
+
+namespace
+{
+    bool s_scriptedCameraDefault = false;
+}
 
 // ============================================================================
 // 构造函数
@@ -11,9 +17,16 @@ CameraApplication::CameraApplication(unsigned int width, unsigned int height,
                                     const std::string& title, glm::vec3 cameraPos)
     : Application(width, height, title)
     , m_camera(cameraPos)
+    , m_initialCameraPos(cameraPos)
+    , m_scriptedCamera(s_scriptedCameraDefault)
 {
 }
 
+void CameraApplication::SetScriptedCameraDefault(bool scripted)
+{
+    s_scriptedCameraDefault = scripted;
+}
+
 // ============================================================================
 // 初始化（启用鼠标捕获）
 // ============================================================================
@@ -37,6 +50,12 @@ void CameraApplication::OnKey(int key, int scancode, int action, int mods)
 // ============================================================================
 void CameraApplication::OnUpdate(float deltaTime)
 {
+    if (m_scriptedCamera)
+    {
+        UpdateScriptedCamera();
+        return;
+    }
+
     // 每帧检查按键状态（持续移动）
     GLFWwindow* window = GetWindow();
     if (window)
@@ -60,12 +79,36 @@ void CameraApplication::OnUpdate(float deltaTime)
     }
 }
 
+// ============================================================================
+// 脚本化相机路径
+// ============================================================================
+// 在 GetFrameCount() 帧内绕原点转一整圈，半径为初始位置到原点的水平距离
+// 高度在初始高度附近上下浮动，只依赖帧序号，与帧率无关
+// ============================================================================
+void CameraApplication::UpdateScriptedCamera()
+{
+    float radius = glm::length(glm::vec2(m_initialCameraPos.x, m_initialCameraPos.z));
+    if (radius < 1.0f)
+        radius = 3.0f;
+    float startAngle = atan2(m_initialCameraPos.x, m_initialCameraPos.z);
+
+    unsigned int frames = GetFrameCount() > 0 ? GetFrameCount() : 1;
+    float t = static_cast<float>(GetFrameIndex() % frames) / static_cast<float>(frames);
+    float angle = startAngle + t * glm::two_pi<float>();
+
+    m_camera.Position = glm::vec3(
+        radius * sin(angle),
+        m_initialCameraPos.y + 0.5f * sin(2.0f * angle),
+        radius * cos(angle));
+    m_camera.LookAt(glm::vec3(0.0f));
+}
+
 // ============================================================================
 // 鼠标移动处理（相机旋转）
 // ============================================================================
 void CameraApplication::OnMouseMove(double xpos, double ypos)
 {
-    if (!m_mouseCaptured)
+    if (!m_mouseCaptured || m_scriptedCamera)
         return;
 
     // 计算鼠标偏移量
@@ -90,11 +133,47 @@ void CameraApplication::OnMouseMove(double xpos, double ypos)
     m_camera.ProcessMouseMovement(xoffset, yoffset);
 }
 
+// ============================================================================
+// 投影矩阵
+// ============================================================================
+glm::mat4 CameraApplication::GetProjectionMatrix(float nearPlane, float farPlane) const
+{
+    return glm::perspective(glm::radians(m_camera.Zoom),
+                            (float)m_width / (float)m_height,
+                            nearPlane, farPlane);
+}
+
+// ============================================================================
+// 上传每帧数据到 UBO
+// ============================================================================
+void CameraApplication::UploadFrameData(float nearPlane, float farPlane)
+{
+    if (!m_frameData.isCreated())
+        m_frameData.create(FRAME_DATA_BINDING);
+
+    FrameData data;
+    data.view = m_camera.GetViewMatrix();
+    data.projection = GetProjectionMatrix(nearPlane, farPlane);
+    data.viewPos = m_camera.Position;
+    data.time = GetTime();
+    m_frameData.update(data);
+}
+
+// ============================================================================
+// 释放基类持有的 GL 资源
+// ============================================================================
+void CameraApplication::OnReleaseResources()
+{
+    m_frameData.destroy();
+}
+
 // ============================================================================
 // 鼠标滚轮处理（相机缩放）
 // ============================================================================
 void CameraApplication::OnMouseScroll(double xoffset, double yoffset)
 {
+    if (m_scriptedCamera)
+        return;
     m_camera.ProcessMouseScroll(static_cast<float>(yoffset));
 }
 
@@ -4,12 +4,15 @@
 // 这个类继承自 Application，添加了相机功能：
 // 1. 相机管理
 // 2. 相机控制（WASD 移动、鼠标旋转、滚轮缩放）
+// 3. 脚本化相机路径（基准测试用，结果可复现）
+// 4. 每帧数据 UBO（view、projection、viewPos、time），所有着色器共享
 // ============================================================================
 
 #pragma once
 
 #include "application.h"
 #include "camera.h"
+#include "uniform_buffer.h"
 
 // ============================================================================
 // CameraApplication 类
@@ -30,6 +33,24 @@ public:
     Camera& GetCamera() { return m_camera; }
     const Camera& GetCamera() const { return m_camera; }
 
+    // ========================================================================
+    // 脚本化相机路径
+    // ========================================================================
+    // 开启后忽略键盘/鼠标，相机按帧序号沿固定轨道绕原点运动并始终看向原点
+    // 进程级默认值会作用于之后构造的所有 CameraApplication（基准测试用）
+    void SetScriptedCamera(bool scripted) { m_scriptedCamera = scripted; }
+    static void SetScriptedCameraDefault(bool scripted);
+
+    // ========================================================================
+    // 投影矩阵和每帧数据
+    // ========================================================================
+    glm::mat4 GetProjectionMatrix(float nearPlane = 0.1f, float farPlane = 100.0f) const;
+
+    // 把当前相机的 view/projection/viewPos 和时间上传到 FrameData UBO
+    // （绑定点 FRAME_DATA_BINDING）。在 OnRender 开始时调用一次，之后所有
+    // 声明了 uniform FrameData 块的着色器都不需要再单独设置这些 uniform
+    void UploadFrameData(float nearPlane = 0.1f, float farPlane = 100.0f);
+
 protected:
     // ========================================================================
     // 重写输入处理函数
@@ -39,10 +60,17 @@ protected:
     virtual void OnMouseScroll(double xoffset, double yoffset) override;
     virtual void OnInitialize() override;
     virtual void OnUpdate(float deltaTime) override;
+    virtual void OnReleaseResources() override;
+
+    // 按帧序号更新脚本化相机
+    void UpdateScriptedCamera();
 
     // ========================================================================
     // 成员变量
     // ========================================================================
     Camera m_camera;
+    glm::vec3 m_initialCameraPos;  // 初始相机位置（脚本化路径的起点）
+    bool m_scriptedCamera;         // 是否使用脚本化相机路径
+    UniformBuffer<FrameData> m_frameData;  // 每帧数据 UBO（首次上传时创建）
 };
 
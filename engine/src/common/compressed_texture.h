@@ -0,0 +1,530 @@
+// ============================================================================
+// CompressedTextureCache - 块压缩纹理缓存
+// ============================================================================
+// 每次启动都用 stb_image 解码 PNG/JPEG，再以未压缩的 RGB/RGBA 上传、生成 mipmap，
+// 解码慢，显存占用也大。第一次加载图片时：
+//   1. 解码，用 MipGenerator 在 CPU 上生成完整的 mip 链
+//   2. 每一级用 BlockCompressor 编码为 BC1/BC3/BC4/BC5/BC7（按块行分给 ThreadPool）
+//   3. 保存为 DDS 文件（DX10 扩展头）
+// 之后直接 mmap DDS 文件，用 glCompressedTexImage2D 上传，不需要解码和生成 mipmap；
+// 显存占用是未压缩的 1/4～1/8
+//
+// 格式选择：单通道 BC4，双通道 BC5，RGB（或 alpha 全为 255 的 RGBA）BC1，RGBA BC3；
+// 法线贴图用 BC7（需要 GL 4.2），设置 OPENGL_TEXTURE_BC7=1 时所有彩色纹理都用 BC7
+// 驱动不支持需要的格式时返回失败，调用者退回未压缩的路径
+//
+// 缓存键 = 图片文件内容 + 加载选项 + 可用的压缩格式的哈希
+// 缓存目录：环境变量 OPENGL_TEXTURE_CACHE_DIR，默认 PROJECT_ROOT/.cache/textures
+// 设置 OPENGL_TEXTURE_COMPRESSION=0 关闭压缩
+// ============================================================================
+
+#pragma once
+
+#include <glad/glad.h>
+#include <stb_image.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "block_compressor.h"
+#include "mip_generator.h"
+#include "model_cache.h"       // MappedFile
+#include "texture_flags.h"
+#include "thread_pool.h"
+
+// S3TC（BC1～BC3）是扩展，glad 没有生成这些常量
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+#ifndef GL_COMPRESSED_SRGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_SRGB_S3TC_DXT1_EXT 0x8C4C
+#endif
+#ifndef GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT 0x8C4F
+#endif
+
+// 当前的上下翻转设置（stb_image 没有提供，定义在 stb_image_impl.cpp）
+int stbi_get_flip_vertically_on_load();
+// 按 flip 加载图片，不改变调用线程的翻转设置（工作线程用，定义在 stb_image_impl.cpp）
+unsigned char* stbi_load_flipped(const char* filename, int* x, int* y, int* components, int desired, int flip);
+
+// 驱动支持的压缩格式（CompressedTextureCache::support() 的返回值）
+enum TextureCompressionSupport {
+    COMPRESSION_S3TC      = 1 << 0,   // BC1/BC3
+    COMPRESSION_S3TC_SRGB = 1 << 1,   // sRGB 的 BC1/BC3
+    COMPRESSION_RGTC      = 1 << 2,   // BC4/BC5（GL 3.0）
+    COMPRESSION_BPTC      = 1 << 3,   // BC7（GL 4.2）
+    COMPRESSION_PREFER_BC7 = 1 << 4,  // OPENGL_TEXTURE_BC7=1：彩色纹理都用 BC7
+};
+
+// ============================================================================
+// 压缩后的图片（所有 mip 级别）
+// ============================================================================
+struct CompressedImage {
+    struct Level {
+        int width;
+        int height;
+        size_t offset;                        // 在 data() 中的字节偏移
+        size_t size;
+    };
+
+    GLenum format = 0;                        // GL 压缩格式
+    bool opaque = true;                       // alpha 是否全为 255
+    std::vector<Level> levels;
+    std::vector<unsigned char> storage;       // 刚编码的数据
+    std::shared_ptr<MappedFile> file;         // 或者映射的缓存文件
+    size_t fileOffset = 0;
+
+    const unsigned char* data() const { return file ? file->data() + fileOffset : storage.data(); }
+};
+
+class CompressedTextureCache
+{
+public:
+    static bool isEnabled()
+    {
+        const char* value = std::getenv("OPENGL_TEXTURE_COMPRESSION");
+        return !value || std::strcmp(value, "0") != 0;
+    }
+
+    // ========================================================================
+    // 可用的压缩格式（需要 OpenGL 上下文；关闭压缩时返回 0）
+    // ========================================================================
+    static unsigned int support()
+    {
+        if (!isEnabled())
+            return 0;
+        static const unsigned int s_support = detectSupport();
+        return s_support;
+    }
+
+    // ========================================================================
+    // 读取缓存，没有时解码 path 并压缩、写入缓存（可以在任意线程调用）
+    // ========================================================================
+    //   flags:   TextureFlags；解码时按 TEXTURE_FLAG_FLIP 上下翻转（不改变线程的 stb_image 设置）
+    //   support: support() 的返回值（在有上下文的线程上取得）
+    //   mipmaps: 是否生成完整的 mip 链
+    // 失败（文件不存在、不支持需要的格式）时返回 false
+    // ========================================================================
+    static bool loadOrCook(const std::string& path, unsigned int flags, unsigned int support, bool mipmaps,
+                           CompressedImage& image)
+    {
+        if (!support)
+            return false;
+        uint64_t key = makeKey(path, flags, support, mipmaps);
+        if (!key)
+            return false;
+        std::string cachePath = pathFor(key);
+        if (readDds(cachePath, image))
+            return true;
+
+        int width, height, components;
+        unsigned char* pixels = stbi_load_flipped(path.c_str(), &width, &height, &components, 0,
+                                                  (flags & TEXTURE_FLAG_FLIP) ? 1 : 0);
+        if (!pixels)
+            return false;
+        bool cooked = cook(pixels, width, height, components, flags, support, mipmaps, image);
+        stbi_image_free(pixels);
+        if (cooked)
+            writeDds(cachePath, image);
+        return cooked;
+    }
+
+    // 上传所有级别到 target（纹理由调用者绑定）
+    static void uploadLevels(GLenum target, const CompressedImage& image)
+    {
+        for (size_t level = 0; level < image.levels.size(); level++)
+        {
+            const CompressedImage::Level& info = image.levels[level];
+            glCompressedTexImage2D(target, static_cast<GLint>(level), image.format, info.width, info.height, 0,
+                                   static_cast<GLsizei>(info.size), image.data() + info.offset);
+        }
+    }
+
+    // 删除所有缓存文件（基准测试冷启动用）
+    static void clear()
+    {
+        std::error_code error;
+        std::filesystem::remove_all(directory(), error);
+    }
+
+    static std::string directory()
+    {
+        if (const char* dir = std::getenv("OPENGL_TEXTURE_CACHE_DIR"))
+            return dir;
+        return std::string(PROJECT_ROOT) + "/.cache/textures";
+    }
+
+private:
+    static const uint32_t VERSION = 2;
+
+    enum BlockFormat { BLOCK_BC1, BLOCK_BC3, BLOCK_BC4, BLOCK_BC5, BLOCK_BC7 };
+
+    // 格式对应的 GL 枚举、DXGI 编号（DDS 用）和每块字节数
+    struct FormatInfo {
+        BlockFormat block;
+        GLenum glFormat;
+        uint32_t dxgiFormat;
+        size_t blockBytes;
+    };
+
+    static const FormatInfo* formats(size_t& count)
+    {
+        static const FormatInfo FORMATS[] = {
+            { BLOCK_BC1, GL_COMPRESSED_RGB_S3TC_DXT1_EXT,        71, 8  },
+            { BLOCK_BC1, GL_COMPRESSED_SRGB_S3TC_DXT1_EXT,       72, 8  },
+            { BLOCK_BC3, GL_COMPRESSED_RGBA_S3TC_DXT5_EXT,       77, 16 },
+            { BLOCK_BC3, GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT, 78, 16 },
+            { BLOCK_BC4, GL_COMPRESSED_RED_RGTC1,                80, 8  },
+            { BLOCK_BC5, GL_COMPRESSED_RG_RGTC2,                 83, 16 },
+            { BLOCK_BC7, GL_COMPRESSED_RGBA_BPTC_UNORM,          98, 16 },
+            { BLOCK_BC7, GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM,    99, 16 },
+        };
+        count = sizeof(FORMATS) / sizeof(FORMATS[0]);
+        return FORMATS;
+    }
+
+    static const FormatInfo* findFormat(GLenum glFormat)
+    {
+        size_t count;
+        const FormatInfo* table = formats(count);
+        for (size_t i = 0; i < count; i++)
+        {
+            if (table[i].glFormat == glFormat)
+                return &table[i];
+        }
+        return nullptr;
+    }
+
+    static const FormatInfo* findDxgi(uint32_t dxgiFormat)
+    {
+        size_t count;
+        const FormatInfo* table = formats(count);
+        for (size_t i = 0; i < count; i++)
+        {
+            if (table[i].dxgiFormat == dxgiFormat)
+                return &table[i];
+        }
+        return nullptr;
+    }
+
+    static unsigned int detectSupport()
+    {
+        bool s3tc = false, srgb = false;
+        GLint count = 0;
+        glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+        for (GLint i = 0; i < count; i++)
+        {
+            const char* name = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, i));
+            if (!name)
+                continue;
+            s3tc = s3tc || std::strcmp(name, "GL_EXT_texture_compression_s3tc") == 0;
+            srgb = srgb || std::strcmp(name, "GL_EXT_texture_sRGB") == 0 ||
+                   std::strcmp(name, "GL_EXT_texture_compression_s3tc_srgb") == 0;
+        }
+
+        unsigned int support = COMPRESSION_RGTC;
+        if (s3tc)
+            support |= COMPRESSION_S3TC | (srgb ? COMPRESSION_S3TC_SRGB : 0);
+        if (GLAD_GL_VERSION_4_2)
+            support |= COMPRESSION_BPTC;
+        const char* bc7 = std::getenv("OPENGL_TEXTURE_BC7");
+        if (bc7 && std::strcmp(bc7, "0") != 0)
+            support |= COMPRESSION_PREFER_BC7;
+        return support;
+    }
+
+    // 按通道数和选项选择格式，不支持时返回空
+    static const FormatInfo* chooseFormat(int components, bool opaque, unsigned int flags, unsigned int support)
+    {
+        bool srgb = (flags & TEXTURE_FLAG_SRGB) != 0;
+        if (components == 1)
+            return (support & COMPRESSION_RGTC) ? findFormat(GL_COMPRESSED_RED_RGTC1) : nullptr;
+        if (components == 2)
+            return (support & COMPRESSION_RGTC) ? findFormat(GL_COMPRESSED_RG_RGTC2) : nullptr;
+
+        const FormatInfo* bc7 = (support & COMPRESSION_BPTC)
+            ? findFormat(srgb ? GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM : GL_COMPRESSED_RGBA_BPTC_UNORM) : nullptr;
+        if (bc7 && ((flags & TEXTURE_FLAG_NORMAL_MAP) || (support & COMPRESSION_PREFER_BC7)))
+            return bc7;
+        if ((support & COMPRESSION_S3TC) && (!srgb || (support & COMPRESSION_S3TC_SRGB)))
+        {
+            if (opaque)
+                return findFormat(srgb ? GL_COMPRESSED_SRGB_S3TC_DXT1_EXT : GL_COMPRESSED_RGB_S3TC_DXT1_EXT);
+            return findFormat(srgb ? GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT : GL_COMPRESSED_RGBA_S3TC_DXT5_EXT);
+        }
+        return bc7;
+    }
+
+    // ========================================================================
+    // 生成 mip 链并编码
+    // ========================================================================
+    static bool cook(const unsigned char* pixels, int width, int height, int components, unsigned int flags,
+                     unsigned int support, bool mipmaps, CompressedImage& image)
+    {
+        // 统一展开为 RGBA8，缺少的通道为 0，alpha 为 255
+        std::vector<unsigned char> rgba(size_t(width) * height * 4);
+        bool opaque = true;
+        for (size_t i = 0; i < size_t(width) * height; i++)
+        {
+            for (int c = 0; c < 4; c++)
+                rgba[i * 4 + c] = c < components ? pixels[i * components + c] : (c == 3 ? 255 : 0);
+            opaque = opaque && rgba[i * 4 + 3] == 255;
+        }
+
+        const FormatInfo* format = chooseFormat(components, opaque, flags, support);
+        if (!format)
+            return false;
+
+        image.format = format->glFormat;
+        image.opaque = opaque;
+        image.levels.clear();
+        image.storage.clear();
+        image.file.reset();
+
+        // 在 CPU 上生成 mip 链（sRGB 纹理在线性空间滤波，见 mip_generator.h）
+        MipOptions mipOptions = MipGenerator::optionsFor(flags);
+        mipOptions.srgb = mipOptions.srgb && components >= 3;
+        MipChain chain;
+        if (mipmaps)
+            MipGenerator::generate(rgba.data(), width, height, 4, mipOptions, chain);
+        else
+            chain.levels.push_back({ width, height, 0, rgba.size() });
+        for (size_t i = 0; i < chain.levels.size(); i++)
+        {
+            const MipChain::Level& source = chain.levels[i];
+            CompressedImage::Level level;
+            level.width = source.width;
+            level.height = source.height;
+            level.offset = image.storage.size();
+            level.size = blockCount(source.width) * blockCount(source.height) * format->blockBytes;
+            image.storage.resize(level.offset + level.size);
+            encodeLevel(mipmaps ? chain.level(i) : rgba.data(), source.width, source.height, format,
+                        image.storage.data() + level.offset);
+            image.levels.push_back(level);
+        }
+        return true;
+    }
+
+    static size_t blockCount(int size) { return size_t(std::max(1, (size + 3) / 4)); }
+
+    // 编码一级，按块行并行（超出图片的像素取边缘像素）
+    static void encodeLevel(const unsigned char* rgba, int width, int height, const FormatInfo* format, unsigned char* out)
+    {
+        size_t blocksX = blockCount(width), blocksY = blockCount(height);
+        ThreadPool::Instance().parallelFor(blocksY, [&](size_t by) {
+            uint8_t block[64];
+            for (size_t bx = 0; bx < blocksX; bx++)
+            {
+                for (int i = 0; i < 16; i++)
+                {
+                    int x = std::min(int(bx * 4) + (i & 3), width - 1);
+                    int y = std::min(int(by * 4) + (i >> 2), height - 1);
+                    std::memcpy(block + i * 4, rgba + (size_t(y) * width + x) * 4, 4);
+                }
+                uint8_t* dst = out + (by * blocksX + bx) * format->blockBytes;
+                switch (format->block)
+                {
+                case BLOCK_BC1: BlockCompressor::encodeBC1(block, dst); break;
+                case BLOCK_BC3: BlockCompressor::encodeBC3(block, dst); break;
+                case BLOCK_BC4: BlockCompressor::encodeBC4(block, 4, dst); break;
+                case BLOCK_BC5: BlockCompressor::encodeBC5(block, dst); break;
+                case BLOCK_BC7: BlockCompressor::encodeBC7(block, dst); break;
+                }
+            }
+        });
+    }
+
+    // ========================================================================
+    // DDS 文件（"DDS " + DDS_HEADER + DDS_HEADER_DXT10 + 各级数据）
+    // ========================================================================
+    struct DdsPixelFormat {
+        uint32_t size, flags, fourCC, rgbBitCount, rMask, gMask, bMask, aMask;
+    };
+    struct DdsHeader {
+        uint32_t size, flags, height, width, pitchOrLinearSize, depth, mipMapCount, reserved1[11];
+        DdsPixelFormat pixelFormat;
+        uint32_t caps, caps2, caps3, caps4, reserved2;
+    };
+    struct DdsHeaderDx10 {
+        uint32_t dxgiFormat, resourceDimension, miscFlag, arraySize, miscFlags2;
+    };
+    static const uint32_t DDS_MAGIC = 0x20534444;    // "DDS "
+    static const uint32_t FOURCC_DX10 = 0x30315844;  // "DX10"
+
+    static void writeDds(const std::string& path, const CompressedImage& image)
+    {
+        const FormatInfo* format = findFormat(image.format);
+        if (!format || image.levels.empty())
+            return;
+
+        DdsHeader header = {};
+        header.size = sizeof(DdsHeader);
+        header.flags = 0x1 | 0x2 | 0x4 | 0x1000 | 0x20000 | 0x80000;    // CAPS|HEIGHT|WIDTH|PIXELFORMAT|MIPMAPCOUNT|LINEARSIZE
+        header.height = image.levels[0].height;
+        header.width = image.levels[0].width;
+        header.pitchOrLinearSize = static_cast<uint32_t>(image.levels[0].size);
+        header.mipMapCount = static_cast<uint32_t>(image.levels.size());
+        header.pixelFormat.size = sizeof(DdsPixelFormat);
+        header.pixelFormat.flags = 0x4;                                  // FOURCC
+        header.pixelFormat.fourCC = FOURCC_DX10;
+        header.caps = 0x1000 | (image.levels.size() > 1 ? 0x400000 | 0x8 : 0);   // TEXTURE|MIPMAP|COMPLEX
+        DdsHeaderDx10 dx10 = {};
+        dx10.dxgiFormat = format->dxgiFormat;
+        dx10.resourceDimension = 3;                                      // TEXTURE2D
+        dx10.arraySize = 1;
+        dx10.miscFlags2 = image.opaque ? 3 : 1;                          // ALPHA_MODE_OPAQUE / STRAIGHT
+
+        std::error_code error;
+        std::filesystem::create_directories(directory(), error);
+
+        // 先写临时文件再重命名，避免并行运行的进程读到写了一半的文件
+        std::string tempPath = path + ".tmp";
+        {
+            std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+            if (!file)
+                return;
+            uint32_t magic = DDS_MAGIC;
+            file.write(reinterpret_cast<const char*>(&magic), sizeof(magic));
+            file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            file.write(reinterpret_cast<const char*>(&dx10), sizeof(dx10));
+            const CompressedImage::Level& last = image.levels.back();
+            file.write(reinterpret_cast<const char*>(image.data()), last.offset + last.size);
+            if (!file)
+                return;
+        }
+        std::filesystem::rename(tempPath, path, error);
+    }
+
+    static bool readDds(const std::string& path, CompressedImage& image)
+    {
+        auto file = std::make_shared<MappedFile>();
+        size_t headerBytes = sizeof(uint32_t) + sizeof(DdsHeader) + sizeof(DdsHeaderDx10);
+        if (!file->open(path) || file->size() < headerBytes)
+            return false;
+
+        uint32_t magic;
+        DdsHeader header;
+        DdsHeaderDx10 dx10;
+        std::memcpy(&magic, file->data(), sizeof(magic));
+        std::memcpy(&header, file->data() + sizeof(magic), sizeof(header));
+        std::memcpy(&dx10, file->data() + sizeof(magic) + sizeof(header), sizeof(dx10));
+        const FormatInfo* format = findDxgi(dx10.dxgiFormat);
+        if (magic != DDS_MAGIC || header.size != sizeof(DdsHeader) || header.pixelFormat.fourCC != FOURCC_DX10 ||
+            !format || header.width == 0 || header.height == 0 || header.mipMapCount == 0)
+            return false;
+
+        image.format = format->glFormat;
+        image.opaque = (dx10.miscFlags2 & 0x7) != 1;
+        image.levels.clear();
+        image.storage.clear();
+        int width = static_cast<int>(header.width), height = static_cast<int>(header.height);
+        size_t offset = 0;
+        for (uint32_t i = 0; i < header.mipMapCount; i++)
+        {
+            CompressedImage::Level level;
+            level.width = width;
+            level.height = height;
+            level.offset = offset;
+            level.size = blockCount(width) * blockCount(height) * format->blockBytes;
+            offset += level.size;
+            image.levels.push_back(level);
+            width = std::max(1, width / 2);
+            height = std::max(1, height / 2);
+        }
+        if (file->size() - headerBytes < offset)
+            return false;
+
+        image.file = file;
+        image.fileOffset = headerBytes;
+        return true;
+    }
+
+    // 缓存键：图片文件内容 + 选项，文件读取失败时返回 0
+    static uint64_t makeKey(const std::string& path, unsigned int flags, unsigned int support, bool mipmaps)
+    {
+        std::ifstream file(path, std::ios::binary);
+        if (!file)
+            return 0;
+
+        uint64_t hash = 14695981039346656037ull;
+        std::vector<char> buffer(1 << 16);
+        while (file)
+        {
+            file.read(buffer.data(), buffer.size());
+            hash = hashBytes(hash, buffer.data(), static_cast<size_t>(file.gcount()));
+        }
+        const uint32_t settings[] = { VERSION, flags, support, mipmaps ? 1u : 0u,
+                                      static_cast<uint32_t>(MipGenerator::optionsFor(flags).filter) };
+        hash = hashBytes(hash, reinterpret_cast<const char*>(settings), sizeof(settings));
+        return hash ? hash : 1;
+    }
+
+    static uint64_t hashBytes(uint64_t hash, const char* data, size_t size)
+    {
+        for (size_t i = 0; i < size; i++)
+        {
+            hash ^= static_cast<uint8_t>(data[i]);
+            hash *= 1099511628211ull;
+        }
+        return hash;
+    }
+
+    static std::string pathFor(uint64_t key)
+    {
+        char name[32];
+        std::snprintf(name, sizeof(name), "%016llx.dds", static_cast<unsigned long long>(key));
+        return directory() + "/" + name;
+    }
+};
+
+// ============================================================================
+// 上传压缩图片到 2D 纹理，设置与 UploadTextureImage 相同的采样参数
+// ============================================================================
+inline void UploadCompressedTexture(unsigned int textureID, const CompressedImage& image)
+{
+    glBindTexture(GL_TEXTURE_2D, textureID);
+    CompressedTextureCache::uploadLevels(GL_TEXTURE_2D, image);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, static_cast<GLint>(image.levels.size()) - 1);
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+}
+
+// ============================================================================
+// 同步加载压缩纹理（主线程），返回纹理 ID；关闭压缩或失败时返回 0
+// ============================================================================
+// 与 stbi_set_flip_vertically_on_load(flags & TEXTURE_FLAG_FLIP) 一样会修改全局的翻转设置
+// hasAlpha 不为空时返回图片是否有不透明度不为 1 的像素
+// ============================================================================
+inline unsigned int LoadCompressedTexture(const char* path, unsigned int flags, bool* hasAlpha = nullptr)
+{
+    unsigned int support = CompressedTextureCache::support();
+    if (!support)
+        return 0;
+
+    stbi_set_flip_vertically_on_load((flags & TEXTURE_FLAG_FLIP) != 0);
+    CompressedImage image;
+    if (!CompressedTextureCache::loadOrCook(path, flags, support, true, image))
+        return 0;
+
+    unsigned int textureID;
+    glGenTextures(1, &textureID);
+    UploadCompressedTexture(textureID, image);
+    if (hasAlpha)
+        *hasAlpha = !image.opaque;
+    return textureID;
+}
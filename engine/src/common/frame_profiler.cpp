@@ -0,0 +1,391 @@
+// ============================================================================
+// FrameProfiler 类实现
+// ============================================================================
+
+#include "frame_profiler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+
+FrameProfiler* FrameProfiler::s_active = nullptr;
+
+// ============================================================================
+// 绘制调用计数钩子
+// ============================================================================
+// GLAD 通过全局函数指针（glad_glDrawArrays 等）调用驱动
+// 把这些指针替换为计数包装函数，就能统计所有 lesson 的绘制调用
+// ============================================================================
+namespace
+{
+    unsigned int s_drawCalls = 0;
+    double s_uploadMs = 0.0;
+    size_t s_uploadBytes = 0;
+
+    PFNGLDRAWARRAYSPROC                         s_drawArrays = nullptr;
+    PFNGLDRAWELEMENTSPROC                       s_drawElements = nullptr;
+    PFNGLDRAWARRAYSINSTANCEDPROC                s_drawArraysInstanced = nullptr;
+    PFNGLDRAWELEMENTSINSTANCEDPROC              s_drawElementsInstanced = nullptr;
+    PFNGLDRAWELEMENTSBASEVERTEXPROC             s_drawElementsBaseVertex = nullptr;
+    PFNGLDRAWELEMENTSINSTANCEDBASEVERTEXPROC    s_drawElementsInstancedBaseVertex = nullptr;
+    PFNGLDRAWELEMENTSINSTANCEDBASEVERTEXBASEINSTANCEPROC s_drawElementsInstancedBaseVertexBaseInstance = nullptr;
+    PFNGLMULTIDRAWELEMENTSINDIRECTPROC          s_multiDrawElementsIndirect = nullptr;
+
+    void APIENTRY CountedDrawArrays(GLenum mode, GLint first, GLsizei count)
+    {
+        s_drawCalls++;
+        s_drawArrays(mode, first, count);
+    }
+
+    void APIENTRY CountedDrawElements(GLenum mode, GLsizei count, GLenum type, const void* indices)
+    {
+        s_drawCalls++;
+        s_drawElements(mode, count, type, indices);
+    }
+
+    void APIENTRY CountedDrawArraysInstanced(GLenum mode, GLint first, GLsizei count, GLsizei instances)
+    {
+        s_drawCalls++;
+        s_drawArraysInstanced(mode, first, count, instances);
+    }
+
+    void APIENTRY CountedDrawElementsInstanced(GLenum mode, GLsizei count, GLenum type,
+                                               const void* indices, GLsizei instances)
+    {
+        s_drawCalls++;
+        s_drawElementsInstanced(mode, count, type, indices, instances);
+    }
+
+    void APIENTRY CountedDrawElementsBaseVertex(GLenum mode, GLsizei count, GLenum type,
+                                                const void* indices, GLint baseVertex)
+    {
+        s_drawCalls++;
+        s_drawElementsBaseVertex(mode, count, type, indices, baseVertex);
+    }
+
+    void APIENTRY CountedDrawElementsInstancedBaseVertex(GLenum mode, GLsizei count, GLenum type,
+                                                         const void* indices, GLsizei instances,
+                                                         GLint baseVertex)
+    {
+        s_drawCalls++;
+        s_drawElementsInstancedBaseVertex(mode, count, type, indices, instances, baseVertex);
+    }
+
+    void APIENTRY CountedDrawElementsInstancedBaseVertexBaseInstance(GLenum mode, GLsizei count, GLenum type,
+                                                                     const void* indices, GLsizei instances,
+                                                                     GLint baseVertex, GLuint baseInstance)
+    {
+        s_drawCalls++;
+        s_drawElementsInstancedBaseVertexBaseInstance(mode, count, type, indices, instances, baseVertex, baseInstance);
+    }
+
+    // 一次 MultiDraw 只算一次调用（这正是批处理要减少的 API 提交次数）
+    void APIENTRY CountedMultiDrawElementsIndirect(GLenum mode, GLenum type, const void* indirect,
+                                                   GLsizei drawCount, GLsizei stride)
+    {
+        s_drawCalls++;
+        s_multiDrawElementsIndirect(mode, type, indirect, drawCount, stride);
+    }
+
+    // 保存原始指针并替换为计数版本（驱动不支持的函数保持为空）
+    template <typename Proc>
+    void Hook(Proc& gladProc, Proc& original, Proc counted)
+    {
+        original = gladProc;
+        if (gladProc)
+            gladProc = counted;
+    }
+
+    template <typename Proc>
+    void Unhook(Proc& gladProc, Proc& original)
+    {
+        if (original)
+            gladProc = original;
+        original = nullptr;
+    }
+
+    double ToMs(std::chrono::steady_clock::duration d)
+    {
+        return std::chrono::duration<double, std::milli>(d).count();
+    }
+}
+
+// ============================================================================
+// 构造函数和析构函数
+// ============================================================================
+FrameProfiler::FrameProfiler()
+    : m_attached(false)
+    , m_gpuTimers(false)
+{
+    for (unsigned int i = 0; i < QUERY_RING; i++)
+    {
+        m_queries[i] = 0;
+        m_queryFrame[i] = -1;
+    }
+}
+
+FrameProfiler::~FrameProfiler()
+{
+    if (s_active == this)
+        s_active = nullptr;
+}
+
+// ============================================================================
+// 安装钩子并创建计时查询
+// ============================================================================
+void FrameProfiler::Attach()
+{
+    if (m_attached)
+        return;
+
+    m_samples.clear();
+    s_drawCalls = 0;
+    s_uploadMs = 0.0;
+    s_uploadBytes = 0;
+
+    Hook(glad_glDrawArrays, s_drawArrays, &CountedDrawArrays);
+    Hook(glad_glDrawElements, s_drawElements, &CountedDrawElements);
+    Hook(glad_glDrawArraysInstanced, s_drawArraysInstanced, &CountedDrawArraysInstanced);
+    Hook(glad_glDrawElementsInstanced, s_drawElementsInstanced, &CountedDrawElementsInstanced);
+    Hook(glad_glDrawElementsBaseVertex, s_drawElementsBaseVertex, &CountedDrawElementsBaseVertex);
+    Hook(glad_glDrawElementsInstancedBaseVertex, s_drawElementsInstancedBaseVertex,
+         &CountedDrawElementsInstancedBaseVertex);
+    Hook(glad_glDrawElementsInstancedBaseVertexBaseInstance, s_drawElementsInstancedBaseVertexBaseInstance,
+         &CountedDrawElementsInstancedBaseVertexBaseInstance);
+    Hook(glad_glMultiDrawElementsIndirect, s_multiDrawElementsIndirect, &CountedMultiDrawElementsIndirect);
+
+    // GL_TIME_ELAPSED 是 OpenGL 3.3 核心功能
+    m_gpuTimers = GLAD_GL_VERSION_3_3 && glad_glGenQueries && glad_glGetQueryObjectui64v;
+    if (m_gpuTimers)
+        glGenQueries(QUERY_RING, m_queries);
+    for (unsigned int i = 0; i < QUERY_RING; i++)
+        m_queryFrame[i] = -1;
+
+    m_attached = true;
+}
+
+// ============================================================================
+// 读取剩余结果并恢复函数指针
+// ============================================================================
+void FrameProfiler::Detach()
+{
+    if (!m_attached)
+        return;
+
+    if (m_gpuTimers)
+    {
+        for (unsigned int i = 0; i < QUERY_RING; i++)
+            ResolveQuery(i);
+        glDeleteQueries(QUERY_RING, m_queries);
+    }
+
+    Unhook(glad_glDrawArrays, s_drawArrays);
+    Unhook(glad_glDrawElements, s_drawElements);
+    Unhook(glad_glDrawArraysInstanced, s_drawArraysInstanced);
+    Unhook(glad_glDrawElementsInstanced, s_drawElementsInstanced);
+    Unhook(glad_glDrawElementsBaseVertex, s_drawElementsBaseVertex);
+    Unhook(glad_glDrawElementsInstancedBaseVertex, s_drawElementsInstancedBaseVertex);
+    Unhook(glad_glDrawElementsInstancedBaseVertexBaseInstance, s_drawElementsInstancedBaseVertexBaseInstance);
+    Unhook(glad_glMultiDrawElementsIndirect, s_multiDrawElementsIndirect);
+
+    m_attached = false;
+}
+
+// ============================================================================
+// 帧开始/结束
+// ============================================================================
+void FrameProfiler::BeginFrame()
+{
+    if (!m_attached)
+        return;
+
+    s_drawCalls = 0;
+    s_uploadMs = 0.0;
+    s_uploadBytes = 0;
+
+    if (m_gpuTimers)
+    {
+        // 槽位被占用时先读取它（QUERY_RING - 1 帧之前的结果，通常已经可用）
+        unsigned int slot = static_cast<unsigned int>(m_samples.size()) % QUERY_RING;
+        ResolveQuery(slot);
+        glBeginQuery(GL_TIME_ELAPSED, m_queries[slot]);
+        m_queryFrame[slot] = static_cast<int>(m_samples.size());
+    }
+
+    m_frameStart = std::chrono::steady_clock::now();
+}
+
+void FrameProfiler::EndFrame()
+{
+    if (!m_attached)
+        return;
+
+    if (m_gpuTimers)
+        glEndQuery(GL_TIME_ELAPSED);
+
+    FrameSample sample;
+    sample.cpuMs = ToMs(std::chrono::steady_clock::now() - m_frameStart);
+    sample.gpuMs = -1.0;
+    sample.drawCalls = s_drawCalls;
+    sample.uploadMs = s_uploadMs;
+    sample.uploadBytes = s_uploadBytes;
+    m_samples.push_back(sample);
+}
+
+unsigned int FrameProfiler::CurrentDrawCalls()
+{
+    return s_drawCalls;
+}
+
+void FrameProfiler::RecordTextureUpload(double ms, size_t bytes)
+{
+    if (!s_active)
+        return;
+    s_uploadMs += ms;
+    s_uploadBytes += bytes;
+}
+
+void FrameProfiler::ResolveQuery(unsigned int slot)
+{
+    int frame = m_queryFrame[slot];
+    if (frame < 0)
+        return;
+
+    GLuint64 elapsedNs = 0;
+    glGetQueryObjectui64v(m_queries[slot], GL_QUERY_RESULT, &elapsedNs);
+    m_samples[frame].gpuMs = static_cast<double>(elapsedNs) / 1.0e6;
+    m_queryFrame[slot] = -1;
+}
+
+// ============================================================================
+// 统计
+// ============================================================================
+FrameStats FrameProfiler::ComputeStats(std::vector<double> values)
+{
+    FrameStats stats;
+    if (values.empty())
+        return stats;
+
+    std::sort(values.begin(), values.end());
+
+    double sum = 0.0;
+    for (double v : values)
+        sum += v;
+    stats.mean = sum / values.size();
+
+    // 最近秩（nearest-rank）百分位
+    auto percentile = [&values](double p) {
+        size_t rank = static_cast<size_t>(std::ceil(p / 100.0 * values.size()));
+        return values[rank > 0 ? rank - 1 : 0];
+    };
+    stats.p50 = percentile(50.0);
+    stats.p95 = percentile(95.0);
+    stats.p99 = percentile(99.0);
+    stats.max = values.back();
+    return stats;
+}
+
+FrameStats FrameProfiler::CpuStats() const
+{
+    std::vector<double> values;
+    for (const FrameSample& s : m_samples)
+        values.push_back(s.cpuMs);
+    return ComputeStats(values);
+}
+
+FrameStats FrameProfiler::GpuStats() const
+{
+    std::vector<double> values;
+    for (const FrameSample& s : m_samples)
+        if (s.gpuMs >= 0.0)
+            values.push_back(s.gpuMs);
+    return ComputeStats(values);
+}
+
+FrameStats FrameProfiler::DrawCallStats() const
+{
+    std::vector<double> values;
+    for (const FrameSample& s : m_samples)
+        values.push_back(static_cast<double>(s.drawCalls));
+    return ComputeStats(values);
+}
+
+FrameStats FrameProfiler::UploadStats() const
+{
+    std::vector<double> values;
+    for (const FrameSample& s : m_samples)
+        values.push_back(s.uploadMs);
+    return ComputeStats(values);
+}
+
+// ============================================================================
+// 报告输出
+// ============================================================================
+void FrameProfiler::WriteStatsJson(std::ostream& out, const char* name, const FrameStats& stats)
+{
+    out << "  \"" << name << "\": {"
+        << "\"mean\": " << stats.mean
+        << ", \"p50\": " << stats.p50
+        << ", \"p95\": " << stats.p95
+        << ", \"p99\": " << stats.p99
+        << ", \"max\": " << stats.max << "},\n";
+}
+
+void FrameProfiler::WriteJson(std::ostream& out, const std::string& label,
+                              unsigned int width, unsigned int height) const
+{
+    out << std::fixed << std::setprecision(4);
+    out << "{\n";
+    out << "  \"lesson\": \"" << label << "\",\n";
+    out << "  \"frames\": " << m_samples.size() << ",\n";
+    out << "  \"resolution\": [" << width << ", " << height << "],\n";
+    out << "  \"gpu_timers\": " << (m_gpuTimers ? "true" : "false") << ",\n";
+    WriteStatsJson(out, "cpu_ms", CpuStats());
+    WriteStatsJson(out, "gpu_ms", GpuStats());
+    WriteStatsJson(out, "draw_calls", DrawCallStats());
+    WriteStatsJson(out, "upload_ms", UploadStats());
+    out << "  \"startup\": {"
+        << "\"init_ms\": " << m_startup.initMs
+        << ", \"shader_ms\": " << m_startup.shaderMs
+        << ", \"shader_cache_hits\": " << m_startup.shaderCacheHits
+        << ", \"shader_cache_misses\": " << m_startup.shaderCacheMisses << "},\n";
+
+    // 每帧原始数据（gpu_ms 为 -1 表示没有计时结果）
+    out << "  \"sample_fields\": [\"cpu_ms\", \"gpu_ms\", \"draw_calls\", \"upload_ms\", \"upload_bytes\"],\n";
+    out << "  \"samples\": [\n";
+    for (size_t i = 0; i < m_samples.size(); i++)
+    {
+        const FrameSample& s = m_samples[i];
+        out << "    [" << s.cpuMs << ", " << s.gpuMs << ", " << s.drawCalls << ", " << s.uploadMs << ", "
+            << s.uploadBytes << "]"
+            << (i + 1 < m_samples.size() ? ",\n" : "\n");
+    }
+    out << "  ]\n";
+    out << "}\n";
+}
+
+void FrameProfiler::WriteCsv(std::ostream& out, const std::string& label,
+                             unsigned int width, unsigned int height) const
+{
+    out << std::fixed << std::setprecision(4);
+    out << "lesson,width,height,frames,metric,mean,p50,p95,p99,max\n";
+
+    auto row = [&](const char* metric, const FrameStats& stats) {
+        out << label << ',' << width << ',' << height << ',' << m_samples.size() << ','
+            << metric << ',' << stats.mean << ',' << stats.p50 << ',' << stats.p95 << ','
+            << stats.p99 << ',' << stats.max << '\n';
+    };
+    row("cpu_ms", CpuStats());
+    row("gpu_ms", GpuStats());
+    row("draw_calls", DrawCallStats());
+    row("upload_ms", UploadStats());
+
+    // 启动耗时只有一个值，所有统计列相同
+    auto single = [](double value) {
+        FrameStats stats;
+        stats.mean = stats.p50 = stats.p95 = stats.p99 = stats.max = value;
+        return stats;
+    };
+    row("startup_ms", single(m_startup.initMs));
+    row("shader_ms", single(m_startup.shaderMs));
+}
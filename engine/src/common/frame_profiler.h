@@ -0,0 +1,126 @@
+// ============================================================================
+// FrameProfiler 类 - 帧性能统计
+// ============================================================================
+// 这个类用于基准测试（--bench 模式），记录每一帧的：
+// 1. CPU 时间（OnUpdate + OnRender + 提交命令）
+// 2. GPU 时间（GL_TIME_ELAPSED 计时查询，环形缓冲避免等待 GPU）
+// 3. 绘制调用次数（替换 GLAD 的函数指针进行计数，lesson 代码无需修改）
+// 4. 纹理上传的耗时和字节数（TextureStreamer 调用 RecordTextureUpload）
+// 以及一次性的启动耗时（初始化 + 着色器创建，区分程序二进制缓存冷/热启动）
+// 并输出带 p50/p95/p99 统计的 JSON 或 CSV 报告
+// ============================================================================
+
+#pragma once
+
+#include <glad/glad.h>
+
+#include <chrono>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// ============================================================================
+// 单帧采样数据
+// ============================================================================
+struct FrameSample {
+    double cpuMs;             // CPU 时间（毫秒）
+    double gpuMs;             // GPU 时间（毫秒），不支持计时查询时为 -1
+    unsigned int drawCalls;   // 绘制调用次数
+    double uploadMs;          // 纹理上传耗时（毫秒）
+    size_t uploadBytes;       // 纹理上传字节数
+};
+
+// ============================================================================
+// 启动耗时（Initialize 结束时记录一次）
+// ============================================================================
+struct StartupSample {
+    double initMs = -1.0;                   // Initialize 总耗时（窗口、上下文、OnInitialize），-1 表示未记录
+    double shaderMs = 0.0;                  // 其中创建着色器程序的耗时
+    unsigned int shaderCacheHits = 0;       // 从程序二进制缓存加载的程序数
+    unsigned int shaderCacheMisses = 0;     // 需要编译的程序数（全部未命中即冷启动）
+};
+
+// ============================================================================
+// 统计摘要
+// ============================================================================
+struct FrameStats {
+    double mean = 0.0;
+    double p50 = 0.0;
+    double p95 = 0.0;
+    double p99 = 0.0;
+    double max = 0.0;
+};
+
+// ============================================================================
+// FrameProfiler 类
+// ============================================================================
+class FrameProfiler
+{
+public:
+    FrameProfiler();
+    ~FrameProfiler();
+
+    // ========================================================================
+    // 全局激活的分析器（Application 在初始化、每帧和清理时调用）
+    // ========================================================================
+    static void SetActive(FrameProfiler* profiler) { s_active = profiler; }
+    static FrameProfiler* Active() { return s_active; }
+
+    // ========================================================================
+    // 生命周期（需要当前有 OpenGL 上下文）
+    // ========================================================================
+    // 创建计时查询并安装绘制调用计数钩子
+    void Attach();
+    // 读取剩余的查询结果、删除查询并恢复原始函数指针
+    void Detach();
+
+    // ========================================================================
+    // 每帧调用
+    // ========================================================================
+    void BeginFrame();
+    void EndFrame();
+
+    // 记录启动耗时（Application::Initialize 调用）
+    void SetStartup(const StartupSample& startup) { m_startup = startup; }
+
+    // ========================================================================
+    // 结果
+    // ========================================================================
+    const std::vector<FrameSample>& GetSamples() const { return m_samples; }
+    FrameStats CpuStats() const;
+    FrameStats GpuStats() const;
+    FrameStats DrawCallStats() const;
+    FrameStats UploadStats() const;
+    const StartupSample& GetStartup() const { return m_startup; }
+
+    // 报告：label 为 lesson 名称，width/height 为渲染分辨率
+    void WriteJson(std::ostream& out, const std::string& label, unsigned int width, unsigned int height) const;
+    void WriteCsv(std::ostream& out, const std::string& label, unsigned int width, unsigned int height) const;
+
+    // 当前帧到目前为止的绘制调用次数
+    static unsigned int CurrentDrawCalls();
+
+    // 记录当前帧的一次纹理上传（没有激活的分析器时忽略）
+    static void RecordTextureUpload(double ms, size_t bytes);
+
+private:
+    // 环形计时查询数量：读取 N-1 帧之前的结果，避免 CPU 等待 GPU
+    static const unsigned int QUERY_RING = 4;
+
+    // 读取某个槽位的查询结果（阻塞直到可用）
+    void ResolveQuery(unsigned int slot);
+
+    static FrameStats ComputeStats(std::vector<double> values);
+    static void WriteStatsJson(std::ostream& out, const char* name, const FrameStats& stats);
+
+    static FrameProfiler* s_active;
+
+    std::vector<FrameSample> m_samples;
+    StartupSample m_startup;
+    std::chrono::steady_clock::time_point m_frameStart;
+
+    bool m_attached;
+    bool m_gpuTimers;                         // 是否支持 GL_TIME_ELAPSED
+    unsigned int m_queries[QUERY_RING];
+    int m_queryFrame[QUERY_RING];             // 槽位对应的帧序号，-1 表示空闲
+};
@@ -0,0 +1,293 @@
+// ============================================================================
+// GeometryArena - 多个网格共用的顶点/索引缓冲区
+// ============================================================================
+// 每个 Mesh 单独创建 VAO、VBO、EBO 时，几百个子网格的模型每帧要切换几百次
+// VAO 和缓冲区。GeometryArena 从少数几个大缓冲区中分配顶点和索引范围：
+//   - 每种顶点属性布局一个顶点池（一个 VBO + 一个 VAO），
+//     网格的顶点在池中的起始编号作为 glDrawElementsBaseVertex 的 baseVertex
+//   - 所有网格共用一个索引缓冲区，索引的字节偏移作为绘制时的 indices 参数
+//   - 空间用 RangeAllocator（首次适配的空闲链表）管理，不够时缓冲区容量翻倍，
+//     旧数据用 glCopyBufferSubData 复制到新缓冲区
+// 同一布局的网格绘制时只需要绑定一次 VAO（见 Model::Draw）
+// ============================================================================
+
+#pragma once
+
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <iterator>
+#include <map>
+#include <vector>
+
+#include "vertex_format.h"
+
+// ============================================================================
+// RangeAllocator - 首次适配的空闲链表分配器
+// ============================================================================
+// 管理 [0, capacity) 的整数范围（单位由使用者决定：顶点数或字节数），
+// 释放时与相邻的空闲块合并
+// ============================================================================
+class RangeAllocator
+{
+public:
+    explicit RangeAllocator(size_t capacity = 0) : m_capacity(0), m_used(0) { grow(capacity); }
+
+    // 分配 size 个单位，起点按 alignment 对齐，空间不够时返回 false
+    bool allocate(size_t size, size_t alignment, size_t& offset)
+    {
+        for (auto it = m_free.begin(); it != m_free.end(); ++it)
+        {
+            size_t blockStart = it->first;
+            size_t blockEnd = it->first + it->second;
+            size_t start = (blockStart + alignment - 1) / alignment * alignment;
+            if (start + size > blockEnd)
+                continue;
+
+            // 对齐留下的空隙和剩余部分仍然是空闲块
+            m_free.erase(it);
+            if (start > blockStart)
+                m_free[blockStart] = start - blockStart;
+            if (start + size < blockEnd)
+                m_free[start + size] = blockEnd - start - size;
+
+            offset = start;
+            m_used += size;
+            return true;
+        }
+        return false;
+    }
+
+    // 释放之前分配的范围
+    void free(size_t offset, size_t size)
+    {
+        m_used -= size;
+
+        auto next = m_free.lower_bound(offset);
+        if (next != m_free.end() && offset + size == next->first)
+        {
+            size += next->second;
+            next = m_free.erase(next);
+        }
+        if (next != m_free.begin())
+        {
+            auto previous = std::prev(next);
+            if (previous->first + previous->second == offset)
+            {
+                previous->second += size;
+                return;
+            }
+        }
+        m_free[offset] = size;
+    }
+
+    // 扩大容量，新增的部分成为空闲块
+    void grow(size_t capacity)
+    {
+        if (capacity <= m_capacity)
+            return;
+        size_t added = capacity - m_capacity;
+        size_t offset = m_capacity;
+        m_capacity = capacity;
+        m_used += added;         // free 会减去
+        free(offset, added);
+    }
+
+    size_t capacity() const { return m_capacity; }
+    size_t used() const { return m_used; }
+
+private:
+    std::map<size_t, size_t> m_free;       // 空闲块：起点 -> 大小
+    size_t m_capacity;
+    size_t m_used;
+};
+
+// ============================================================================
+// 一个网格在 GeometryArena 中的位置
+// ============================================================================
+struct GeometryRange {
+    unsigned int vao = 0;          // 所在顶点池的 VAO
+    GLint baseVertex = 0;          // 第一个顶点在顶点池中的编号
+    size_t indexOffset = 0;        // 索引在索引缓冲区中的字节偏移
+    int pool = -1;                 // 顶点池编号（-1 表示没有分配）
+    size_t vertexCount = 0;
+    size_t indexBytes = 0;
+};
+
+class GeometryArena
+{
+public:
+    GeometryArena() : m_ebo(0), m_indexCapacity(0) {}
+
+    // 和 Mesh 一样不在析构时删除 OpenGL 对象（上下文销毁时由驱动回收），需要时调用 release()
+    GeometryArena(const GeometryArena&) = delete;
+    GeometryArena& operator=(const GeometryArena&) = delete;
+
+    // ========================================================================
+    // 分配并上传一个网格的顶点和索引（需要当前有 OpenGL 上下文）
+    // ========================================================================
+    //   vertices:  已经按 format/layout 排好的顶点数据
+    //   indices:   索引数据，indexSize 为每个索引的字节数（1、2 或 4）
+    // ========================================================================
+    GeometryRange allocate(VertexFormat format, const PackedVertexLayout& layout,
+                           const void* vertices, size_t vertexCount,
+                           const void* indices, size_t indexBytes, size_t indexSize)
+    {
+        GeometryRange range;
+        range.pool = findPool(format, layout);
+        range.vertexCount = vertexCount;
+        range.indexBytes = indexBytes;
+
+        Pool& pool = m_pools[range.pool];
+        range.vao = pool.vao;
+
+        size_t vertexOffset = 0;
+        while (!pool.allocator.allocate(vertexCount, 1, vertexOffset))
+            growVertices(pool, vertexCount);
+        range.baseVertex = static_cast<GLint>(vertexOffset);
+
+        // 上传时用 COPY_WRITE 目标，不影响当前绑定的 VAO
+        glBindBuffer(GL_COPY_WRITE_BUFFER, pool.vbo);
+        glBufferSubData(GL_COPY_WRITE_BUFFER, vertexOffset * pool.stride, vertexCount * pool.stride, vertices);
+
+        while (!m_indexAllocator.allocate(indexBytes, indexSize, range.indexOffset))
+            growIndices(indexBytes);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, m_ebo);
+        glBufferSubData(GL_COPY_WRITE_BUFFER, range.indexOffset, indexBytes, indices);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        return range;
+    }
+
+    // 释放一个网格的空间（之后不能再绘制这个网格）
+    void free(const GeometryRange& range)
+    {
+        if (range.pool < 0)
+            return;
+        m_pools[range.pool].allocator.free(range.baseVertex, range.vertexCount);
+        m_indexAllocator.free(range.indexOffset, range.indexBytes);
+    }
+
+    // 删除所有缓冲区和 VAO
+    void release()
+    {
+        for (Pool& pool : m_pools)
+        {
+            glDeleteVertexArrays(1, &pool.vao);
+            glDeleteBuffers(1, &pool.vbo);
+        }
+        m_pools.clear();
+        if (m_ebo)
+            glDeleteBuffers(1, &m_ebo);
+        m_ebo = 0;
+        m_indexCapacity = 0;
+        m_indexAllocator = RangeAllocator();
+    }
+
+    // VAO 数（= 用到的顶点布局数）
+    size_t vaoCount() const { return m_pools.size(); }
+
+private:
+    // 缓冲区的最小容量（顶点数 / 字节数）
+    static constexpr size_t MIN_VERTICES = 1 << 16;
+    static constexpr size_t MIN_INDEX_BYTES = 1 << 20;
+
+    struct Pool {
+        int key;                       // 布局键，见 layoutKey
+        VertexFormat format;
+        PackedVertexLayout layout;     // 用来设置属性指针（同一布局的偏移都相同）
+        GLsizei stride;
+        unsigned int vao;
+        unsigned int vbo;
+        size_t capacity;               // 顶点数
+        RangeAllocator allocator;      // 单位为顶点
+    };
+
+    // 属性指针完全相同的布局得到相同的键
+    static int layoutKey(VertexFormat format, const PackedVertexLayout& layout)
+    {
+        if (format == VERTEX_FORMAT_FLOAT)
+            return 0;
+        return 1 + (layout.quantized ? 1 : 0) + (layout.hasBones ? 2 : 0) + (layout.wideBoneIds ? 4 : 0);
+    }
+
+    int findPool(VertexFormat format, const PackedVertexLayout& layout)
+    {
+        int key = layoutKey(format, layout);
+        for (size_t i = 0; i < m_pools.size(); i++)
+        {
+            if (m_pools[i].key == key)
+                return static_cast<int>(i);
+        }
+
+        Pool pool;
+        pool.key = key;
+        pool.format = format;
+        pool.layout = layout;
+        pool.stride = format == VERTEX_FORMAT_FLOAT ? static_cast<GLsizei>(sizeof(Vertex)) : layout.stride;
+        pool.vbo = 0;
+        pool.capacity = 0;
+        glGenVertexArrays(1, &pool.vao);
+        if (m_ebo)
+        {
+            glBindVertexArray(pool.vao);
+            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_ebo);
+            glBindVertexArray(0);
+        }
+        m_pools.push_back(pool);
+        return static_cast<int>(m_pools.size() - 1);
+    }
+
+    // 创建更大的缓冲区并复制旧数据，返回新缓冲区
+    static unsigned int reallocate(unsigned int buffer, size_t oldSize, size_t newSize)
+    {
+        unsigned int fresh;
+        glGenBuffers(1, &fresh);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, fresh);
+        glBufferData(GL_COPY_WRITE_BUFFER, newSize, nullptr, GL_STATIC_DRAW);
+        if (buffer)
+        {
+            glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+            glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, oldSize);
+            glBindBuffer(GL_COPY_READ_BUFFER, 0);
+            glDeleteBuffers(1, &buffer);
+        }
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        return fresh;
+    }
+
+    void growVertices(Pool& pool, size_t needed)
+    {
+        size_t capacity = std::max(std::max(pool.capacity * 2, pool.capacity + needed), MIN_VERTICES);
+        pool.vbo = reallocate(pool.vbo, pool.capacity * pool.stride, capacity * pool.stride);
+        pool.capacity = capacity;
+        pool.allocator.grow(capacity);
+
+        // VAO 的属性指针记录的是旧缓冲区，重新设置
+        glBindVertexArray(pool.vao);
+        glBindBuffer(GL_ARRAY_BUFFER, pool.vbo);
+        SetupVertexAttributes(pool.format, pool.layout);
+        glBindVertexArray(0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+
+    void growIndices(size_t needed)
+    {
+        size_t capacity = std::max(std::max(m_indexCapacity * 2, m_indexCapacity + needed), MIN_INDEX_BYTES);
+        m_ebo = reallocate(m_ebo, m_indexCapacity, capacity);
+        m_indexCapacity = capacity;
+        m_indexAllocator.grow(capacity);
+
+        // 索引缓冲区的绑定也是 VAO 状态的一部分
+        for (Pool& pool : m_pools)
+        {
+            glBindVertexArray(pool.vao);
+            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_ebo);
+        }
+        glBindVertexArray(0);
+    }
+
+    std::vector<Pool> m_pools;
+    unsigned int m_ebo;
+    size_t m_indexCapacity;                // 字节数
+    RangeAllocator m_indexAllocator;       // 单位为字节
+};
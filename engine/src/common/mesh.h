@@ -11,24 +11,12 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <string>
+#include <utility>
 #include <vector>
-#include <cstddef>  // for offsetof
+#include <cstring>
 #include "shader.h"
-
-#define MAX_BONE_INFLUENCE 4
-
-// ============================================================================
-// Vertex 结构体 - 顶点数据
-// ============================================================================
-struct Vertex {
-    glm::vec3 Position;    // 位置
-    glm::vec3 Normal;      // 法线
-    glm::vec2 TexCoords;   // 纹理坐标
-    glm::vec3 Tangent;     // 切线
-    glm::vec3 Bitangent;   // 副切线
-    int m_BoneIDs[MAX_BONE_INFLUENCE];  // 骨骼索引（用于骨骼动画）
-    float m_Weights[MAX_BONE_INFLUENCE]; // 骨骼权重（用于骨骼动画）
-};
+#include "vertex_format.h"   // Vertex、压缩顶点格式
+#include "geometry_arena.h"  // 共享的顶点/索引缓冲区
 
 // ============================================================================
 // Texture 结构体 - 纹理数据
@@ -37,6 +25,31 @@ struct Texture {
     unsigned int id;       // 纹理 ID
     std::string type;      // 纹理类型（如 "texture_diffuse", "texture_specular"）
     std::string path;      // 纹理文件路径
+    int layer = -1;        // 不小于 0 时 id 是纹理数组，纹理在其中的层（见 texture_array.h）
+};
+
+// 网格支持的纹理类型（Texture::type 的取值），采样器名为 类型名 + 编号
+enum TextureType {
+    TEXTURE_DIFFUSE,       // "texture_diffuse"
+    TEXTURE_SPECULAR,      // "texture_specular"
+    TEXTURE_NORMAL,        // "texture_normal"
+    TEXTURE_HEIGHT,        // "texture_height"
+    TEXTURE_TYPE_COUNT
+};
+
+// ============================================================================
+// 已经是显存格式的网格数据（顶点已打包、索引已缩窄），见 model_cache.h
+// ============================================================================
+struct MeshData {
+    VertexFormat format = VERTEX_FORMAT_FLOAT;
+    PackedVertexLayout layout;      // format 不是 FLOAT 时有效
+    const void* vertices = nullptr;
+    size_t vertexCount = 0;
+    size_t vertexBytes = 0;
+    const void* indices = nullptr;
+    size_t indexCount = 0;
+    size_t indexBytes = 0;
+    GLenum indexType = GL_UNSIGNED_INT;
 };
 
 // ============================================================================
@@ -45,123 +58,353 @@ struct Texture {
 class Mesh {
 public:
     // 网格数据
-    std::vector<Vertex>       vertices;  // 顶点数据
-    std::vector<unsigned int> indices;   // 索引数据
+    std::vector<Vertex>       vertices;  // 顶点数据（从 MeshData 创建的网格为空）
+    std::vector<unsigned int> indices;   // 索引数据（从 MeshData 创建的网格为空）
     std::vector<Texture>      textures;  // 纹理数据
     unsigned int VAO;                    // 顶点数组对象
 
     // ========================================================================
     // 构造函数
     // ========================================================================
-    Mesh(std::vector<Vertex> vertices, std::vector<unsigned int> indices, std::vector<Texture> textures)
+    // format 为显存中的顶点格式；压缩格式需要着色器定义 PACKED_VERTEX（见 vertex_format.h）
+    // arena 不为空时顶点和索引放在共享的缓冲区中（见 geometry_arena.h），
+    // 网格不拥有 VAO，arena 的生命周期必须比网格长
+    // ========================================================================
+    Mesh(std::vector<Vertex> vertices, std::vector<unsigned int> indices, std::vector<Texture> textures,
+         VertexFormat format = VERTEX_FORMAT_FLOAT, GeometryArena* arena = nullptr)
+        : VAO(0), VBO(0), EBO(0), m_format(format), m_arena(arena)
     {
-        this->vertices = vertices;
-        this->indices = indices;
+        this->vertices = std::move(vertices);
+        this->indices = std::move(indices);
         this->textures = textures;
+        for (size_t i = 0; i < this->vertices.size(); i++)
+            includeInBounds(this->vertices[i].Position, i == 0);
+
+        // 预先生成纹理采样器名
+        setupSamplerNames();
 
         // 设置顶点缓冲区和属性指针
         setupMesh();
     }
 
     // ========================================================================
-    // 渲染网格
+    // 从显存格式的数据创建（烘焙的模型缓存），数据直接上传，不保留 CPU 端副本
     // ========================================================================
-    void Draw(Shader &shader) 
+    Mesh(const MeshData& data, std::vector<Texture> textures, GeometryArena* arena = nullptr)
+        : VAO(0), VBO(0), EBO(0), m_format(data.format), m_arena(arena)
     {
-        // 绑定适当的纹理
-        unsigned int diffuseNr  = 1;
-        unsigned int specularNr = 1;
-        unsigned int normalNr   = 1;
-        unsigned int heightNr   = 1;
-        
-        for(unsigned int i = 0; i < textures.size(); i++)
+        this->textures = textures;
+        m_layout = data.layout;
+        m_indexType = data.indexType;
+        m_vertexCount = data.vertexCount;
+        m_indexCount = data.indexCount;
+
+        // 包围盒：量化格式的反量化参数就是包围盒，其他格式读取每个顶点开头的 3 个 float
+        if (data.layout.quantized)
         {
-            glActiveTexture(GL_TEXTURE0 + i); // 在绑定之前激活相应的纹理单元
-            
-            // 检索纹理编号（diffuse_textureN 中的 N）
-            std::string number;
-            std::string name = textures[i].type;
-            
-            if(name == "texture_diffuse")
-                number = std::to_string(diffuseNr++);
-            else if(name == "texture_specular")
-                number = std::to_string(specularNr++);
-            else if(name == "texture_normal")
-                number = std::to_string(normalNr++);
-            else if(name == "texture_height")
-                number = std::to_string(heightNr++);
-
-            // 现在将采样器设置为正确的纹理单元
-            shader.setInt((name + number).c_str(), i);
-            // 最后绑定纹理
-            glBindTexture(GL_TEXTURE_2D, textures[i].id);
+            m_boundsMin = data.layout.positionOffset;
+            m_boundsMax = data.layout.positionOffset + data.layout.positionScale;
+        }
+        else
+        {
+            const unsigned char* vertex = static_cast<const unsigned char*>(data.vertices);
+            for (size_t i = 0; i < data.vertexCount; i++, vertex += vertexStride())
+            {
+                glm::vec3 position;
+                std::memcpy(&position, vertex, sizeof(position));
+                includeInBounds(position, i == 0);
+            }
         }
-        
-        // 绘制网格
+
+        setupSamplerNames();
+        if (data.vertexCount && data.indexCount)
+            uploadMesh(data.vertices, data.vertexBytes, data.indices, data.indexBytes);
+    }
+
+    // ========================================================================
+    // 渲染网格
+    // ========================================================================
+    // 采样器名（texture_diffuse1 等）在创建网格时就拼好，
+    // 采样器位置对每个着色器程序只查找一次，所以每帧的绘制路径不分配内存
+    // ========================================================================
+    void Draw(Shader &shader) 
+    {
         glBindVertexArray(VAO);
-        glDrawElements(GL_TRIANGLES, static_cast<unsigned int>(indices.size()), GL_UNSIGNED_INT, 0);
+        DrawElements(shader);
         glBindVertexArray(0);
 
         // 配置完成后，将一切设置回默认值是一个好习惯
         glActiveTexture(GL_TEXTURE0);
     }
 
+    // ========================================================================
+    // 设置纹理和 uniform 并绘制，VAO 由调用者绑定
+    // ========================================================================
+    // 单独绘制一个网格时使用；压缩格式的反量化参数通过 uniform 传入
+    // （Model 不经过这里，反量化参数是实例属性，见 Model::Draw）
+    // ========================================================================
+    void DrawElements(Shader &shader)
+    {
+        BindMaterial(shader);
+
+        // 压缩格式：位置的反量化参数（uniform 位置已由 BindMaterial 解析）
+        if (m_format != VERTEX_FORMAT_FLOAT)
+        {
+            shader.setVec3(m_positionScale, m_layout.positionScale);
+            shader.setVec3(m_positionOffset, m_layout.positionOffset);
+        }
+
+        // 绘制网格（不使用 arena 时 baseVertex 和偏移都为 0）
+        glDrawElementsBaseVertex(GL_TRIANGLES, static_cast<GLsizei>(m_indexCount), m_indexType,
+                                 (void*)m_range.indexOffset, m_range.baseVertex);
+    }
+
+    // ========================================================================
+    // 只设置纹理和采样器 uniform（材质），不绘制
+    // ========================================================================
+    // 不设置压缩格式的反量化参数：一批中各网格的量化范围可以不同（见 SameMaterial）
+    // ========================================================================
+    void BindMaterial(Shader &shader)
+    {
+        // 换了着色器（或着色器被热重载）时重新解析 uniform 位置
+        if (m_uniformSerial != shader.serial())
+            resolveUniforms(shader);
+
+        // 绑定适当的纹理（第 i 个纹理使用纹理单元 i）
+        for(unsigned int i = 0; i < textures.size(); i++)
+        {
+            glActiveTexture(GL_TEXTURE0 + i); // 在绑定之前激活相应的纹理单元
+            // 将采样器设置为正确的纹理单元（值不变时 Shader 会跳过上传）
+            shader.setInt(m_samplers[i], i);
+            // 最后绑定纹理（纹理数组的层号由实例属性传给着色器，见 Model）
+            glBindTexture(textures[i].layer >= 0 ? GL_TEXTURE_2D_ARRAY : GL_TEXTURE_2D, textures[i].id);
+        }
+    }
+
+    // ========================================================================
+    // 材质（纹理）是否与另一个网格完全相同
+    // ========================================================================
+    // 相同时两个网格可以合并到同一次 MultiDraw 中（见 Model::buildBatches）
+    // 纹理数组只比较数组本身，不同的层由各自的实例属性区分；
+    // 压缩格式的反量化参数也由 Model 作为实例属性传入，不需要相同
+    // （所以绘制压缩格式 Model 的着色器必须定义 MODEL_INSTANCES，见 Model::Draw）
+    // ========================================================================
+    bool SameMaterial(const Mesh& other) const
+    {
+        if (m_format != other.m_format || textures.size() != other.textures.size())
+            return false;
+        for (size_t i = 0; i < textures.size(); i++)
+        {
+            if (textures[i].id != other.textures[i].id || textures[i].type != other.textures[i].type)
+                return false;
+        }
+        return true;
+    }
+
+    // 在 GeometryArena 中的位置（不使用 arena 时 baseVertex 和偏移都为 0）
+    const GeometryRange& geometryRange() const { return m_range; }
+
+    // 显存中的索引类型（GL_UNSIGNED_BYTE/SHORT/INT，按顶点数自动选择）
+    GLenum indexType() const { return m_indexType; }
+    // 每个索引的字节数
+    unsigned int indexSize() const
+    {
+        return m_indexType == GL_UNSIGNED_BYTE ? 1 : (m_indexType == GL_UNSIGNED_SHORT ? 2 : 4);
+    }
+
+    // 顶点数和索引数（从 MeshData 创建的网格 vertices/indices 为空，用这两个）
+    size_t vertexCount() const { return m_vertexCount; }
+    size_t indexCount() const { return m_indexCount; }
+
+    // 模型空间的包围盒
+    const glm::vec3& boundsMin() const { return m_boundsMin; }
+    const glm::vec3& boundsMax() const { return m_boundsMax; }
+
+    // 显存中的顶点格式和每个顶点的字节数
+    VertexFormat vertexFormat() const { return m_format; }
+    const PackedVertexLayout& packedLayout() const { return m_layout; }
+    GLsizei vertexStride() const
+    {
+        return m_format == VERTEX_FORMAT_FLOAT ? static_cast<GLsizei>(sizeof(Vertex)) : m_layout.stride;
+    }
+
+    // ========================================================================
+    // 上传到显存的顶点和索引数据（写模型缓存用，需要 vertices/indices 不为空）
+    // ========================================================================
+    std::vector<unsigned char> gpuVertexData() const
+    {
+        if (m_format != VERTEX_FORMAT_FLOAT)
+            return VertexPacker::pack(vertices, m_layout);
+        const unsigned char* bytes = reinterpret_cast<const unsigned char*>(vertices.data());
+        return std::vector<unsigned char>(bytes, bytes + vertices.size() * sizeof(Vertex));
+    }
+
+    // 转换为 indexType() 类型的索引
+    std::vector<unsigned char> gpuIndexData() const
+    {
+        std::vector<unsigned char> data;
+        if (m_indexType == GL_UNSIGNED_BYTE)
+        {
+            data.assign(indices.begin(), indices.end());
+        }
+        else if (m_indexType == GL_UNSIGNED_SHORT)
+        {
+            std::vector<unsigned short> narrow(indices.begin(), indices.end());
+            data.resize(narrow.size() * sizeof(unsigned short));
+            std::memcpy(data.data(), narrow.data(), data.size());
+        }
+        else
+        {
+            data.resize(indices.size() * sizeof(unsigned int));
+            std::memcpy(data.data(), indices.data(), data.size());
+        }
+        return data;
+    }
+
 private:
     // 渲染数据
     unsigned int VBO, EBO;
+    VertexFormat       m_format;
+    GeometryArena*     m_arena;              // 为空时网格有自己的 VAO/VBO/EBO
+    GeometryRange      m_range;              // 在 arena 中的位置
+    GLenum             m_indexType = GL_UNSIGNED_INT;
+    size_t             m_vertexCount = 0;
+    size_t             m_indexCount = 0;
+    PackedVertexLayout m_layout;             // 压缩格式的布局（m_format 不是 FLOAT 时有效）
+    glm::vec3          m_boundsMin = glm::vec3(0.0f);
+    glm::vec3          m_boundsMax = glm::vec3(0.0f);
+
+    // 纹理采样器：m_samplerNames[i] 为第 i 个纹理的采样器名（如 texture_diffuse1），
+    // m_samplers[i] 为它在 m_uniformSerial 对应的着色器程序中的位置
+    std::vector<std::string>   m_samplerNames;
+    std::vector<UniformHandle> m_samplers;
+    UniformHandle              m_positionScale;
+    UniformHandle              m_positionOffset;
+    unsigned int               m_uniformSerial = 0;
+
+    // ========================================================================
+    // 生成采样器名（创建网格时调用一次）
+    // ========================================================================
+    // 按类型编号：diffuse_textureN 中的 N 从 1 开始，每种类型单独计数
+    // ========================================================================
+    void setupSamplerNames()
+    {
+        static const char* const TYPES[TEXTURE_TYPE_COUNT] = {
+            "texture_diffuse", "texture_specular", "texture_normal", "texture_height"
+        };
+        unsigned int counters[TEXTURE_TYPE_COUNT] = {};
+
+        m_samplerNames.clear();
+        for (const Texture& texture : textures)
+        {
+            std::string name = texture.type;
+            for (unsigned int type = 0; type < TEXTURE_TYPE_COUNT; type++)
+            {
+                if (texture.type == TYPES[type])
+                {
+                    name += std::to_string(++counters[type]);
+                    break;
+                }
+            }
+            m_samplerNames.push_back(name);
+        }
+        m_samplers.assign(textures.size(), UniformHandle());
+        m_uniformSerial = 0;
+    }
+
+    // 能索引 vertexCount 个顶点的最小索引类型
+    static GLenum indexTypeFor(size_t vertexCount)
+    {
+        if (vertexCount <= 0x100)
+            return GL_UNSIGNED_BYTE;
+        if (vertexCount <= 0x10000)
+            return GL_UNSIGNED_SHORT;
+        return GL_UNSIGNED_INT;
+    }
+
+    // 在指定着色器中查找 Draw 用到的所有 uniform 的位置
+    void resolveUniforms(const Shader& shader)
+    {
+        for (size_t i = 0; i < m_samplerNames.size(); i++)
+            m_samplers[i] = shader.getUniform(m_samplerNames[i]);
+        m_positionScale = shader.getUniform("meshPositionScale");
+        m_positionOffset = shader.getUniform("meshPositionOffset");
+        m_uniformSerial = shader.serial();
+    }
+
+    // 把一个顶点位置加入包围盒（first 为 true 时重新开始）
+    void includeInBounds(const glm::vec3& position, bool first)
+    {
+        m_boundsMin = first ? position : glm::min(m_boundsMin, position);
+        m_boundsMax = first ? position : glm::max(m_boundsMax, position);
+    }
 
     // ========================================================================
     // 初始化所有缓冲区对象/数组
     // ========================================================================
     void setupMesh()
     {
+        m_vertexCount = vertices.size();
+        m_indexCount = indices.size();
+        if (vertices.empty() || indices.empty())
+            return;
+
+        // 顶点数据
+        // 结构体的一个很好的特性是它们的内存布局对所有项目都是顺序的
+        // 效果是我们可以简单地传递一个指向结构的指针，它完美地转换为 glm::vec3/2 数组
+        // 这又转换为 3/2 个浮点数，再转换为字节数组
+        const void* vertexData = &vertices[0];
+        size_t vertexBytes = vertices.size() * sizeof(Vertex);
+        std::vector<unsigned char> packed;
+        if (m_format != VERTEX_FORMAT_FLOAT)
+        {
+            // 压缩格式：先打包
+            m_layout = VertexPacker::makeLayout(vertices, m_format == VERTEX_FORMAT_QUANTIZED);
+            packed = VertexPacker::pack(vertices, m_layout);
+            vertexData = packed.data();
+            vertexBytes = packed.size();
+        }
+
+        // 索引用能容纳所有顶点编号的最小类型：大部分子网格顶点数少于 65536，
+        // 用 16 位索引可以省一半的索引内存和读取带宽
+        m_indexType = indexTypeFor(vertices.size());
+        std::vector<unsigned char> indexData = gpuIndexData();
+
+        uploadMesh(vertexData, vertexBytes, indexData.data(), indexData.size());
+    }
+
+    // ========================================================================
+    // 上传显存格式的顶点和索引，创建 VAO
+    // ========================================================================
+    // 有 GeometryArena 时从共享的缓冲区中分配，VAO 为对应顶点池的 VAO
+    // ========================================================================
+    void uploadMesh(const void* vertexData, size_t vertexBytes, const void* indexData, size_t indexBytes)
+    {
+        if (m_arena)
+        {
+            m_range = m_arena->allocate(m_format, m_layout, vertexData, m_vertexCount,
+                                        indexData, indexBytes, indexSize());
+            VAO = m_range.vao;
+            return;
+        }
+
         // 创建缓冲区/数组
         glGenVertexArrays(1, &VAO);
         glGenBuffers(1, &VBO);
         glGenBuffers(1, &EBO);
 
         glBindVertexArray(VAO);
-        
-        // 将数据加载到顶点缓冲区
-        glBindBuffer(GL_ARRAY_BUFFER, VBO);
-        // 结构体的一个很好的特性是它们的内存布局对所有项目都是顺序的
-        // 效果是我们可以简单地传递一个指向结构的指针，它完美地转换为 glm::vec3/2 数组
-        // 这又转换为 3/2 个浮点数，再转换为字节数组
-        glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), &vertices[0], GL_STATIC_DRAW);  
 
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), &indices[0], GL_STATIC_DRAW);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexBytes, indexData, GL_STATIC_DRAW);
+
+        // 将数据加载到顶点缓冲区
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        glBufferData(GL_ARRAY_BUFFER, vertexBytes, vertexData, GL_STATIC_DRAW);
 
         // 设置顶点属性指针
-        // 顶点位置
-        glEnableVertexAttribArray(0);	
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)0);
-        
-        // 顶点法线
-        glEnableVertexAttribArray(1);	
-        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, Normal));
-        
-        // 顶点纹理坐标
-        glEnableVertexAttribArray(2);	
-        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, TexCoords));
-        
-        // 顶点切线
-        glEnableVertexAttribArray(3);
-        glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, Tangent));
-        
-        // 顶点副切线
-        glEnableVertexAttribArray(4);
-        glVertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, Bitangent));
-        
-        // 骨骼 ID
-        glEnableVertexAttribArray(5);
-        glVertexAttribIPointer(5, 4, GL_INT, sizeof(Vertex), (void*)offsetof(Vertex, m_BoneIDs));
-
-        // 骨骼权重
-        glEnableVertexAttribArray(6);
-        glVertexAttribPointer(6, 4, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, m_Weights));
-        
+        SetupVertexAttributes(m_format, m_layout);
+
         glBindVertexArray(0);
     }
 };
-
@@ -0,0 +1,374 @@
+// ============================================================================
+// MeshOptimizer - 导入网格的索引/顶点重排
+// ============================================================================
+// Assimp 按文件中的顺序给出三角形，相邻的三角形往往不共享顶点，
+// GPU 的顶点后变换缓存（post-transform cache）命中率很低，同一个顶点会被
+// 顶点着色器处理很多次。导入时依次做三步重排（不改变网格的形状）：
+//   1. optimizeVertexCache: Tipsify 算法（Sander 等，2007）重排三角形，
+//      让共享顶点的三角形挨在一起
+//   2. optimizeOverdraw:    把三角形分成簇，朝外的簇先画，减少过度绘制；
+//      只在缓存命中率几乎不变的位置分簇
+//   3. optimizeVertexFetch: 按第一次使用的顺序重排顶点，顶点读取更连续
+//
+// 衡量指标（analyzeVertexCache，模拟 FIFO 缓存）：
+//   ACMR = 缓存未命中数 / 三角形数（最差 3，理想接近 0.5）
+//   ATVR = 缓存未命中数 / 顶点数  （理想为 1，即每个顶点只处理一次）
+//
+// 纯 CPU 代码，不需要 OpenGL 上下文
+// ============================================================================
+
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+// ============================================================================
+// 缓存统计（可以累加多个网格的结果）
+// ============================================================================
+struct VertexCacheStats {
+    size_t triangles = 0;      // 三角形数
+    size_t vertices = 0;       // 被索引引用的顶点数
+    size_t misses = 0;         // 缓存未命中数（= 顶点着色器调用次数）
+
+    double acmr() const { return triangles ? double(misses) / triangles : 0.0; }
+    double atvr() const { return vertices ? double(misses) / vertices : 0.0; }
+
+    VertexCacheStats& operator+=(const VertexCacheStats& other)
+    {
+        triangles += other.triangles;
+        vertices += other.vertices;
+        misses += other.misses;
+        return *this;
+    }
+};
+
+class MeshOptimizer
+{
+public:
+    // 模拟的缓存大小（现代 GPU 的有效大小大致在 16～32 之间）
+    static const unsigned int CACHE_SIZE = 16;
+
+    // ========================================================================
+    // 模拟 FIFO 顶点缓存，统计 ACMR/ATVR
+    // ========================================================================
+    static VertexCacheStats analyzeVertexCache(const std::vector<unsigned int>& indices, size_t vertexCount,
+                                               unsigned int cacheSize = CACHE_SIZE)
+    {
+        VertexCacheStats stats;
+        stats.triangles = indices.size() / 3;
+
+        // 每个顶点进入缓存的时间戳，time - stamp < cacheSize 表示还在缓存中
+        std::vector<size_t> stamps(vertexCount, 0);
+        std::vector<bool> used(vertexCount, false);
+        size_t time = cacheSize + 1;
+        for (unsigned int index : indices)
+        {
+            if (!used[index])
+            {
+                used[index] = true;
+                stats.vertices++;
+            }
+            if (time - stamps[index] > cacheSize)
+            {
+                stamps[index] = time++;
+                stats.misses++;
+            }
+        }
+        return stats;
+    }
+
+    // ========================================================================
+    // 1. 顶点缓存优化（Tipsify）
+    // ========================================================================
+    // 围绕一个"扇心"顶点输出它所有未输出的三角形，然后从刚输出的顶点中选择
+    // 输出完剩余三角形后仍会留在缓存中的顶点（进入缓存最早的优先）作为下一个扇心；
+    // 找不到时从最近输出的顶点（dead-end 栈）或按编号顺序继续
+    // ========================================================================
+    static void optimizeVertexCache(std::vector<unsigned int>& indices, size_t vertexCount,
+                                    unsigned int cacheSize = CACHE_SIZE)
+    {
+        size_t triangleCount = indices.size() / 3;
+        if (triangleCount == 0)
+            return;
+
+        Adjacency adjacency = buildAdjacency(indices, vertexCount);
+        std::vector<unsigned int> live(adjacency.counts);         // 每个顶点剩余未输出的三角形数
+        std::vector<size_t> stamps(vertexCount, 0);
+        std::vector<bool> emitted(triangleCount, false);
+        std::vector<unsigned int> deadEnd;                        // 最近输出的顶点
+        std::vector<unsigned int> candidates;
+        std::vector<unsigned int> result;
+        result.reserve(triangleCount * 3);
+
+        size_t time = cacheSize + 1;
+        unsigned int cursor = 0;                                  // 按编号顺序寻找下一个扇心的位置
+        long long fan = 0;
+
+        while (fan >= 0)
+        {
+            candidates.clear();
+            unsigned int begin = adjacency.offsets[fan];
+            for (unsigned int k = begin; k < begin + adjacency.counts[fan]; k++)
+            {
+                unsigned int triangle = adjacency.triangles[k];
+                if (emitted[triangle])
+                    continue;
+                emitted[triangle] = true;
+                for (int corner = 0; corner < 3; corner++)
+                {
+                    unsigned int vertex = indices[triangle * 3 + corner];
+                    result.push_back(vertex);
+                    deadEnd.push_back(vertex);
+                    candidates.push_back(vertex);
+                    live[vertex]--;
+                    if (time - stamps[vertex] > cacheSize)
+                        stamps[vertex] = time++;
+                }
+            }
+            fan = nextFan(candidates, live, stamps, time, cacheSize, deadEnd, cursor);
+        }
+        indices.swap(result);
+    }
+
+    // ========================================================================
+    // 2. 过度绘制优化（在 optimizeVertexCache 之后调用）
+    // ========================================================================
+    // 先在缓存被完全刷新的位置（三个顶点都未命中）切分，再在每段中
+    // 局部 ACMR 不超过 threshold 倍的位置继续切分；然后按
+    // dot(簇中心 - 网格中心, 簇法线) 从大到小排序簇，
+    // 朝外的簇先画，更容易挡住后面的片段
+    //   positions: 第一个顶点位置的地址，stride 为相邻顶点之间的字节数
+    //   threshold: 允许的 ACMR 变化倍数（1.05 表示最多变差 5%）
+    // ========================================================================
+    static void optimizeOverdraw(std::vector<unsigned int>& indices, const glm::vec3* positions,
+                                 size_t stride, float threshold = 1.05f, unsigned int cacheSize = CACHE_SIZE)
+    {
+        size_t triangleCount = indices.size() / 3;
+        if (triangleCount < 2)
+            return;
+
+        std::vector<size_t> clusters = clusterBoundaries(indices, threshold, cacheSize);
+
+        // 网格中心（按三角形面积加权）
+        auto position = [&](unsigned int index) -> const glm::vec3& {
+            return *reinterpret_cast<const glm::vec3*>(reinterpret_cast<const char*>(positions) + index * stride);
+        };
+        glm::vec3 meshCenter(0.0f);
+        float meshArea = 0.0f;
+        for (size_t t = 0; t < triangleCount; t++)
+        {
+            const glm::vec3& a = position(indices[t * 3]);
+            const glm::vec3& b = position(indices[t * 3 + 1]);
+            const glm::vec3& c = position(indices[t * 3 + 2]);
+            float area = glm::length(glm::cross(b - a, c - a));
+            meshCenter += (a + b + c) * (area / 3.0f);
+            meshArea += area;
+        }
+        if (meshArea > 0.0f)
+            meshCenter /= meshArea;
+
+        // 每个簇的排序键
+        struct Cluster {
+            size_t begin, end;      // 三角形范围 [begin, end)
+            float key;
+        };
+        std::vector<Cluster> sorted;
+        for (size_t i = 0; i < clusters.size(); i++)
+        {
+            Cluster cluster;
+            cluster.begin = clusters[i];
+            cluster.end = i + 1 < clusters.size() ? clusters[i + 1] : triangleCount;
+
+            glm::vec3 center(0.0f), normal(0.0f);
+            float area = 0.0f;
+            for (size_t t = cluster.begin; t < cluster.end; t++)
+            {
+                const glm::vec3& a = position(indices[t * 3]);
+                const glm::vec3& b = position(indices[t * 3 + 1]);
+                const glm::vec3& c = position(indices[t * 3 + 2]);
+                glm::vec3 cross = glm::cross(b - a, c - a);     // 长度为面积的两倍
+                float triangleArea = glm::length(cross);
+                center += (a + b + c) * (triangleArea / 3.0f);
+                normal += cross;
+                area += triangleArea;
+            }
+            if (area > 0.0f)
+                center /= area;
+            float normalLength = glm::length(normal);
+            cluster.key = normalLength > 0.0f ? glm::dot(center - meshCenter, normal / normalLength) : 0.0f;
+            sorted.push_back(cluster);
+        }
+        std::stable_sort(sorted.begin(), sorted.end(),
+                         [](const Cluster& a, const Cluster& b) { return a.key > b.key; });
+
+        std::vector<unsigned int> result;
+        result.reserve(indices.size());
+        for (const Cluster& cluster : sorted)
+            result.insert(result.end(), indices.begin() + cluster.begin * 3, indices.begin() + cluster.end * 3);
+        indices.swap(result);
+    }
+
+    // ========================================================================
+    // 3. 顶点读取优化：按索引中第一次出现的顺序重排顶点
+    // ========================================================================
+    // 没有被任何三角形引用的顶点会被删除，返回新的顶点数
+    // ========================================================================
+    template <typename VertexType>
+    static size_t optimizeVertexFetch(std::vector<VertexType>& vertices, std::vector<unsigned int>& indices)
+    {
+        const unsigned int UNUSED = ~0u;
+        std::vector<unsigned int> remap(vertices.size(), UNUSED);
+        std::vector<VertexType> result;
+        result.reserve(vertices.size());
+
+        for (unsigned int& index : indices)
+        {
+            if (remap[index] == UNUSED)
+            {
+                remap[index] = static_cast<unsigned int>(result.size());
+                result.push_back(vertices[index]);
+            }
+            index = remap[index];
+        }
+        vertices.swap(result);
+        return vertices.size();
+    }
+
+private:
+    // 顶点 -> 使用它的三角形列表（压缩存储）
+    struct Adjacency {
+        std::vector<unsigned int> counts;      // 每个顶点的三角形数
+        std::vector<unsigned int> offsets;     // 在 triangles 中的起始位置
+        std::vector<unsigned int> triangles;
+    };
+
+    static Adjacency buildAdjacency(const std::vector<unsigned int>& indices, size_t vertexCount)
+    {
+        Adjacency adjacency;
+        adjacency.counts.assign(vertexCount, 0);
+        adjacency.offsets.assign(vertexCount, 0);
+        adjacency.triangles.resize(indices.size());
+
+        for (unsigned int index : indices)
+            adjacency.counts[index]++;
+        unsigned int offset = 0;
+        for (size_t v = 0; v < vertexCount; v++)
+        {
+            adjacency.offsets[v] = offset;
+            offset += adjacency.counts[v];
+        }
+
+        std::vector<unsigned int> fill(adjacency.offsets);
+        for (size_t i = 0; i < indices.size(); i++)
+            adjacency.triangles[fill[indices[i]]++] = static_cast<unsigned int>(i / 3);
+        return adjacency;
+    }
+
+    // Tipsify 选择下一个扇心：优先选择输出剩余三角形后仍在缓存中、且在缓存中最久的顶点
+    static long long nextFan(const std::vector<unsigned int>& candidates, const std::vector<unsigned int>& live,
+                             const std::vector<size_t>& stamps, size_t time, unsigned int cacheSize,
+                             std::vector<unsigned int>& deadEnd, unsigned int& cursor)
+    {
+        long long best = -1;
+        long long bestPriority = -1;
+        for (unsigned int vertex : candidates)
+        {
+            if (live[vertex] == 0)
+                continue;
+            long long priority = 0;
+            if (time - stamps[vertex] + 2 * live[vertex] <= cacheSize)
+                priority = static_cast<long long>(time - stamps[vertex]);
+            if (priority > bestPriority)
+            {
+                bestPriority = priority;
+                best = vertex;
+            }
+        }
+        if (best >= 0)
+            return best;
+
+        // dead-end：先找最近输出、还有剩余三角形的顶点
+        while (!deadEnd.empty())
+        {
+            unsigned int vertex = deadEnd.back();
+            deadEnd.pop_back();
+            if (live[vertex] > 0)
+                return vertex;
+        }
+        // 再按编号顺序找
+        while (cursor < live.size())
+        {
+            if (live[cursor] > 0)
+                return cursor;
+            cursor++;
+        }
+        return -1;
+    }
+
+    // 过度绘制优化的分簇位置（每个簇第一个三角形的编号）
+    static std::vector<size_t> clusterBoundaries(const std::vector<unsigned int>& indices, float threshold,
+                                                 unsigned int cacheSize)
+    {
+        size_t triangleCount = indices.size() / 3;
+        size_t vertexCount = *std::max_element(indices.begin(), indices.end()) + 1;
+
+        // 硬边界：三个顶点都未命中，说明 Tipsify 在这里跳到了网格的另一部分
+        std::vector<size_t> hard;
+        std::vector<size_t> stamps(vertexCount, 0);
+        size_t time = cacheSize + 1;
+        for (size_t t = 0; t < triangleCount; t++)
+        {
+            if (simulateRange(indices, t, t + 1, stamps, time, cacheSize) == 3 || t == 0)
+                hard.push_back(t);
+        }
+        hard.push_back(triangleCount);
+
+        // 软边界：从簇的起点重新模拟缓存（相当于簇在任意位置开始绘制），
+        // 局部 ACMR 不超过整段 ACMR 的 threshold 倍时就可以在这里切开
+        // （time 增加 cacheSize + 1 相当于清空缓存，不需要重置 stamps）
+        std::vector<size_t> boundaries;
+        for (size_t h = 0; h + 1 < hard.size(); h++)
+        {
+            size_t begin = hard[h], end = hard[h + 1];
+            time += cacheSize + 1;
+            double segmentAcmr = double(simulateRange(indices, begin, end, stamps, time, cacheSize)) / (end - begin);
+
+            size_t start = begin;
+            boundaries.push_back(start);
+            time += cacheSize + 1;
+            size_t misses = 0;
+            for (size_t t = begin; t < end; t++)
+            {
+                misses += simulateRange(indices, t, t + 1, stamps, time, cacheSize);
+                size_t count = t + 1 - start;
+                if (t + 1 < end && misses <= count * segmentAcmr * threshold)
+                {
+                    start = t + 1;
+                    boundaries.push_back(start);
+                    time += cacheSize + 1;
+                    misses = 0;
+                }
+            }
+        }
+        return boundaries;
+    }
+
+    // 模拟三角形 [begin, end)，返回未命中数
+    static size_t simulateRange(const std::vector<unsigned int>& indices, size_t begin, size_t end,
+                                std::vector<size_t>& stamps, size_t& time, unsigned int cacheSize)
+    {
+        size_t misses = 0;
+        for (size_t i = begin * 3; i < end * 3; i++)
+        {
+            if (time - stamps[indices[i]] > cacheSize)
+            {
+                stamps[indices[i]] = time++;
+                misses++;
+            }
+        }
+        return misses;
+    }
+};
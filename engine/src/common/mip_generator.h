@@ -0,0 +1,547 @@
+// ============================================================================
+// MipGenerator - 在 CPU 上生成 mipmap
+// ============================================================================
+// glGenerateMipmap 在软件渲染（llvmpipe）上很慢，而且对 sRGB 数据也直接在 gamma 空间平均，
+// 缩小后的颜色偏暗。MipGenerator 在工作线程上生成完整的 mip 链：
+//   - 盒式滤波（2x2 平均）：RGBA8 用 SIMD 整数运算（SSE2/AVX2/NEON，AVX2 运行时检测）
+//   - Kaiser 滤波：8 抽头的可分离窗口 sinc，远处的纹理更清晰、摩尔纹更少
+//   - sRGB：先转换到线性空间再滤波，结果再编码回 sRGB（alpha 始终是线性的）
+//   - alpha 覆盖率：镂空纹理（草、铁丝网）缩小后 alpha 被平均，alpha 测试通过的像素越来越少，
+//     远处的镂空物体会“消失”；每一级缩放 alpha，使超过阈值的像素比例与第 0 级相同
+// 每一级按行分给 ThreadPool 并行执行
+//
+// 设置 OPENGL_CPU_MIPMAPS=0 时 TextureLoader 等改回 glGenerateMipmap；
+// OPENGL_MIP_FILTER=kaiser 使用 Kaiser 滤波（默认盒式）
+// ============================================================================
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <vector>
+
+#include "texture_flags.h"
+#include "thread_pool.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <immintrin.h>
+#define MIP_SIMD_SSE2 1
+#if defined(__GNUC__) || defined(__clang__)
+#define MIP_SIMD_AVX2 1            // 用 target 属性编译，运行时检测 CPU 是否支持
+#define MIP_TARGET_AVX2 __attribute__((target("avx2")))
+#elif defined(__AVX2__)
+#define MIP_SIMD_AVX2 1
+#define MIP_TARGET_AVX2
+#endif
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define MIP_SIMD_NEON 1
+#endif
+
+enum MipFilter {
+    MIP_FILTER_BOX,                 // 2x2 平均
+    MIP_FILTER_KAISER,              // 8 抽头 Kaiser 窗口 sinc
+};
+
+struct MipOptions {
+    MipFilter filter = MIP_FILTER_BOX;
+    bool srgb = false;                        // RGB 是 sRGB 编码，在线性空间滤波
+    bool preserveAlphaCoverage = false;       // 保持 alpha 超过 alphaCutoff 的像素比例
+    float alphaCutoff = 0.5f;
+};
+
+// ============================================================================
+// 完整的 mip 链（所有级别连续存放，通道数与源图片相同）
+// ============================================================================
+struct MipChain {
+    struct Level {
+        int width;
+        int height;
+        size_t offset;                        // 在 data 中的字节偏移
+        size_t size;
+    };
+
+    int components = 0;
+    std::vector<Level> levels;
+    std::vector<unsigned char> data;
+
+    const unsigned char* level(size_t index) const { return data.data() + levels[index].offset; }
+};
+
+class MipGenerator
+{
+public:
+    static bool isEnabled()
+    {
+        const char* value = std::getenv("OPENGL_CPU_MIPMAPS");
+        return !value || std::strcmp(value, "0") != 0;
+    }
+
+    // ========================================================================
+    // 纹理加载选项对应的 mipmap 选项（sRGB、alpha 测试；滤波器来自 OPENGL_MIP_FILTER）
+    // ========================================================================
+    static MipOptions optionsFor(unsigned int textureFlags)
+    {
+        MipOptions options;
+        const char* filter = std::getenv("OPENGL_MIP_FILTER");
+        if (filter && std::strcmp(filter, "kaiser") == 0)
+            options.filter = MIP_FILTER_KAISER;
+        options.srgb = (textureFlags & TEXTURE_FLAG_SRGB) != 0;
+        options.preserveAlphaCoverage = (textureFlags & TEXTURE_FLAG_ALPHA_TEST) != 0;
+        return options;
+    }
+
+    // ========================================================================
+    // 生成完整的 mip 链（第 0 级是 pixels 的副本），可以在任意线程调用
+    // ========================================================================
+    static void generate(const unsigned char* pixels, int width, int height, int components,
+                         const MipOptions& options, MipChain& chain)
+    {
+        chain.components = components;
+        chain.levels.clear();
+
+        // 先算出所有级别的尺寸，一次分配
+        size_t total = 0;
+        for (int w = width, h = height;; w = std::max(1, w / 2), h = std::max(1, h / 2))
+        {
+            MipChain::Level level = { w, h, total, size_t(w) * h * components };
+            chain.levels.push_back(level);
+            total += level.size;
+            if (w == 1 && h == 1)
+                break;
+        }
+        chain.data.resize(total);
+        std::memcpy(chain.data.data(), pixels, chain.levels[0].size);
+
+        int alpha = alphaChannel(components);
+        bool coverage = options.preserveAlphaCoverage && alpha >= 0;
+        float targetCoverage = coverage ? alphaCoverage(pixels, width, height, components, alpha, options.alphaCutoff, 1.0f)
+                                        : 0.0f;
+
+        for (size_t i = 1; i < chain.levels.size(); i++)
+        {
+            const MipChain::Level& src = chain.levels[i - 1];
+            const MipChain::Level& dst = chain.levels[i];
+            unsigned char* out = chain.data.data() + dst.offset;
+            downsample(chain.data.data() + src.offset, src.width, src.height, components, options, out);
+            if (coverage)
+                scaleAlphaToCoverage(out, dst.width, dst.height, components, alpha, options.alphaCutoff, targetCoverage);
+        }
+    }
+
+    // ========================================================================
+    // 缩小一半：dst 为 max(1, width / 2) x max(1, height / 2)（奇数尺寸时舍弃最后一行/列）
+    // ========================================================================
+    static void downsample(const unsigned char* src, int width, int height, int components,
+                           const MipOptions& options, unsigned char* dst)
+    {
+        if (options.filter == MIP_FILTER_BOX && (!options.srgb || components < 3))
+            downsampleBox(src, width, height, components, dst);
+        else
+            downsampleFloat(src, width, height, components, options, dst);
+    }
+
+    // 当前使用的指令集（基准测试输出用）
+    static const char* simdName()
+    {
+#if defined(MIP_SIMD_AVX2)
+        if (hasAvx2())
+            return "AVX2";
+#endif
+#if defined(MIP_SIMD_SSE2)
+        return "SSE2";
+#elif defined(MIP_SIMD_NEON)
+        return "NEON";
+#else
+        return "scalar";
+#endif
+    }
+
+private:
+    static const int ROWS_PER_TASK = 16;      // 每个并行任务处理的输出行数
+
+    static int alphaChannel(int components) { return components == 4 ? 3 : (components == 2 ? 1 : -1); }
+
+    static void forEachRowBand(int rows, const std::function<void(int, int)>& fn)
+    {
+        size_t bands = size_t((rows + ROWS_PER_TASK - 1) / ROWS_PER_TASK);
+        ThreadPool::Instance().parallelFor(bands, [&](size_t band) {
+            int begin = int(band) * ROWS_PER_TASK;
+            fn(begin, std::min(rows, begin + ROWS_PER_TASK));
+        });
+    }
+
+    // ========================================================================
+    // 盒式滤波（整数）
+    // ========================================================================
+    static void downsampleBox(const unsigned char* src, int width, int height, int components, unsigned char* dst)
+    {
+        int newWidth = std::max(1, width / 2), newHeight = std::max(1, height / 2);
+        size_t srcPitch = size_t(width) * components, dstPitch = size_t(newWidth) * components;
+        bool simd = components == 4 && width >= 2;
+        forEachRowBand(newHeight, [&](int begin, int end) {
+            for (int y = begin; y < end; y++)
+            {
+                const unsigned char* row0 = src + size_t(std::min(y * 2, height - 1)) * srcPitch;
+                const unsigned char* row1 = src + size_t(std::min(y * 2 + 1, height - 1)) * srcPitch;
+                unsigned char* out = dst + size_t(y) * dstPitch;
+                int x = simd ? boxRowRGBA8(row0, row1, out, newWidth) : 0;
+                for (; x < newWidth; x++)
+                {
+                    int x0 = std::min(x * 2, width - 1) * components, x1 = std::min(x * 2 + 1, width - 1) * components;
+                    for (int c = 0; c < components; c++)
+                        out[x * components + c] = static_cast<unsigned char>(
+                            (row0[x0 + c] + row0[x1 + c] + row1[x0 + c] + row1[x1 + c] + 2) >> 2);
+                }
+            }
+        });
+    }
+
+    // 一行 RGBA8 的 SIMD 盒式滤波，返回已经处理的输出像素数（剩下的由标量代码处理）
+    static int boxRowRGBA8(const unsigned char* row0, const unsigned char* row1, unsigned char* out, int outWidth)
+    {
+        int x = 0;
+#if defined(MIP_SIMD_AVX2)
+        if (hasAvx2())
+            x = boxRowRGBA8Avx2(row0, row1, out, outWidth);
+#endif
+#if defined(MIP_SIMD_SSE2)
+        // 每次读取每行 8 个源像素，输出 4 个像素
+        const __m128i zero = _mm_setzero_si128(), two = _mm_set1_epi16(2);
+        auto pair = [&](const unsigned char* a, const unsigned char* b) {
+            __m128i r0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a));
+            __m128i r1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b));
+            __m128i lo = _mm_add_epi16(_mm_unpacklo_epi8(r0, zero), _mm_unpacklo_epi8(r1, zero));   // 像素 0、1
+            __m128i hi = _mm_add_epi16(_mm_unpackhi_epi8(r0, zero), _mm_unpackhi_epi8(r1, zero));   // 像素 2、3
+            __m128i sum = _mm_add_epi16(_mm_unpacklo_epi64(lo, hi), _mm_unpackhi_epi64(lo, hi));
+            return _mm_srli_epi16(_mm_add_epi16(sum, two), 2);
+        };
+        for (; x + 4 <= outWidth; x += 4)
+        {
+            const unsigned char* a = row0 + x * 8;
+            const unsigned char* b = row1 + x * 8;
+            __m128i result = _mm_packus_epi16(pair(a, b), pair(a + 16, b + 16));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + x * 4), result);
+        }
+#elif defined(MIP_SIMD_NEON)
+        // 每次读取每行 4 个源像素，输出 2 个像素
+        for (; x + 2 <= outWidth; x += 2)
+        {
+            uint8x16_t r0 = vld1q_u8(row0 + x * 8);
+            uint8x16_t r1 = vld1q_u8(row1 + x * 8);
+            uint16x8_t lo = vaddl_u8(vget_low_u8(r0), vget_low_u8(r1));
+            uint16x8_t hi = vaddl_u8(vget_high_u8(r0), vget_high_u8(r1));
+            uint16x8_t sum = vcombine_u16(vadd_u16(vget_low_u16(lo), vget_high_u16(lo)),
+                                          vadd_u16(vget_low_u16(hi), vget_high_u16(hi)));
+            vst1_u8(out + x * 4, vrshrn_n_u16(sum, 2));
+        }
+#endif
+        return x;
+    }
+
+#if defined(MIP_SIMD_AVX2)
+    static bool hasAvx2()
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        static const bool s_avx2 = __builtin_cpu_supports("avx2");
+        return s_avx2;
+#else
+        return true;
+#endif
+    }
+
+    // 与 SSE2 版本相同，每次输出 8 个像素；unpack/pack 在每个 128 位通道内进行，最后重排 64 位块
+    MIP_TARGET_AVX2 static int boxRowRGBA8Avx2(const unsigned char* row0, const unsigned char* row1,
+                                               unsigned char* out, int outWidth)
+    {
+        const __m256i zero = _mm256_setzero_si256(), two = _mm256_set1_epi16(2);
+        int x = 0;
+        for (; x + 8 <= outWidth; x += 8)
+        {
+            __m256i halves[2];
+            for (int i = 0; i < 2; i++)
+            {
+                __m256i r0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row0 + x * 8 + i * 32));
+                __m256i r1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row1 + x * 8 + i * 32));
+                __m256i lo = _mm256_add_epi16(_mm256_unpacklo_epi8(r0, zero), _mm256_unpacklo_epi8(r1, zero));
+                __m256i hi = _mm256_add_epi16(_mm256_unpackhi_epi8(r0, zero), _mm256_unpackhi_epi8(r1, zero));
+                __m256i sum = _mm256_add_epi16(_mm256_unpacklo_epi64(lo, hi), _mm256_unpackhi_epi64(lo, hi));
+                halves[i] = _mm256_srli_epi16(_mm256_add_epi16(sum, two), 2);
+            }
+            __m256i packed = _mm256_packus_epi16(halves[0], halves[1]);
+            packed = _mm256_permute4x64_epi64(packed, _MM_SHUFFLE(3, 1, 2, 0));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + x * 4), packed);
+        }
+        return x;
+    }
+#endif
+
+    // ========================================================================
+    // 浮点滤波（sRGB 或 Kaiser）：每个像素展开为 4 个 float，用 SIMD 一次处理一个像素
+    // ========================================================================
+    struct Vec4 {
+#if defined(MIP_SIMD_SSE2)
+        __m128 v;
+        static Vec4 zero() { return { _mm_setzero_ps() }; }
+        static Vec4 load(const float* p) { return { _mm_loadu_ps(p) }; }
+        void store(float* p) const { _mm_storeu_ps(p, v); }
+        Vec4 operator+(Vec4 o) const { return { _mm_add_ps(v, o.v) }; }
+        Vec4 operator*(float s) const { return { _mm_mul_ps(v, _mm_set1_ps(s)) }; }
+        static Vec4 set(float x, float y, float z, float w) { return { _mm_setr_ps(x, y, z, w) }; }
+        // 限制到 [0, 1]，乘以 scale 后四舍五入为整数
+        void quantize(Vec4 scale, int* out) const
+        {
+            __m128 clamped = _mm_min_ps(_mm_max_ps(v, _mm_setzero_ps()), _mm_set1_ps(1.0f));
+            __m128 scaled = _mm_add_ps(_mm_mul_ps(clamped, scale.v), _mm_set1_ps(0.5f));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_cvttps_epi32(scaled));
+        }
+#elif defined(MIP_SIMD_NEON)
+        float32x4_t v;
+        static Vec4 zero() { return { vdupq_n_f32(0.0f) }; }
+        static Vec4 load(const float* p) { return { vld1q_f32(p) }; }
+        void store(float* p) const { vst1q_f32(p, v); }
+        Vec4 operator+(Vec4 o) const { return { vaddq_f32(v, o.v) }; }
+        Vec4 operator*(float s) const { return { vmulq_n_f32(v, s) }; }
+        static Vec4 set(float x, float y, float z, float w) { const float p[4] = { x, y, z, w }; return load(p); }
+        void quantize(Vec4 scale, int* out) const
+        {
+            float32x4_t clamped = vminq_f32(vmaxq_f32(v, vdupq_n_f32(0.0f)), vdupq_n_f32(1.0f));
+            vst1q_s32(out, vcvtq_s32_f32(vaddq_f32(vmulq_f32(clamped, scale.v), vdupq_n_f32(0.5f))));
+        }
+#else
+        float v[4];
+        static Vec4 zero() { return { { 0.0f, 0.0f, 0.0f, 0.0f } }; }
+        static Vec4 load(const float* p) { return { { p[0], p[1], p[2], p[3] } }; }
+        void store(float* p) const { std::memcpy(p, v, sizeof(v)); }
+        Vec4 operator+(Vec4 o) const { return { { v[0] + o.v[0], v[1] + o.v[1], v[2] + o.v[2], v[3] + o.v[3] } }; }
+        Vec4 operator*(float s) const { return { { v[0] * s, v[1] * s, v[2] * s, v[3] * s } }; }
+        static Vec4 set(float x, float y, float z, float w) { return { { x, y, z, w } }; }
+        void quantize(Vec4 scale, int* out) const
+        {
+            for (int c = 0; c < 4; c++)
+                out[c] = static_cast<int>(std::clamp(v[c], 0.0f, 1.0f) * scale.v[c] + 0.5f);
+        }
+#endif
+    };
+
+    static const int KAISER_TAPS = 8;
+
+    // 2:1 缩小的 Kaiser 权重：源像素相对输出像素中心的偏移为 -3.5 ... 3.5
+    static const float* kaiserWeights()
+    {
+        static const std::vector<float> s_weights = [] {
+            const double PI = 3.14159265358979323846, ALPHA = 4.0, WIDTH = 2.0;
+            auto besselI0 = [](double x) {
+                double sum = 1.0, term = 1.0;
+                for (int k = 1; k < 20; k++)
+                {
+                    term *= (x / (2.0 * k)) * (x / (2.0 * k));
+                    sum += term;
+                }
+                return sum;
+            };
+            std::vector<float> weights(KAISER_TAPS);
+            double total = 0.0;
+            for (int i = 0; i < KAISER_TAPS; i++)
+            {
+                double u = (i - KAISER_TAPS / 2 + 0.5) / 2.0;      // 以输出像素为单位
+                double sinc = std::sin(PI * u) / (PI * u);
+                double ratio = u / WIDTH;
+                double window = besselI0(ALPHA * std::sqrt(std::max(0.0, 1.0 - ratio * ratio))) / besselI0(ALPHA);
+                weights[i] = static_cast<float>(sinc * window);
+                total += weights[i];
+            }
+            for (float& weight : weights)
+                weight = static_cast<float>(weight / total);
+            return weights;
+        }();
+        return s_weights.data();
+    }
+
+    // sRGB -> 线性（256 项）
+    static const float* srgbToLinear()
+    {
+        static const std::vector<float> s_table = [] {
+            std::vector<float> table(256);
+            for (int i = 0; i < 256; i++)
+            {
+                float c = i / 255.0f;
+                table[i] = c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+            }
+            return table;
+        }();
+        return s_table.data();
+    }
+
+    // 线性 -> sRGB（按 4096 级量化的线性值查表）
+    static const int LINEAR_STEPS = 4096;
+    static const unsigned char* linearToSrgb()
+    {
+        static const std::vector<unsigned char> s_table = [] {
+            std::vector<unsigned char> table(LINEAR_STEPS);
+            for (int i = 0; i < LINEAR_STEPS; i++)
+            {
+                float c = i / float(LINEAR_STEPS - 1);
+                float s = c <= 0.0031308f ? c * 12.92f : 1.055f * std::pow(c, 1.0f / 2.4f) - 0.055f;
+                table[i] = static_cast<unsigned char>(std::clamp(s, 0.0f, 1.0f) * 255.0f + 0.5f);
+            }
+            return table;
+        }();
+        return s_table.data();
+    }
+
+    static void downsampleFloat(const unsigned char* src, int width, int height, int components,
+                                const MipOptions& options, unsigned char* dst)
+    {
+        int newWidth = std::max(1, width / 2), newHeight = std::max(1, height / 2);
+        bool srgb = options.srgb && components >= 3;
+        const float* toLinear = srgbToLinear();
+        const unsigned char* toSrgb = linearToSrgb();
+
+        // 读取一个源像素，转换为线性空间的 float4（缺少的通道为 0）
+        float lut[4][256];
+        for (int c = 0; c < 4; c++)
+        {
+            for (int i = 0; i < 256; i++)
+                lut[c][i] = c < components ? (srgb && c < 3 ? toLinear[i] : i / 255.0f) : 0.0f;
+        }
+        auto load = [&](const unsigned char* p) {
+            if (components == 4)
+                return Vec4::set(lut[0][p[0]], lut[1][p[1]], lut[2][p[2]], lut[3][p[3]]);
+            unsigned char padded[4] = { 0, 0, 0, 0 };
+            std::memcpy(padded, p, components);
+            return Vec4::set(lut[0][padded[0]], lut[1][padded[1]], lut[2][padded[2]], lut[3][padded[3]]);
+        };
+        auto pixel = [&](int x, int y) {
+            x = std::clamp(x, 0, width - 1);
+            y = std::clamp(y, 0, height - 1);
+            return load(src + (size_t(y) * width + x) * components);
+        };
+
+        // 编码：sRGB 通道按 LINEAR_STEPS 级量化后查表，其他通道直接量化为 0～255
+        Vec4 scale = Vec4::set(srgb ? LINEAR_STEPS - 1.0f : 255.0f, srgb ? LINEAR_STEPS - 1.0f : 255.0f,
+                               srgb ? LINEAR_STEPS - 1.0f : 255.0f, 255.0f);
+        auto encode = [&](Vec4 value, unsigned char* out) {
+            int quantized[4];
+            value.quantize(scale, quantized);
+            for (int c = 0; c < components; c++)
+                out[c] = static_cast<unsigned char>(srgb && c < 3 ? toSrgb[quantized[c]] : quantized[c]);
+        };
+
+        if (options.filter == MIP_FILTER_BOX)
+        {
+            // 宽高都不小于 2 时源像素都在图片内，不需要限制坐标
+            bool interior = width >= 2 && height >= 2;
+            forEachRowBand(newHeight, [&](int begin, int end) {
+                for (int y = begin; y < end; y++)
+                {
+                    const unsigned char* row0 = src + size_t(y) * 2 * width * components;
+                    const unsigned char* row1 = row0 + size_t(width) * components;
+                    for (int x = 0; x < newWidth; x++)
+                    {
+                        size_t offset = size_t(x) * 2 * components;
+                        Vec4 sum = interior
+                            ? load(row0 + offset) + load(row0 + offset + components) +
+                              load(row1 + offset) + load(row1 + offset + components)
+                            : pixel(x * 2, y * 2) + pixel(x * 2 + 1, y * 2) +
+                              pixel(x * 2, y * 2 + 1) + pixel(x * 2 + 1, y * 2 + 1);
+                        encode(sum * 0.25f, dst + (size_t(y) * newWidth + x) * components);
+                    }
+                }
+            });
+            return;
+        }
+
+        // Kaiser：先水平缩小到 newWidth x height，再垂直缩小
+        // 宽或高为 1 的方向不缩小，直接复制；抽头超出图片时取边缘像素
+        const float* weights = kaiserWeights();
+        const int HALF = KAISER_TAPS / 2 - 1;            // 第一个抽头相对 2x 的偏移为 -HALF
+        std::vector<float> horizontal(size_t(newWidth) * height * 4);
+        forEachRowBand(height, [&](int begin, int end) {
+            for (int y = begin; y < end; y++)
+            {
+                const unsigned char* row = src + size_t(y) * width * components;
+                for (int x = 0; x < newWidth; x++)
+                {
+                    Vec4 sum = Vec4::zero();
+                    int first = x * 2 - HALF;
+                    if (width == 1)
+                        sum = load(row);
+                    else if (first >= 0 && first + KAISER_TAPS <= width)
+                    {
+                        for (int t = 0; t < KAISER_TAPS; t++)
+                            sum = sum + load(row + size_t(first + t) * components) * weights[t];
+                    }
+                    else
+                    {
+                        for (int t = 0; t < KAISER_TAPS; t++)
+                            sum = sum + pixel(first + t, y) * weights[t];
+                    }
+                    sum.store(&horizontal[(size_t(y) * newWidth + x) * 4]);
+                }
+            }
+        });
+        size_t pitch = size_t(newWidth) * 4;
+        forEachRowBand(newHeight, [&](int begin, int end) {
+            std::vector<const float*> rows(KAISER_TAPS);
+            for (int y = begin; y < end; y++)
+            {
+                for (int t = 0; t < KAISER_TAPS; t++)
+                    rows[t] = &horizontal[size_t(std::clamp(height == 1 ? 0 : y * 2 - HALF + t, 0, height - 1)) * pitch];
+                for (int x = 0; x < newWidth; x++)
+                {
+                    Vec4 sum = Vec4::zero();
+                    if (height == 1)
+                        sum = Vec4::load(rows[0] + x * 4);
+                    else
+                    {
+                        for (int t = 0; t < KAISER_TAPS; t++)
+                            sum = sum + Vec4::load(rows[t] + x * 4) * weights[t];
+                    }
+                    encode(sum, dst + (size_t(y) * newWidth + x) * components);
+                }
+            }
+        });
+    }
+
+    // ========================================================================
+    // alpha 覆盖率
+    // ========================================================================
+    // alpha * scale 超过 cutoff 的像素比例
+    static float alphaCoverage(const unsigned char* pixels, int width, int height, int components, int alpha,
+                               float cutoff, float scale)
+    {
+        size_t count = size_t(width) * height, covered = 0;
+        float threshold = cutoff * 255.0f / scale;
+        for (size_t i = 0; i < count; i++)
+            covered += pixels[i * components + alpha] > threshold;
+        return float(covered) / float(count);
+    }
+
+    // 二分查找 alpha 的缩放系数，使覆盖率接近 target
+    static void scaleAlphaToCoverage(unsigned char* pixels, int width, int height, int components, int alpha,
+                                     float cutoff, float target)
+    {
+        float low = 0.0f, high = 4.0f, scale = 1.0f;
+        for (int i = 0; i < 12; i++)
+        {
+            scale = 0.5f * (low + high);
+            float coverage = alphaCoverage(pixels, width, height, components, alpha, cutoff, scale);
+            if (coverage < target)
+                low = scale;
+            else
+                high = scale;
+        }
+        if (std::fabs(scale - 1.0f) < 1.0f / 256.0f)
+            return;
+        for (size_t i = 0; i < size_t(width) * height; i++)
+        {
+            unsigned char& a = pixels[i * components + alpha];
+            a = static_cast<unsigned char>(std::min(255.0f, a * scale + 0.5f));
+        }
+    }
+};
@@ -10,64 +10,64 @@
 #include <glad/glad.h>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
 #include <stb_image.h>
 #include <assimp/Importer.hpp>
 #include <assimp/scene.h>
 #include <assimp/postprocess.h>
 
+#include "compressed_texture.h"
+#include "geometry_arena.h"
 #include "mesh.h"
+#include "mesh_optimizer.h"
+#include "model_cache.h"
 #include "shader.h"
+#include "texture_array.h"
+#include "texture_cache.h"
+#include "texture_loader.h"
+#include "texture_residency.h"
+#include "texture_streamer.h"
+#include "thread_pool.h"
 
+#include <chrono>
 #include <string>
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include <algorithm>
 #include <map>
+#include <tuple>
+#include <unordered_map>
 #include <vector>
+#include <cstdlib>
 #include <cstring>  // for strcmp
 
 // ============================================================================
-// 辅助函数：从文件加载纹理
+// glMultiDrawElementsIndirect 的命令（布局由 OpenGL 规范规定）
 // ============================================================================
-static unsigned int TextureFromFile(const char *path, const std::string &directory, bool gamma = false)
-{
-    std::string filename = std::string(path);
-    filename = directory + '/' + filename;
-
-    unsigned int textureID;
-    glGenTextures(1, &textureID);
+struct DrawElementsIndirectCommand {
+    GLuint count;             // 索引数
+    GLuint instanceCount;     // 实例数
+    GLuint firstIndex;        // 第一个索引在索引缓冲区中的位置（以索引为单位）
+    GLint  baseVertex;        // 加到每个索引上的值
+    GLuint baseInstance;      // 第一个实例的编号
+};
 
-    int width, height, nrComponents;
-    unsigned char *data = stbi_load(filename.c_str(), &width, &height, &nrComponents, 0);
-    if (data)
-    {
-        GLenum format;
-        if (nrComponents == 1)
-            format = GL_RED;
-        else if (nrComponents == 3)
-            format = GL_RGB;
-        else if (nrComponents == 4)
-            format = GL_RGBA;
-
-        glBindTexture(GL_TEXTURE_2D, textureID);
-        glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-        glGenerateMipmap(GL_TEXTURE_2D);
-
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-        stbi_image_free(data);
-    }
-    else
-    {
-        std::cout << "Texture failed to load at path: " << path << std::endl;
-        stbi_image_free(data);
-    }
+// ============================================================================
+// 网格实例：模型中引用某个网格的一个节点
+// ============================================================================
+struct MeshInstance {
+    unsigned int mesh;        // 在 Model::meshes 中的编号
+    glm::mat4 transform;      // 节点相对模型根节点的变换
+};
 
-    return textureID;
-}
+// 实例矩阵的顶点属性位置（mat4 占 8～11 四个位置）
+#define INSTANCE_MATRIX_LOCATION 8
+// 纹理数组的层号（vec4：漫反射、镜面反射、法线、高度贴图），只在使用纹理数组时设置
+#define INSTANCE_LAYERS_LOCATION 12
+// 压缩顶点格式的反量化参数（vec3 比例、vec3 偏移），只在 vertexFormat 不是 FLOAT 时设置
+#define INSTANCE_POSITION_SCALE_LOCATION 13
+#define INSTANCE_POSITION_OFFSET_LOCATION 14
 
 // ============================================================================
 // Model 类
@@ -76,41 +76,480 @@ class Model
 {
 public:
     // 模型数据
-    std::vector<Texture> textures_loaded;  // 存储所有已加载的纹理，优化以确保纹理不会加载多次
-    std::vector<Mesh>    meshes;           // 所有网格
+    std::vector<Texture> textures_loaded;  // 这个模型用到的所有纹理（每个文件一个），确保纹理不会加载多次
+    std::vector<Mesh>    meshes;           // 所有网格（每个 aiMesh 只有一份）
+    std::vector<MeshInstance> instances;   // 所有网格实例（每个引用网格的节点一个）
     std::string directory;                 // 模型文件所在目录
     bool gammaCorrection;                  // 是否进行伽马校正
+    VertexFormat vertexFormat;             // 网格在显存中的顶点格式（见 vertex_format.h）
+    VertexCacheStats cacheStatsBefore;     // 所有网格优化前的顶点缓存统计（见 mesh_optimizer.h）
+    VertexCacheStats cacheStatsAfter;      // 优化后的统计
 
     // ========================================================================
     // 构造函数，期望一个 3D 模型文件的路径
     // ========================================================================
-    Model(std::string const &path, bool gamma = false) : gammaCorrection(gamma)
+    // format 为压缩格式时，绘制用的着色器必须定义 PACKED_VERTEX 和 MODEL_INSTANCES：
+    // 每个网格的反量化参数作为实例属性传入，量化范围不同的网格也能合并到一次绘制中
+    // （没有定义 MODEL_INSTANCES 时 Draw 报错，见 checkPackedShader）
+    // textureArrays 为 true 时材质纹理按尺寸和格式打包成纹理数组（见 texture_array.h），
+    // 材质不同的网格也能合并到一次绘制中；绘制用的着色器需要定义 MODEL_TEXTURE_ARRAYS
+    // （设置环境变量 OPENGL_TEXTURE_ARRAYS=0 时不打包，见 usesTextureArrays）
+    // ========================================================================
+    Model(std::string const &path, bool gamma = false, VertexFormat format = VERTEX_FORMAT_FLOAT,
+          bool textureArrays = false)
+        : gammaCorrection(gamma), vertexFormat(format), m_textureArrays(textureArrays && textureArraysEnabled())
     {
         loadModel(path);
     }
 
+    // 纹理可能与其他模型共用（见 texture_cache.h），只释放引用；纹理数组属于这个模型，直接删除
+    // 网格的顶点/索引（m_arena）和实例、间接绘制缓冲区只属于这个模型，也一起删除
+    ~Model()
+    {
+        for (const Texture& texture : textures_loaded)
+        {
+            if (texture.layer < 0)
+                TextureCache::Instance().release(texture.id);
+        }
+        m_texturePacker.release();
+
+        unsigned int buffers[] = { m_indirectBuffer, m_instanceBuffer, m_layerBuffer, m_dequantizeBuffer };
+        for (unsigned int buffer : buffers)
+        {
+            if (buffer)
+                glDeleteBuffers(1, &buffer);
+        }
+        m_arena.release();
+    }
+
     // ========================================================================
     // 绘制模型，从而绘制其所有网格
     // ========================================================================
+    // 所有网格的顶点和索引都在 m_arena 中。被多个节点引用的网格只存一份，
+    // 用实例化绘制，每个实例的节点变换作为实例属性（着色器中为 aInstanceMatrix）
+    // 加载时把 VAO、索引类型和材质都相同的网格合并成一批（见 buildBatches），
+    // 每批只设置一次材质，用一次 glMultiDrawElementsIndirect 绘制；
+    // 不支持 GL 4.3 时退回逐个网格绘制
+    // 设置环境变量 OPENGL_MODEL_BATCHING=0 关闭批处理，逐个网格绘制（用于对比）
+    // ========================================================================
     void Draw(Shader &shader)
     {
-        for(unsigned int i = 0; i < meshes.size(); i++)
-            meshes[i].Draw(shader);
+        // 异步加载纹理时，上传这段时间解码完成的纹理
+        if (m_textureLoader.pending())
+            m_textureLoader.poll();
+
+        // 报告纹理被使用和需要的清晰度（见 texture_residency.h）
+        for (const Texture& texture : textures_loaded)
+            TextureResidency::Instance().touch(texture.id, m_screenSize);
+
+        if (vertexFormat != VERTEX_FORMAT_FLOAT && m_checkedSerial != shader.serial())
+            checkPackedShader(shader);
+
+        unsigned int boundVao = 0;
+        if (m_indirectBuffer)
+            glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_indirectBuffer);
+        for (const DrawBatch& batch : m_batches)
+        {
+            bindVertexArray(batch.vao, boundVao);
+            meshes[batch.mesh].BindMaterial(shader);
+            if (m_indirectBuffer)
+            {
+                glMultiDrawElementsIndirect(GL_TRIANGLES, batch.indexType,
+                                            (void*)(batch.firstCommand * sizeof(DrawElementsIndirectCommand)),
+                                            batch.commandCount, 0);
+                continue;
+            }
+            for (GLsizei c = 0; c < batch.commandCount; c++)
+                drawCommand(batch, m_commands[batch.firstCommand + c]);
+        }
+        if (m_indirectBuffer)
+            glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+        glBindVertexArray(0);
+
+        // 配置完成后，将一切设置回默认值是一个好习惯
+        glActiveTexture(GL_TEXTURE0);
     }
+
+    // ========================================================================
+    // 根据变换估计模型在屏幕上的大小（像素），之后的 Draw 按它报告纹理需要的 mip 级别
+    // ========================================================================
+    // 用包围球投影后的直径近似；不调用时（或摄像机在包围球内）纹理需要最清晰的级别
+    // ========================================================================
+    void SetScreenSize(const glm::mat4& model, const glm::mat4& view, const glm::mat4& projection, int viewportHeight)
+    {
+        glm::vec4 center = view * model * glm::vec4(m_boundsCenter, 1.0f);
+        float scale = std::max(glm::length(glm::vec3(model[0])),
+                               std::max(glm::length(glm::vec3(model[1])), glm::length(glm::vec3(model[2]))));
+        float radius = m_boundsRadius * scale;
+        float distance = -center.z;
+        if (distance <= radius)
+            m_screenSize = 0.0f;
+        else
+            m_screenSize = radius * projection[1][1] / distance * viewportHeight;
+    }
+
+    // 材质纹理是否打包成了纹理数组（着色器需要定义 MODEL_TEXTURE_ARRAYS）
+    bool usesTextureArrays() const { return m_textureArrays; }
+
+    // 批数（= 开启批处理时每次 Draw 的绘制调用次数）
+    size_t batchCount() const { return m_batches.size(); }
+
+    // 还在解码的纹理数（只有设置 OPENGL_ASYNC_TEXTURES=1 时构造完成后才可能不为 0）
+    size_t pendingTextures() const { return m_textureLoader.pending(); }
     
 private:
+    // 一批可以用一次 MultiDraw 绘制的网格
+    struct DrawBatch {
+        unsigned int vao;
+        GLenum indexType;
+        unsigned int indexSize;
+        unsigned int mesh;              // 提供材质的网格（批内所有网格的材质相同）
+        unsigned int firstCommand;      // 在 m_commands 中的位置
+        GLsizei commandCount;
+    };
+
+    // 从 aiMesh 转换得到的顶点和索引（在工作线程中生成）
+    struct MeshSource {
+        std::vector<Vertex> vertices;
+        std::vector<unsigned int> indices;
+        VertexCacheStats statsBefore;           // 优化前后的顶点缓存统计
+        VertexCacheStats statsAfter;
+    };
+
+    GeometryArena m_arena;                    // 所有网格共用的顶点/索引缓冲区
+    TextureLoader m_textureLoader;            // 材质纹理在工作线程中解码
+    std::unordered_map<std::string, size_t> m_textureIndex;   // 材质中的路径 -> 在 textures_loaded 中的位置
+    std::vector<DrawBatch> m_batches;
+    std::vector<DrawElementsIndirectCommand> m_commands;   // 按批排列，每个网格一条
+    unsigned int m_indirectBuffer = 0;        // m_commands 的 GPU 副本（开启批处理且支持 MultiDraw 时）
+    unsigned int m_instanceBuffer = 0;        // 实例矩阵，按 m_commands 的顺序排列
+    unsigned int m_layerBuffer = 0;           // 每个实例的纹理数组层号（与 m_instanceBuffer 顺序相同）
+    unsigned int m_dequantizeBuffer = 0;      // 每个实例的反量化比例和偏移（与 m_instanceBuffer 顺序相同）
+    bool m_textureArrays = false;             // 材质纹理打包成纹理数组
+    TextureArrayPacker m_texturePacker;       // 打包的纹理（与 textures_loaded 的顺序相同）
+    glm::vec3 m_boundsCenter = glm::vec3(0.0f);   // 模型空间的包围球
+    float m_boundsRadius = 0.0f;
+    float m_screenSize = 0.0f;                // 屏幕上的大小（像素），0 表示未知，见 SetScreenSize
+    unsigned int m_checkedSerial = 0;         // 检查过的着色器程序序号（见 checkPackedShader）
+
+    // 设置环境变量 OPENGL_ASYNC_TEXTURES=1 时，构造函数不等纹理解码完成就返回，
+    // 纹理先显示为占位颜色，之后在 Draw 中陆续上传
+    static bool asyncTexturesEnabled()
+    {
+        const char* value = std::getenv("OPENGL_ASYNC_TEXTURES");
+        return value && std::strcmp(value, "0") != 0;
+    }
+
+    static bool textureArraysEnabled()
+    {
+        const char* value = std::getenv("OPENGL_TEXTURE_ARRAYS");
+        return !value || std::strcmp(value, "0") != 0;
+    }
+
+    static bool batchingEnabled()
+    {
+        static const bool s_enabled = [] {
+            const char* value = std::getenv("OPENGL_MODEL_BATCHING");
+            return !value || std::strcmp(value, "0") != 0;
+        }();
+        return s_enabled;
+    }
+
+    static void bindVertexArray(unsigned int vao, unsigned int& bound)
+    {
+        if (vao != bound)
+        {
+            glBindVertexArray(vao);
+            bound = vao;
+        }
+    }
+
+    // 压缩格式的反量化参数只通过实例属性传入（一批中各网格的量化范围不同），
+    // 着色器没有定义 MODEL_INSTANCES 时会按某一个网格的范围解码所有网格，这里报错
+    void checkPackedShader(const Shader& shader)
+    {
+        m_checkedSerial = shader.serial();
+        if (glGetAttribLocation(shader.ID, "aPositionScale") != INSTANCE_POSITION_SCALE_LOCATION)
+            std::cout << "ERROR::MODEL:: shaders drawing a packed-vertex Model must define MODEL_INSTANCES" << std::endl;
+    }
+
+    // 不用 MultiDraw 时绘制一条命令
+    void drawCommand(const DrawBatch& batch, const DrawElementsIndirectCommand& command)
+    {
+        const void* indices = (void*)(size_t(command.firstIndex) * batch.indexSize);
+        if (GLAD_GL_VERSION_4_2)
+        {
+            glDrawElementsInstancedBaseVertexBaseInstance(GL_TRIANGLES, command.count, batch.indexType, indices,
+                                                          command.instanceCount, command.baseVertex,
+                                                          command.baseInstance);
+            return;
+        }
+        // GL 3.3 没有 baseInstance：把实例属性指针移到这个网格的第一个实例上
+        setupInstanceAttributes(command.baseInstance);
+        glDrawElementsInstancedBaseVertex(GL_TRIANGLES, command.count, batch.indexType, indices,
+                                          command.instanceCount, command.baseVertex);
+    }
+
+    // 为当前绑定的 VAO 设置实例矩阵属性（每个实例前进一次），从 firstInstance 开始读取
+    void setupInstanceAttributes(GLuint firstInstance)
+    {
+        glBindBuffer(GL_ARRAY_BUFFER, m_instanceBuffer);
+        size_t base = size_t(firstInstance) * sizeof(glm::mat4);
+        for (unsigned int column = 0; column < 4; column++)
+        {
+            GLuint location = INSTANCE_MATRIX_LOCATION + column;
+            glEnableVertexAttribArray(location);
+            glVertexAttribPointer(location, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4),
+                                  (void*)(base + column * sizeof(glm::vec4)));
+            glVertexAttribDivisor(location, 1);
+        }
+        if (m_layerBuffer)
+        {
+            glBindBuffer(GL_ARRAY_BUFFER, m_layerBuffer);
+            glEnableVertexAttribArray(INSTANCE_LAYERS_LOCATION);
+            glVertexAttribPointer(INSTANCE_LAYERS_LOCATION, 4, GL_FLOAT, GL_FALSE, sizeof(glm::vec4),
+                                  (void*)(size_t(firstInstance) * sizeof(glm::vec4)));
+            glVertexAttribDivisor(INSTANCE_LAYERS_LOCATION, 1);
+        }
+        if (m_dequantizeBuffer)
+        {
+            glBindBuffer(GL_ARRAY_BUFFER, m_dequantizeBuffer);
+            size_t offset = size_t(firstInstance) * 2 * sizeof(glm::vec3);
+            for (GLuint i = 0; i < 2; i++)
+            {
+                GLuint location = INSTANCE_POSITION_SCALE_LOCATION + i;
+                glEnableVertexAttribArray(location);
+                glVertexAttribPointer(location, 3, GL_FLOAT, GL_FALSE, 2 * sizeof(glm::vec3),
+                                      (void*)(offset + i * sizeof(glm::vec3)));
+                glVertexAttribDivisor(location, 1);
+            }
+        }
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+
+    // 网格每种纹理（漫反射、镜面反射、法线、高度贴图）第一个纹理在纹理数组中的层
+    static glm::vec4 textureLayers(const Mesh& mesh)
+    {
+        static const char* const TYPES[4] = { "texture_diffuse", "texture_specular", "texture_normal", "texture_height" };
+        glm::vec4 layers(0.0f);
+        for (int type = 0; type < 4; type++)
+        {
+            for (const Texture& texture : mesh.textures)
+            {
+                if (texture.type == TYPES[type])
+                {
+                    layers[type] = static_cast<float>(std::max(texture.layer, 0));
+                    break;
+                }
+            }
+        }
+        return layers;
+    }
+
+    // ========================================================================
+    // 把 loadTexture 记录的纹理打包成纹理数组，并替换所有网格中的纹理
+    // ========================================================================
+    void packTextures()
+    {
+        m_texturePacker.build();
+        for (size_t i = 0; i < textures_loaded.size(); i++)
+        {
+            TextureArrayPacker::Layer layer = m_texturePacker.layer(i);
+            textures_loaded[i].id = layer.texture;
+            textures_loaded[i].layer = std::max(layer.layer, 0);
+        }
+        for (Mesh& mesh : meshes)
+        {
+            for (Texture& texture : mesh.textures)
+            {
+                const Texture& packed = textures_loaded[m_textureIndex[texture.path]];
+                texture.id = packed.id;
+                texture.layer = packed.layer;
+            }
+        }
+    }
+
+    // ========================================================================
+    // 所有网格实例的包围球（包住各实例变换后的包围盒）
+    // ========================================================================
+    void computeBounds()
+    {
+        glm::vec3 minimum(0.0f), maximum(0.0f);
+        bool first = true;
+        for (const MeshInstance& instance : instances)
+        {
+            const Mesh& mesh = meshes[instance.mesh];
+            for (int corner = 0; corner < 8; corner++)
+            {
+                glm::vec3 local((corner & 1) ? mesh.boundsMax().x : mesh.boundsMin().x,
+                                (corner & 2) ? mesh.boundsMax().y : mesh.boundsMin().y,
+                                (corner & 4) ? mesh.boundsMax().z : mesh.boundsMin().z);
+                glm::vec3 point = glm::vec3(instance.transform * glm::vec4(local, 1.0f));
+                minimum = first ? point : glm::min(minimum, point);
+                maximum = first ? point : glm::max(maximum, point);
+                first = false;
+            }
+        }
+        m_boundsCenter = (minimum + maximum) * 0.5f;
+        m_boundsRadius = glm::length(maximum - minimum) * 0.5f;
+    }
+
+    // ========================================================================
+    // 排序网格并生成绘制批次、间接绘制命令和实例缓冲区（加载完成后调用一次）
+    // ========================================================================
+    void buildBatches()
+    {
+        // 每个网格的实例
+        std::vector<std::vector<glm::mat4>> transforms(meshes.size());
+        for (const MeshInstance& instance : instances)
+            transforms[instance.mesh].push_back(instance.transform);
+
+        // VAO、索引类型相同的网格排在一起，其中相同材质的再排在一起（按第一个纹理区分）
+        std::vector<unsigned int> drawOrder;
+        for (unsigned int i = 0; i < meshes.size(); i++)
+        {
+            if (meshes[i].indexCount() && !transforms[i].empty())
+                drawOrder.push_back(i);
+        }
+        auto sortKey = [this](unsigned int i) {
+            const Mesh& mesh = meshes[i];
+            unsigned int texture = mesh.textures.empty() ? 0 : mesh.textures[0].id;
+            return std::make_tuple(mesh.VAO, mesh.indexType(), texture);
+        };
+        std::stable_sort(drawOrder.begin(), drawOrder.end(),
+                         [&](unsigned int a, unsigned int b) { return sortKey(a) < sortKey(b); });
+
+        m_batches.clear();
+        m_commands.clear();
+        std::vector<glm::mat4> instanceMatrices;
+        std::vector<glm::vec4> instanceLayers;
+        std::vector<glm::vec3> instanceDequantize;     // 每个实例两项：比例、偏移
+        bool packed = vertexFormat != VERTEX_FORMAT_FLOAT;
+        for (unsigned int i : drawOrder)
+        {
+            const Mesh& mesh = meshes[i];
+            const GeometryRange& range = mesh.geometryRange();
+
+            bool merge = false;
+            if (!m_batches.empty())
+            {
+                const DrawBatch& last = m_batches.back();
+                merge = batchingEnabled() && last.vao == mesh.VAO && last.indexType == mesh.indexType() &&
+                        meshes[last.mesh].SameMaterial(mesh);
+            }
+            if (!merge)
+            {
+                DrawBatch batch;
+                batch.vao = mesh.VAO;
+                batch.indexType = mesh.indexType();
+                batch.indexSize = mesh.indexSize();
+                batch.mesh = i;
+                batch.firstCommand = static_cast<unsigned int>(m_commands.size());
+                batch.commandCount = 0;
+                m_batches.push_back(batch);
+            }
+
+            DrawElementsIndirectCommand command;
+            command.count = static_cast<GLuint>(mesh.indexCount());
+            command.instanceCount = static_cast<GLuint>(transforms[i].size());
+            command.firstIndex = static_cast<GLuint>(range.indexOffset / mesh.indexSize());
+            command.baseVertex = range.baseVertex;
+            command.baseInstance = static_cast<GLuint>(instanceMatrices.size());
+            m_commands.push_back(command);
+            m_batches.back().commandCount++;
+            instanceMatrices.insert(instanceMatrices.end(), transforms[i].begin(), transforms[i].end());
+            if (m_textureArrays)
+                instanceLayers.insert(instanceLayers.end(), transforms[i].size(), textureLayers(mesh));
+            for (size_t instance = 0; packed && instance < transforms[i].size(); instance++)
+            {
+                instanceDequantize.push_back(mesh.packedLayout().positionScale);
+                instanceDequantize.push_back(mesh.packedLayout().positionOffset);
+            }
+        }
+        if (m_commands.empty())
+            return;
+
+        // 实例缓冲区，并加入到每个 VAO 中
+        glGenBuffers(1, &m_instanceBuffer);
+        glBindBuffer(GL_ARRAY_BUFFER, m_instanceBuffer);
+        glBufferData(GL_ARRAY_BUFFER, instanceMatrices.size() * sizeof(glm::mat4), instanceMatrices.data(), GL_STATIC_DRAW);
+        if (m_textureArrays)
+        {
+            glGenBuffers(1, &m_layerBuffer);
+            glBindBuffer(GL_ARRAY_BUFFER, m_layerBuffer);
+            glBufferData(GL_ARRAY_BUFFER, instanceLayers.size() * sizeof(glm::vec4), instanceLayers.data(), GL_STATIC_DRAW);
+        }
+        if (packed)
+        {
+            glGenBuffers(1, &m_dequantizeBuffer);
+            glBindBuffer(GL_ARRAY_BUFFER, m_dequantizeBuffer);
+            glBufferData(GL_ARRAY_BUFFER, instanceDequantize.size() * sizeof(glm::vec3), instanceDequantize.data(),
+                         GL_STATIC_DRAW);
+        }
+        unsigned int boundVao = 0;
+        for (const DrawBatch& batch : m_batches)
+        {
+            if (batch.vao != boundVao)
+            {
+                bindVertexArray(batch.vao, boundVao);
+                setupInstanceAttributes(0);
+            }
+        }
+        glBindVertexArray(0);
+
+        // glMultiDrawElementsIndirect 是 GL 4.3 的功能
+        if (batchingEnabled() && GLAD_GL_VERSION_4_3)
+        {
+            glGenBuffers(1, &m_indirectBuffer);
+            glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_indirectBuffer);
+            glBufferData(GL_DRAW_INDIRECT_BUFFER, m_commands.size() * sizeof(DrawElementsIndirectCommand),
+                         m_commands.data(), GL_STATIC_DRAW);
+            glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+        }
+    }
+
+    // Assimp 的后处理选项（也是模型缓存键的一部分）
+    static const unsigned int IMPORT_FLAGS =
+        aiProcess_Triangulate |            // 三角化
+        aiProcess_GenSmoothNormals |       // 生成平滑法线
+        aiProcess_FlipUVs |                // 翻转 UV（OpenGL 需要）
+        aiProcess_CalcTangentSpace;        // 计算切线空间
+
     // ========================================================================
     // 从文件加载模型，支持 ASSIMP 扩展名，并将生成的网格存储在 meshes 向量中
     // ========================================================================
+    // 先查找烘焙的模型缓存（见 model_cache.h），命中时跳过 Assimp；
+    // 没有命中时用 Assimp 导入，再写入缓存。两种路径都打印加载时间
+    // ========================================================================
     void loadModel(std::string const &path)
     {
+        auto start = std::chrono::steady_clock::now();
+
+        // 检索文件路径的目录路径
+        directory = path.substr(0, path.find_last_of('/'));
+
+        // 缓存的数据与顶点格式和是否优化有关
+        uint64_t cacheKey = 0;
+        if (ModelCache::isEnabled())
+        {
+            uint32_t options = uint32_t(vertexFormat) | (optimizeEnabled() ? 0x100u : 0u);
+            cacheKey = ModelCache::makeKey(path, IMPORT_FLAGS, options);
+        }
+        if (cacheKey && loadCooked(cacheKey))
+        {
+            if (m_textureArrays)
+                packTextures();
+            buildBatches();
+            computeBounds();
+            if (!asyncTexturesEnabled())
+                m_textureLoader.finish();
+            std::cout << "Model: loaded " << path << " from cache in " << elapsedMs(start) << " ms" << std::endl;
+            return;
+        }
+
         // 通过 ASSIMP 读取文件
         Assimp::Importer importer;
-        const aiScene* scene = importer.ReadFile(path, 
-            aiProcess_Triangulate |           // 三角化
-            aiProcess_GenSmoothNormals |     // 生成平滑法线
-            aiProcess_FlipUVs |                // 翻转 UV（OpenGL 需要）
-            aiProcess_CalcTangentSpace);       // 计算切线空间
+        const aiScene* scene = importer.ReadFile(path, IMPORT_FLAGS);
         
         // 检查错误
         if(!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode)
@@ -118,49 +557,257 @@ private:
             std::cout << "ERROR::ASSIMP:: " << importer.GetErrorString() << std::endl;
             return;
         }
-        
-        // 检索文件路径的目录路径
-        directory = path.substr(0, path.find_last_of('/'));
 
-        // 递归处理 ASSIMP 的根节点
-        processNode(scene->mRootNode, scene);
+        // 1. 递归处理 ASSIMP 的根节点，记录用到的网格和实例
+        std::map<unsigned int, unsigned int> meshCache;
+        processNode(scene->mRootNode, scene, glm::mat4(1.0f), meshCache);
+        std::vector<unsigned int> sceneMeshes(meshCache.size());
+        for (const auto& entry : meshCache)
+            sceneMeshes[entry.second] = entry.first;
+
+        // 2. 网格数据的转换（复制顶点、展开索引、优化）与 OpenGL 无关，分给工作线程并行执行
+        ThreadPool& pool = ThreadPool::Instance();
+        std::vector<MeshSource> sources(sceneMeshes.size());
+        pool.parallelFor(sources.size(), [&](size_t i) {
+            sources[i] = convertMesh(scene->mMeshes[sceneMeshes[i]]);
+        });
+
+        // 3. 加载纹理和上传需要 OpenGL 上下文，在当前线程按顺序进行
+        for (size_t i = 0; i < sources.size(); i++)
+        {
+            cacheStatsBefore += sources[i].statsBefore;
+            cacheStatsAfter += sources[i].statsAfter;
+            meshes.push_back(processMesh(sources[i], scene->mMeshes[sceneMeshes[i]], scene));
+        }
+
+        // 打包纹理数组并生成绘制批次
+        if (m_textureArrays)
+            packTextures();
+        buildBatches();
+        computeBounds();
+
+        // 纹理在上面的过程中已经开始解码，等待剩下的完成
+        if (!asyncTexturesEnabled())
+            m_textureLoader.finish();
+
+        std::cout << "Model: imported " << path << " with Assimp in " << elapsedMs(start) << " ms ("
+                  << sceneMeshes.size() << " meshes, " << pool.size() + 1 << " threads)" << std::endl;
+        if (optimizeEnabled())
+        {
+            std::cout << "Model: vertex cache ACMR " << cacheStatsBefore.acmr() << " -> " << cacheStatsAfter.acmr()
+                      << ", ATVR " << cacheStatsBefore.atvr() << " -> " << cacheStatsAfter.atvr() << std::endl;
+        }
+
+        if (cacheKey)
+            storeCooked(cacheKey);
+    }
+
+    static double elapsedMs(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // ========================================================================
+    // 从模型缓存加载：顶点和索引直接从映射的文件上传，不经过中间数组
+    // ========================================================================
+    bool loadCooked(uint64_t key)
+    {
+        MappedFile file;
+        const CookedModelHeader* header = ModelCache::open(key, file);
+        if (!header)
+            return false;
+
+        const unsigned char* base = file.data();
+        const CookedMesh* cookedMeshes = reinterpret_cast<const CookedMesh*>(base + header->meshTable);
+        const CookedInstance* cookedInstances = reinterpret_cast<const CookedInstance*>(base + header->instanceTable);
+        const CookedTexture* cookedTextures = reinterpret_cast<const CookedTexture*>(base + header->textureTable);
+
+        for (uint32_t i = 0; i < header->meshCount; i++)
+        {
+            const CookedMesh& cooked = cookedMeshes[i];
+
+            MeshData data;
+            data.format = static_cast<VertexFormat>(cooked.format);
+            data.layout.quantized = cooked.quantized != 0;
+            data.layout.hasBones = cooked.hasBones != 0;
+            data.layout.wideBoneIds = cooked.wideBoneIds != 0;
+            data.layout.stride = static_cast<GLsizei>(cooked.stride);
+            data.layout.normalOffset = cooked.normalOffset;
+            data.layout.texCoordsOffset = cooked.texCoordsOffset;
+            data.layout.tangentOffset = cooked.tangentOffset;
+            data.layout.boneIdsOffset = cooked.boneIdsOffset;
+            data.layout.weightsOffset = cooked.weightsOffset;
+            data.layout.positionScale = glm::make_vec3(cooked.positionScale);
+            data.layout.positionOffset = glm::make_vec3(cooked.positionOffset);
+            data.vertices = base + cooked.vertexOffset;
+            data.vertexCount = cooked.vertexCount;
+            data.vertexBytes = cooked.vertexBytes;
+            data.indices = base + cooked.indexOffset;
+            data.indexCount = cooked.indexCount;
+            data.indexBytes = cooked.indexBytes;
+            data.indexType = cooked.indexType;
+
+            std::vector<Texture> textures;
+            for (uint32_t t = 0; t < cooked.textureCount; t++)
+            {
+                const CookedTexture& texture = cookedTextures[cooked.firstTexture + t];
+                textures.push_back(loadTexture(texture.path, texture.type));
+            }
+            meshes.push_back(Mesh(data, textures, &m_arena));
+        }
+
+        for (uint32_t i = 0; i < header->instanceCount; i++)
+        {
+            if (cookedInstances[i].mesh >= meshes.size())
+                continue;
+            MeshInstance instance;
+            instance.mesh = cookedInstances[i].mesh;
+            instance.transform = glm::make_mat4(cookedInstances[i].transform);
+            instances.push_back(instance);
+        }
+        return true;
+    }
+
+    // ========================================================================
+    // 把导入的结果写入模型缓存
+    // ========================================================================
+    void storeCooked(uint64_t key) const
+    {
+        std::vector<CookedMesh> cookedMeshes;
+        std::vector<CookedTexture> cookedTextures;
+        for (const Mesh& mesh : meshes)
+        {
+            CookedMesh cooked = {};
+            cooked.vertexCount = static_cast<uint32_t>(mesh.vertexCount());
+            cooked.indexCount = static_cast<uint32_t>(mesh.indexCount());
+            cooked.indexType = mesh.indexType();
+            cooked.format = mesh.vertexFormat();
+            const PackedVertexLayout& layout = mesh.packedLayout();
+            cooked.quantized = layout.quantized;
+            cooked.hasBones = layout.hasBones;
+            cooked.wideBoneIds = layout.wideBoneIds;
+            cooked.stride = static_cast<uint32_t>(layout.stride);
+            cooked.normalOffset = layout.normalOffset;
+            cooked.texCoordsOffset = layout.texCoordsOffset;
+            cooked.tangentOffset = layout.tangentOffset;
+            cooked.boneIdsOffset = layout.boneIdsOffset;
+            cooked.weightsOffset = layout.weightsOffset;
+            std::memcpy(cooked.positionScale, glm::value_ptr(layout.positionScale), sizeof(cooked.positionScale));
+            std::memcpy(cooked.positionOffset, glm::value_ptr(layout.positionOffset), sizeof(cooked.positionOffset));
+
+            cooked.firstTexture = static_cast<uint32_t>(cookedTextures.size());
+            cooked.textureCount = static_cast<uint32_t>(mesh.textures.size());
+            for (const Texture& texture : mesh.textures)
+            {
+                CookedTexture cookedTexture = {};
+                // 放不下的路径不缓存（下次仍然用 Assimp 导入）
+                if (texture.type.size() >= sizeof(cookedTexture.type) || texture.path.size() >= sizeof(cookedTexture.path))
+                    return;
+                std::memcpy(cookedTexture.type, texture.type.data(), texture.type.size());
+                std::memcpy(cookedTexture.path, texture.path.data(), texture.path.size());
+                cookedTextures.push_back(cookedTexture);
+            }
+            cookedMeshes.push_back(cooked);
+        }
+
+        std::vector<CookedInstance> cookedInstances;
+        for (const MeshInstance& instance : instances)
+        {
+            CookedInstance cooked = {};
+            cooked.mesh = instance.mesh;
+            std::memcpy(cooked.transform, glm::value_ptr(instance.transform), sizeof(cooked.transform));
+            cookedInstances.push_back(cooked);
+        }
+
+        // 表在前，顶点/索引数据在后；网格表最后回填数据的偏移
+        std::vector<unsigned char> data = ModelCache::begin(key);
+        uint64_t meshTable = ModelCache::append(data, cookedMeshes.data(), cookedMeshes.size() * sizeof(CookedMesh));
+        uint64_t instanceTable = ModelCache::append(data, cookedInstances.data(), cookedInstances.size() * sizeof(CookedInstance));
+        uint64_t textureTable = ModelCache::append(data, cookedTextures.data(), cookedTextures.size() * sizeof(CookedTexture));
+        for (size_t i = 0; i < meshes.size(); i++)
+        {
+            CookedMesh& cooked = cookedMeshes[i];
+            if (cooked.vertexCount && cooked.indexCount)
+            {
+                std::vector<unsigned char> vertexData = meshes[i].gpuVertexData();
+                std::vector<unsigned char> indexData = meshes[i].gpuIndexData();
+                cooked.vertexBytes = vertexData.size();
+                cooked.vertexOffset = ModelCache::append(data, vertexData.data(), vertexData.size());
+                cooked.indexBytes = indexData.size();
+                cooked.indexOffset = ModelCache::append(data, indexData.data(), indexData.size());
+            }
+        }
+        if (!cookedMeshes.empty())
+            std::memcpy(data.data() + meshTable, cookedMeshes.data(), cookedMeshes.size() * sizeof(CookedMesh));
+
+        CookedModelHeader* header = reinterpret_cast<CookedModelHeader*>(data.data());
+        header->meshCount = static_cast<uint32_t>(cookedMeshes.size());
+        header->instanceCount = static_cast<uint32_t>(cookedInstances.size());
+        header->textureCount = static_cast<uint32_t>(cookedTextures.size());
+        header->meshTable = meshTable;
+        header->instanceTable = instanceTable;
+        header->textureTable = textureTable;
+        ModelCache::store(key, data);
     }
 
     // ========================================================================
     // 以递归方式处理节点。处理位于节点的每个单独网格，并对其子节点（如果有）重复此过程
     // ========================================================================
-    void processNode(aiNode *node, const aiScene *scene)
+    // parentTransform 为父节点相对根节点的变换；meshCache 记录用到的
+    // aiMesh（场景中的编号 -> meshes 中的编号），同一个网格被多个节点引用时
+    // 只处理、上传一次，每个节点只增加一个实例
+    // 这里只确定编号，网格在 processNode 之后统一处理（见 loadModel）
+    // ========================================================================
+    void processNode(aiNode *node, const aiScene *scene, const glm::mat4 &parentTransform,
+                     std::map<unsigned int, unsigned int> &meshCache)
     {
+        glm::mat4 transform = parentTransform * toGlm(node->mTransformation);
+
         // 处理位于当前节点的每个网格
         for(unsigned int i = 0; i < node->mNumMeshes; i++)
         {
             // 节点对象只包含索引来索引场景中的实际对象
             // 场景包含所有数据，节点只是用来保持组织（如节点之间的关系）
-            aiMesh* mesh = scene->mMeshes[node->mMeshes[i]];
-            meshes.push_back(processMesh(mesh, scene));
+            unsigned int sceneMesh = node->mMeshes[i];
+            auto cached = meshCache.find(sceneMesh);
+            if (cached == meshCache.end())
+                cached = meshCache.emplace(sceneMesh, static_cast<unsigned int>(meshCache.size())).first;
+
+            MeshInstance instance;
+            instance.mesh = cached->second;
+            instance.transform = transform;
+            instances.push_back(instance);
         }
         
         // 处理完所有网格（如果有）后，我们递归处理每个子节点
         for(unsigned int i = 0; i < node->mNumChildren; i++)
         {
-            processNode(node->mChildren[i], scene);
+            processNode(node->mChildren[i], scene, transform, meshCache);
         }
     }
 
+    // Assimp 的矩阵按行存储，glm 按列存储
+    static glm::mat4 toGlm(const aiMatrix4x4 &matrix)
+    {
+        return glm::transpose(glm::make_mat4(&matrix.a1));
+    }
+
     // ========================================================================
-    // 处理网格
+    // 转换网格的顶点和索引（在工作线程中执行，不能调用 OpenGL，也不能修改 Model）
     // ========================================================================
-    Mesh processMesh(aiMesh *mesh, const aiScene *scene)
+    static MeshSource convertMesh(const aiMesh *mesh)
     {
-        // 要填充的数据
-        std::vector<Vertex> vertices;
-        std::vector<unsigned int> indices;
-        std::vector<Texture> textures;
+        // 要填充的数据（预先分配好，避免 push_back 反复扩容）
+        MeshSource source;
+        std::vector<Vertex>& vertices = source.vertices;
+        std::vector<unsigned int>& indices = source.indices;
+        vertices.reserve(mesh->mNumVertices);
+        indices.reserve(size_t(mesh->mNumFaces) * 3);
 
         // 遍历网格的每个顶点
         for(unsigned int i = 0; i < mesh->mNumVertices; i++)
         {
-            Vertex vertex;
+            Vertex vertex = {};   // 清零：没有骨骼的顶点权重为 0，压缩格式据此省略骨骼数据
             glm::vec3 vector; // 我们声明一个占位符向量，因为 assimp 使用自己的向量类，不能直接转换为 glm 的 vec3 类，所以我们先将数据传输到这个占位符 glm::vec3
             
             // 位置
@@ -209,12 +856,25 @@ private:
         // 现在遍历网格的每个面（面是网格的三角形）并检索相应的顶点索引
         for(unsigned int i = 0; i < mesh->mNumFaces; i++)
         {
-            aiFace face = mesh->mFaces[i];
+            const aiFace& face = mesh->mFaces[i];
             // 检索面的所有索引并将它们存储在索引向量中
             for(unsigned int j = 0; j < face.mNumIndices; j++)
                 indices.push_back(face.mIndices[j]);        
         }
         
+        // 重排三角形和顶点，提高顶点缓存命中率、减少过度绘制
+        if (optimizeEnabled())
+            optimizeMesh(source);
+        return source;
+    }
+
+    // ========================================================================
+    // 处理网格：加载材质的纹理并上传（需要 OpenGL 上下文）
+    // ========================================================================
+    Mesh processMesh(MeshSource &source, const aiMesh *mesh, const aiScene *scene)
+    {
+        std::vector<Texture> textures;
+
         // 处理材质
         aiMaterial* material = scene->mMaterials[mesh->mMaterialIndex];    
         // 我们假设着色器中采样器名称的约定。每个漫反射纹理应该命名为
@@ -241,7 +901,32 @@ private:
         textures.insert(textures.end(), heightMaps.begin(), heightMaps.end());
         
         // 返回从提取的网格数据创建的网格对象
-        return Mesh(vertices, indices, textures);
+        return Mesh(std::move(source.vertices), std::move(source.indices), textures, vertexFormat, &m_arena);
+    }
+
+    // ========================================================================
+    // 导入时的网格优化（设置环境变量 OPENGL_MESH_OPTIMIZE=0 可以关闭，用于对比）
+    // ========================================================================
+    static bool optimizeEnabled()
+    {
+        const char* value = std::getenv("OPENGL_MESH_OPTIMIZE");
+        return !value || std::strcmp(value, "0") != 0;
+    }
+
+    static void optimizeMesh(MeshSource& source)
+    {
+        std::vector<Vertex>& vertices = source.vertices;
+        std::vector<unsigned int>& indices = source.indices;
+        if (vertices.empty() || indices.empty())
+            return;
+
+        source.statsBefore = MeshOptimizer::analyzeVertexCache(indices, vertices.size());
+
+        MeshOptimizer::optimizeVertexCache(indices, vertices.size());
+        MeshOptimizer::optimizeOverdraw(indices, &vertices[0].Position, sizeof(Vertex));
+        MeshOptimizer::optimizeVertexFetch(vertices, indices);
+
+        source.statsAfter = MeshOptimizer::analyzeVertexCache(indices, vertices.size());
     }
 
     // ========================================================================
@@ -255,29 +940,54 @@ private:
         {
             aiString str;
             mat->GetTexture(type, i, &str);
-            
-            // 检查纹理是否之前已加载，如果是，继续下一次迭代：跳过加载新纹理
-            bool skip = false;
-            for(unsigned int j = 0; j < textures_loaded.size(); j++)
-            {
-                if(std::strcmp(textures_loaded[j].path.data(), str.C_Str()) == 0)
-                {
-                    textures.push_back(textures_loaded[j]);
-                    skip = true; // 已加载具有相同文件路径的纹理，继续下一个（优化）
-                    break;
-                }
-            }
-            if(!skip)
-            {   // 如果纹理尚未加载，则加载它
-                Texture texture;
-                texture.id = TextureFromFile(str.C_Str(), this->directory);
-                texture.type = typeName;
-                texture.path = str.C_Str();
-                textures.push_back(texture);
-                textures_loaded.push_back(texture);  // 将其存储为整个模型已加载的纹理，以确保我们不会不必要地加载重复的纹理
-            }
+            textures.push_back(loadTexture(str.C_Str(), typeName));
         }
         return textures;
     }
+
+    // ========================================================================
+    // 加载一个纹理（path 相对模型目录），已经加载过的直接返回
+    // ========================================================================
+    // 先查这个模型自己用过的纹理，再查进程内的 TextureCache（其他模型可能已经加载过）
+    // ========================================================================
+    Texture loadTexture(const char *path, const std::string &typeName)
+    {
+        auto loaded = m_textureIndex.find(path);
+        if (loaded != m_textureIndex.end())
+            return textures_loaded[loaded->second]; // 已加载具有相同文件路径的纹理（优化）
+
+        // 伽马校正时漫反射贴图是 sRGB 颜色，其他贴图存的是数据
+        bool srgb = gammaCorrection && typeName == "texture_diffuse";
+        bool normalMap = typeName == "texture_normal";
+        unsigned int flags = (stbi_get_flip_vertically_on_load() ? TEXTURE_FLAG_FLIP : 0) | (srgb ? TEXTURE_FLAG_SRGB : 0) |
+                             (normalMap ? TEXTURE_FLAG_NORMAL_MAP : 0);
+        std::string filename = this->directory + '/' + path;
+
+        Texture texture;
+        texture.type = typeName;
+        texture.path = path;
+        if (m_textureArrays)
+        {
+            // 只记录文件，加载完所有网格后由 packTextures 一起解码、打包
+            m_texturePacker.add(filename, flags);
+            texture.id = 0;
+            texture.layer = 0;
+        }
+        else
+            texture.id = TextureCache::Instance().acquire(filename, flags);
+        if (!texture.id && !m_textureArrays)
+        {
+            // 如果纹理尚未加载，则加载它：交给工作线程解码，解码完成前显示占位颜色
+            // （法线贴图用指向 +Z 的平坦法线，其他用灰色）
+            static const unsigned char FLAT_NORMAL[4] = { 128, 128, 255, 255 };
+            static const unsigned char GREY[4] = { 128, 128, 128, 255 };
+            texture.id = m_textureLoader.request(filename, normalMap ? FLAT_NORMAL : GREY, flags);
+            TextureCache::Instance().insert(filename, flags, texture.id);
+        }
+
+        m_textureIndex[path] = textures_loaded.size();
+        textures_loaded.push_back(texture);  // 将其存储为整个模型已加载的纹理，以确保我们不会不必要地加载重复的纹理
+        return texture;
+    }
 };
 
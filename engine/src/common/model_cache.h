@@ -0,0 +1,342 @@
+// ============================================================================
+// ModelCache - 烘焙的二进制模型缓存
+// ============================================================================
+// 每次启动都要用 Assimp 解析 OBJ，再做三角化、生成法线和切线、网格优化，
+// 大模型要花几百毫秒到几秒。第一次导入后把处理好的结果写成二进制文件：
+//   文件头 | 网格表 | 实例表 | 纹理表 | 顶点/索引数据
+// 顶点和索引数据已经是显存中的格式（压缩后的顶点、缩窄后的索引），
+// 按 16 字节对齐；下次启动时把文件 mmap 到内存，直接传给 glBufferSubData，
+// 不需要解析，也不需要复制到中间数组（见 Model::loadCooked）
+//
+// 缓存键 = 源文件内容 + Assimp 导入参数 + 顶点格式等选项的哈希，
+// 模型文件或导入设置变化都会换一个文件；文件头中的版本号不匹配时忽略缓存
+// 注意：只对主模型文件计算哈希，只修改 .mtl 或纹理文件时需要手动清空缓存
+//
+// 缓存目录：环境变量 OPENGL_MODEL_CACHE_DIR，默认 PROJECT_ROOT/.cache/models
+// 设置 OPENGL_MODEL_CACHE=0 可以关闭缓存
+// ============================================================================
+
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "vertex_format.h"   // Vertex、VertexFormat（检查网格表用）
+
+// ============================================================================
+// 文件格式（所有偏移都是相对文件开头的字节数）
+// ============================================================================
+struct CookedModelHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t key;
+    uint64_t fileSize;           // 用来发现被截断的文件
+    uint32_t meshCount;
+    uint32_t instanceCount;
+    uint32_t textureCount;
+    uint32_t reserved;
+    uint64_t meshTable;          // CookedMesh[meshCount]
+    uint64_t instanceTable;      // CookedInstance[instanceCount]
+    uint64_t textureTable;       // CookedTexture[textureCount]
+};
+
+struct CookedMesh {
+    uint64_t vertexOffset;       // 顶点数据（显存格式）
+    uint64_t vertexBytes;
+    uint64_t indexOffset;        // 索引数据（indexType 类型）
+    uint64_t indexBytes;
+    uint32_t vertexCount;
+    uint32_t indexCount;
+    uint32_t indexType;          // GL_UNSIGNED_BYTE/SHORT/INT
+    uint32_t format;             // VertexFormat
+    uint32_t firstTexture;       // 在纹理表中的位置
+    uint32_t textureCount;
+    // PackedVertexLayout（format 不是 FLOAT 时有效）
+    uint32_t quantized;
+    uint32_t hasBones;
+    uint32_t wideBoneIds;
+    uint32_t stride;
+    uint32_t normalOffset;
+    uint32_t texCoordsOffset;
+    uint32_t tangentOffset;
+    uint32_t boneIdsOffset;
+    uint32_t weightsOffset;
+    float    positionScale[3];
+    float    positionOffset[3];
+};
+
+struct CookedInstance {
+    uint32_t mesh;
+    uint32_t reserved[3];
+    float    transform[16];      // 列主序，与 glm::mat4 相同
+};
+
+struct CookedTexture {
+    char type[32];               // "texture_diffuse" 等
+    char path[224];              // 相对模型目录的路径（与材质中的相同）
+};
+
+// ============================================================================
+// MappedFile - 只读映射整个文件
+// ============================================================================
+// 支持 mmap 的平台上映射文件（数据按需从页缓存读入，不复制），
+// 否则退回一次读入内存
+// ============================================================================
+class MappedFile
+{
+public:
+    MappedFile() : m_data(nullptr), m_size(0), m_mapped(false) {}
+    ~MappedFile() { close(); }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const std::string& path)
+    {
+        close();
+#if defined(__unix__) || defined(__APPLE__)
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0)
+            return false;
+        struct stat info;
+        if (fstat(fd, &info) != 0 || info.st_size <= 0)
+        {
+            ::close(fd);
+            return false;
+        }
+        void* data = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);   // 映射建立后文件描述符就不需要了
+        if (data == MAP_FAILED)
+            return false;
+        m_data = static_cast<const unsigned char*>(data);
+        m_size = static_cast<size_t>(info.st_size);
+        m_mapped = true;
+        return true;
+#else
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        if (!file)
+            return false;
+        m_buffer.resize(static_cast<size_t>(file.tellg()));
+        file.seekg(0);
+        if (m_buffer.empty() || !file.read(reinterpret_cast<char*>(m_buffer.data()), m_buffer.size()))
+        {
+            m_buffer.clear();
+            return false;
+        }
+        m_data = m_buffer.data();
+        m_size = m_buffer.size();
+        return true;
+#endif
+    }
+
+    void close()
+    {
+#if defined(__unix__) || defined(__APPLE__)
+        if (m_mapped)
+            munmap(const_cast<unsigned char*>(m_data), m_size);
+#endif
+        m_buffer.clear();
+        m_data = nullptr;
+        m_size = 0;
+        m_mapped = false;
+    }
+
+    const unsigned char* data() const { return m_data; }
+    size_t size() const { return m_size; }
+
+private:
+    const unsigned char* m_data;
+    size_t m_size;
+    bool m_mapped;                       // true: m_data 来自 mmap
+    std::vector<unsigned char> m_buffer; // 不支持 mmap 时的文件内容
+};
+
+// ============================================================================
+// ModelCache
+// ============================================================================
+class ModelCache
+{
+public:
+    static bool isEnabled()
+    {
+        const char* value = std::getenv("OPENGL_MODEL_CACHE");
+        return !value || std::strcmp(value, "0") != 0;
+    }
+
+    // ========================================================================
+    // 计算缓存键（源文件内容 + 导入选项），源文件读取失败时返回 0
+    // ========================================================================
+    static uint64_t makeKey(const std::string& sourcePath, uint32_t importFlags, uint32_t options)
+    {
+        std::ifstream file(sourcePath, std::ios::binary);
+        if (!file)
+            return 0;
+
+        uint64_t hash = 14695981039346656037ull;
+        std::vector<char> buffer(1 << 16);
+        while (file)
+        {
+            file.read(buffer.data(), buffer.size());
+            hash = hashBytes(hash, buffer.data(), static_cast<size_t>(file.gcount()));
+        }
+        const uint32_t settings[] = { VERSION, importFlags, options };
+        hash = hashBytes(hash, reinterpret_cast<const char*>(settings), sizeof(settings));
+        return hash ? hash : 1;
+    }
+
+    // ========================================================================
+    // 映射缓存文件并检查文件头，成功返回文件头（指向映射的内存）
+    // ========================================================================
+    static const CookedModelHeader* open(uint64_t key, MappedFile& file)
+    {
+        if (!file.open(pathFor(key)) || file.size() < sizeof(CookedModelHeader))
+            return nullptr;
+
+        const CookedModelHeader* header = reinterpret_cast<const CookedModelHeader*>(file.data());
+        if (header->magic != MAGIC || header->version != VERSION || header->key != key ||
+            header->fileSize != file.size() ||
+            !inside(file, header->meshTable, uint64_t(header->meshCount) * sizeof(CookedMesh)) ||
+            !inside(file, header->instanceTable, uint64_t(header->instanceCount) * sizeof(CookedInstance)) ||
+            !inside(file, header->textureTable, uint64_t(header->textureCount) * sizeof(CookedTexture)))
+        {
+            file.close();
+            return nullptr;
+        }
+
+        const CookedMesh* meshes = reinterpret_cast<const CookedMesh*>(file.data() + header->meshTable);
+        for (uint32_t i = 0; i < header->meshCount; i++)
+        {
+            const CookedMesh& mesh = meshes[i];
+            if (!inside(file, mesh.vertexOffset, mesh.vertexBytes) || !inside(file, mesh.indexOffset, mesh.indexBytes) ||
+                uint64_t(mesh.firstTexture) + mesh.textureCount > header->textureCount || !validMesh(mesh))
+            {
+                file.close();
+                return nullptr;
+            }
+        }
+        return header;
+    }
+
+    // ========================================================================
+    // 写缓存文件用的辅助函数
+    // ========================================================================
+    // 新建文件内容，返回的数组开头为已填好 magic/version/key 的文件头
+    static std::vector<unsigned char> begin(uint64_t key)
+    {
+        CookedModelHeader header = {};
+        header.magic = MAGIC;
+        header.version = VERSION;
+        header.key = key;
+        std::vector<unsigned char> data(sizeof(header));
+        std::memcpy(data.data(), &header, sizeof(header));
+        return data;
+    }
+
+    // 按 ALIGNMENT 对齐追加一块数据，返回它的偏移
+    static uint64_t append(std::vector<unsigned char>& data, const void* bytes, size_t size)
+    {
+        data.resize((data.size() + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT);
+        uint64_t offset = data.size();
+        data.resize(data.size() + size);
+        if (size)
+            std::memcpy(data.data() + offset, bytes, size);
+        return offset;
+    }
+
+    // 填写 fileSize 并保存
+    static void store(uint64_t key, std::vector<unsigned char>& data)
+    {
+        reinterpret_cast<CookedModelHeader*>(data.data())->fileSize = data.size();
+
+        std::error_code error;
+        std::filesystem::create_directories(directory(), error);
+
+        // 先写临时文件再重命名，避免并行运行的进程读到写了一半的文件
+        std::string path = pathFor(key);
+        std::string tempPath = path + ".tmp";
+        {
+            std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+            if (!file)
+                return;
+            file.write(reinterpret_cast<const char*>(data.data()), data.size());
+            if (!file)
+                return;
+        }
+        std::filesystem::rename(tempPath, path, error);
+    }
+
+    // 删除所有缓存文件（基准测试冷启动用）
+    static void clear()
+    {
+        std::error_code error;
+        std::filesystem::remove_all(directory(), error);
+    }
+
+    static std::string directory()
+    {
+        if (const char* dir = std::getenv("OPENGL_MODEL_CACHE_DIR"))
+            return dir;
+        return std::string(PROJECT_ROOT) + "/.cache/models";
+    }
+
+private:
+    static const uint32_t MAGIC = 0x434D4C47;   // "GLMC"
+    static const uint32_t VERSION = 1;
+    static const size_t ALIGNMENT = 16;
+
+    static bool inside(const MappedFile& file, uint64_t offset, uint64_t size)
+    {
+        return offset <= file.size() && size <= file.size() - offset;
+    }
+
+    // 网格的格式和数据大小是否一致：文件头正确但内容过期或损坏时，Mesh 会在
+    // GeometryArena 中分配错误的大小，绘制时读到网格范围之外；拒绝这样的文件，加载退回 Assimp
+    static bool validMesh(const CookedMesh& mesh)
+    {
+        if (mesh.format > VERTEX_FORMAT_QUANTIZED)
+            return false;
+        uint64_t stride = mesh.format == VERTEX_FORMAT_FLOAT ? sizeof(Vertex) : mesh.stride;
+        if (stride == 0 || mesh.vertexBytes != uint64_t(mesh.vertexCount) * stride)
+            return false;
+
+        uint64_t indexSize;
+        switch (mesh.indexType)
+        {
+        case GL_UNSIGNED_BYTE:  indexSize = 1; break;
+        case GL_UNSIGNED_SHORT: indexSize = 2; break;
+        case GL_UNSIGNED_INT:   indexSize = 4; break;
+        default:                return false;
+        }
+        return mesh.indexBytes == uint64_t(mesh.indexCount) * indexSize;
+    }
+
+    static uint64_t hashBytes(uint64_t hash, const char* data, size_t size)
+    {
+        for (size_t i = 0; i < size; i++)
+        {
+            hash ^= static_cast<uint8_t>(data[i]);
+            hash *= 1099511628211ull;
+        }
+        return hash;
+    }
+
+    static std::string pathFor(uint64_t key)
+    {
+        char name[32];
+        std::snprintf(name, sizeof(name), "%016llx.model", static_cast<unsigned long long>(key));
+        return directory() + "/" + name;
+    }
+};
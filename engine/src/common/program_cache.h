@@ -0,0 +1,202 @@
+// ============================================================================
+// ProgramCache - 着色器程序二进制缓存
+// ============================================================================
+// 每次启动都要重新编译、链接所有着色器，着色器多了以后启动会很慢。
+// 链接成功后用 glGetProgramBinary 取出驱动编译好的程序二进制保存到磁盘，
+// 下次启动时用 glProgramBinary 直接加载，跳过编译和链接
+//
+// 缓存键 = 所有阶段源码 + 驱动的 VENDOR/RENDERER/VERSION 字符串的哈希，
+// 源码或驱动变化都会换一个文件；驱动拒绝二进制（链接状态失败）时
+// 自动退回正常编译，并覆盖旧的缓存文件
+//
+// 缓存目录：环境变量 OPENGL_SHADER_CACHE_DIR，默认 PROJECT_ROOT/.cache/shaders
+// 设置 OPENGL_SHADER_CACHE=0 可以关闭缓存
+// ============================================================================
+
+#pragma once
+
+#include <glad/glad.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// ============================================================================
+// 缓存统计（基准测试报告冷/热启动用）
+// ============================================================================
+struct ProgramCacheStats {
+    unsigned int hits = 0;       // 从缓存加载成功的程序数
+    unsigned int misses = 0;     // 需要编译的程序数
+    double buildMs = 0.0;        // 创建程序（加载或编译）的累计时间（毫秒）
+};
+
+class ProgramCache
+{
+public:
+    // ========================================================================
+    // 是否可用：需要驱动支持至少一种程序二进制格式（GL 4.1 / ARB_get_program_binary）
+    // ========================================================================
+    static bool isAvailable()
+    {
+        if (!enabledByEnv() || !glad_glProgramBinary || !glad_glGetProgramBinary)
+            return false;
+        GLint formats = 0;
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+        return formats > 0;
+    }
+
+    // ========================================================================
+    // 计算缓存键（源码 + 驱动信息）
+    // ========================================================================
+    static uint64_t makeKey(const std::vector<std::string>& sources)
+    {
+        uint64_t hash = 14695981039346656037ull;
+        for (const std::string& source : sources)
+        {
+            hash = hashBytes(hash, source.data(), source.size());
+            hash = hashBytes(hash, "\0", 1);   // 分隔不同阶段
+        }
+        const GLenum driverStrings[] = { GL_VENDOR, GL_RENDERER, GL_VERSION };
+        for (GLenum name : driverStrings)
+        {
+            const char* value = reinterpret_cast<const char*>(glGetString(name));
+            if (value)
+                hash = hashBytes(hash, value, std::strlen(value));
+        }
+        return hash;
+    }
+
+    // ========================================================================
+    // 尝试从缓存加载程序二进制，成功返回 true（程序已处于链接成功状态）
+    // ========================================================================
+    static bool load(uint64_t key, GLuint program)
+    {
+        std::ifstream file(pathFor(key), std::ios::binary);
+        if (!file)
+            return false;
+
+        FileHeader header;
+        if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+            header.magic != MAGIC || header.version != VERSION || header.key != key)
+            return false;
+
+        // 长度必须等于文件剩余的字节数：文件损坏时不能按读到的长度分配内存（最大 4GB）
+        std::streamoff headerEnd = file.tellg();
+        file.seekg(0, std::ios::end);
+        std::streamoff remaining = file.tellg() - headerEnd;
+        if (header.length == 0 || remaining != std::streamoff(header.length))
+            return false;
+        file.seekg(headerEnd);
+
+        std::vector<char> binary(header.length);
+        if (!file.read(binary.data(), binary.size()))
+            return false;
+
+        glProgramBinary(program, header.format, binary.data(), static_cast<GLsizei>(binary.size()));
+        GLint success = 0;
+        glGetProgramiv(program, GL_LINK_STATUS, &success);
+        return success != 0;
+    }
+
+    // ========================================================================
+    // 保存已链接程序的二进制（链接前需要设置 GL_PROGRAM_BINARY_RETRIEVABLE_HINT）
+    // ========================================================================
+    static void store(uint64_t key, GLuint program)
+    {
+        GLint length = 0;
+        glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+        if (length <= 0)
+            return;
+
+        std::vector<char> binary(length);
+        GLenum format = 0;
+        GLsizei written = 0;
+        glGetProgramBinary(program, length, &written, &format, binary.data());
+        if (written <= 0)
+            return;
+
+        std::error_code error;
+        std::filesystem::create_directories(directory(), error);
+
+        // 先写临时文件再重命名，避免并行运行的进程读到写了一半的文件
+        std::string path = pathFor(key);
+        std::string tempPath = path + ".tmp";
+        {
+            std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+            if (!file)
+                return;
+            FileHeader header;
+            header.key = key;
+            header.format = format;
+            header.length = static_cast<uint32_t>(written);
+            file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            file.write(binary.data(), written);
+            if (!file)
+                return;
+        }
+        std::filesystem::rename(tempPath, path, error);
+    }
+
+    // ========================================================================
+    // 统计
+    // ========================================================================
+    static ProgramCacheStats& stats()
+    {
+        static ProgramCacheStats s_stats;
+        return s_stats;
+    }
+
+    // 删除所有缓存文件（基准测试冷启动用）
+    static void clear()
+    {
+        std::error_code error;
+        std::filesystem::remove_all(directory(), error);
+    }
+
+    static std::string directory()
+    {
+        if (const char* dir = std::getenv("OPENGL_SHADER_CACHE_DIR"))
+            return dir;
+        return std::string(PROJECT_ROOT) + "/.cache/shaders";
+    }
+
+private:
+    static const uint32_t MAGIC = 0x42504C47;   // "GLPB"
+    static const uint32_t VERSION = 1;
+
+    struct FileHeader {
+        uint32_t magic = MAGIC;
+        uint32_t version = VERSION;
+        uint64_t key = 0;
+        uint32_t format = 0;
+        uint32_t length = 0;
+    };
+
+    static bool enabledByEnv()
+    {
+        const char* value = std::getenv("OPENGL_SHADER_CACHE");
+        return !value || std::strcmp(value, "0") != 0;
+    }
+
+    static uint64_t hashBytes(uint64_t hash, const char* data, size_t size)
+    {
+        for (size_t i = 0; i < size; i++)
+        {
+            hash ^= static_cast<uint8_t>(data[i]);
+            hash *= 1099511628211ull;
+        }
+        return hash;
+    }
+
+    static std::string pathFor(uint64_t key)
+    {
+        char name[32];
+        std::snprintf(name, sizeof(name), "%016llx.bin", static_cast<unsigned long long>(key));
+        return directory() + "/" + name;
+    }
+};
@@ -11,17 +11,30 @@
 #include <glm/glm.hpp>
 
 #include <string>
+#include <utility>
+#include <vector>
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include <chrono>
+
+#include "uniform_cache.h"
+#include "uniform_buffer.h"
+#include "program_cache.h"
+#include "shader_preprocessor.h"
+#include "shader_watcher.h"
 
 // ============================================================================
 // Shader 类
 // ============================================================================
 // 功能：
-//   1. 从文件加载顶点着色器和片段着色器
+//   1. 从文件加载顶点着色器和片段着色器（支持 #include 和宏定义变体）
 //   2. 编译和链接着色器程序
 //   3. 提供便捷的 uniform 变量设置方法
+//   4. 链接后缓存所有 uniform 的位置，设置时不再调用 glGetUniformLocation
+//   5. 跳过值未变化的 uniform 上传（CPU 端影子副本）
+//   6. 链接结果保存到磁盘上的程序二进制缓存，下次启动直接加载
+//   7. 可选的热重载：源文件保存后自动重新编译（见 ShaderWatcher）
 // ============================================================================
 class Shader
 {
@@ -36,75 +49,25 @@ public:
     //   - fragmentPath: 片段着色器文件路径
     // 
     // 功能：
-    //   1. 读取顶点着色器和片段着色器文件
+    //   1. 读取顶点着色器和片段着色器文件（展开 #include）
     //   2. 编译两个着色器
     //   3. 链接成着色器程序
     //   4. 检查编译和链接错误
+    //   （源码和驱动都没变时直接从程序二进制缓存加载，跳过 2、3 步）
     // ========================================================================
     Shader(const char* vertexPath, const char* fragmentPath)
+        : m_vertexPath(vertexPath), m_fragmentPath(fragmentPath)
     {
-        // 1. 从文件读取顶点着色器和片段着色器源码
-        std::string vertexCode;
-        std::string fragmentCode;
-        std::ifstream vShaderFile;
-        std::ifstream fShaderFile;
-        
-        // 确保 ifstream 对象可以抛出异常
-        vShaderFile.exceptions (std::ifstream::failbit | std::ifstream::badbit);
-        fShaderFile.exceptions (std::ifstream::failbit | std::ifstream::badbit);
-        
-        try 
-        {
-            // 打开文件
-            vShaderFile.open(vertexPath);
-            fShaderFile.open(fragmentPath);
-            std::stringstream vShaderStream, fShaderStream;
-            
-            // 读取文件内容到流中
-            vShaderStream << vShaderFile.rdbuf();
-            fShaderStream << fShaderFile.rdbuf();
-            
-            // 关闭文件
-            vShaderFile.close();
-            fShaderFile.close();
-            
-            // 将流转换为字符串
-            vertexCode   = vShaderStream.str();
-            fragmentCode = fShaderStream.str();
-        }
-        catch (std::ifstream::failure& e)
-        {
-            std::cout << "ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ: " << e.what() << std::endl;
-        }
-        
-        const char* vShaderCode = vertexCode.c_str();
-        const char * fShaderCode = fragmentCode.c_str();
-        
-        // 2. 编译着色器
-        unsigned int vertex, fragment;
-        
-        // 编译顶点着色器
-        vertex = glCreateShader(GL_VERTEX_SHADER);
-        glShaderSource(vertex, 1, &vShaderCode, NULL);
-        glCompileShader(vertex);
-        checkCompileErrors(vertex, "VERTEX");
-        
-        // 编译片段着色器
-        fragment = glCreateShader(GL_FRAGMENT_SHADER);
-        glShaderSource(fragment, 1, &fShaderCode, NULL);
-        glCompileShader(fragment);
-        checkCompileErrors(fragment, "FRAGMENT");
-        
-        // 3. 创建着色器程序并链接
-        ID = glCreateProgram();
-        glAttachShader(ID, vertex);
-        glAttachShader(ID, fragment);
-        glLinkProgram(ID);
-        checkCompileErrors(ID, "PROGRAM");
+        // 1. 从文件读取顶点着色器和片段着色器源码（展开 #include）
+        std::string vertexCode, fragmentCode, geometryCode;
+        loadSources(vertexCode, fragmentCode, geometryCode);
         
-        // 4. 删除着色器对象（已经链接到程序中，不再需要）
-        glDeleteShader(vertex);
-        glDeleteShader(fragment);
+        // 2. 编译、链接（或从程序二进制缓存加载）
+        createProgram(vertexCode, fragmentCode, geometryCode);
+
+        // 3. 环境变量开启了热重载时监视源文件
+        if (ShaderWatcher::EnabledByEnv())
+            enableHotReload();
     }
 
     // ========================================================================
@@ -114,65 +77,31 @@ public:
     //   - vertexPath:   顶点着色器文件路径
     //   - fragmentPath: 片段着色器文件路径
     //   - geometryPath: 几何着色器文件路径（可选，传 nullptr 则等价于双参数构造函数）
+    //   - defines:      宏定义（可选），插入到每个阶段的 #version 之后，
+    //                   用于从同一份源码编译不同的变体，例如 { "LIGHT_POINT" }
     // ========================================================================
-    Shader(const char* vertexPath, const char* fragmentPath, const char* geometryPath)
+    Shader(const char* vertexPath, const char* fragmentPath, const char* geometryPath,
+           const ShaderDefines& defines = ShaderDefines())
+        : m_vertexPath(vertexPath), m_fragmentPath(fragmentPath)
+        , m_geometryPath(geometryPath ? geometryPath : ""), m_defines(defines)
     {
         std::string vertexCode, fragmentCode, geometryCode;
-        std::ifstream vShaderFile, fShaderFile, gShaderFile;
-        vShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-        fShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-        gShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-        try {
-            vShaderFile.open(vertexPath);
-            fShaderFile.open(fragmentPath);
-            std::stringstream vStream, fStream;
-            vStream << vShaderFile.rdbuf();
-            fStream << fShaderFile.rdbuf();
-            vShaderFile.close();
-            fShaderFile.close();
-            vertexCode = vStream.str();
-            fragmentCode = fStream.str();
-            if (geometryPath && geometryPath[0] != '\0') {
-                gShaderFile.open(geometryPath);
-                std::stringstream gStream;
-                gStream << gShaderFile.rdbuf();
-                gShaderFile.close();
-                geometryCode = gStream.str();
-            }
-        }
-        catch (std::ifstream::failure& e) {
-            std::cout << "ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ: " << e.what() << std::endl;
-        }
-        const char* vCode = vertexCode.c_str();
-        const char* fCode = fragmentCode.c_str();
-        unsigned int vertex, fragment;
-        vertex = glCreateShader(GL_VERTEX_SHADER);
-        glShaderSource(vertex, 1, &vCode, NULL);
-        glCompileShader(vertex);
-        checkCompileErrors(vertex, "VERTEX");
-        fragment = glCreateShader(GL_FRAGMENT_SHADER);
-        glShaderSource(fragment, 1, &fCode, NULL);
-        glCompileShader(fragment);
-        checkCompileErrors(fragment, "FRAGMENT");
-        ID = glCreateProgram();
-        glAttachShader(ID, vertex);
-        glAttachShader(ID, fragment);
-        unsigned int geometry = 0;
-        if (!geometryCode.empty()) {
-            const char* gCode = geometryCode.c_str();
-            geometry = glCreateShader(GL_GEOMETRY_SHADER);
-            glShaderSource(geometry, 1, &gCode, NULL);
-            glCompileShader(geometry);
-            checkCompileErrors(geometry, "GEOMETRY");
-            glAttachShader(ID, geometry);
-        }
-        glLinkProgram(ID);
-        checkCompileErrors(ID, "PROGRAM");
-        glDeleteShader(vertex);
-        glDeleteShader(fragment);
-        if (geometry) glDeleteShader(geometry);
+        loadSources(vertexCode, fragmentCode, geometryCode);
+        createProgram(vertexCode, fragmentCode, geometryCode);
+        if (ShaderWatcher::EnabledByEnv())
+            enableHotReload();
+    }
+
+    ~Shader()
+    {
+        if (m_hotReload)
+            ShaderWatcher::Instance().Unwatch(this);
     }
 
+    // 热重载按对象地址注册，不允许复制
+    Shader(const Shader&) = delete;
+    Shader& operator=(const Shader&) = delete;
+
     // ========================================================================
     // 激活着色器程序
     // ========================================================================
@@ -183,79 +112,451 @@ public:
         glUseProgram(ID); 
     }
 
+    // ========================================================================
+    // 获取 uniform 句柄
+    // ========================================================================
+    // 获取一次，之后在每帧/每个物体的循环里用句柄设置，完全跳过名字查找：
+    //   UniformHandle model = shader.getUniform("model");
+    //   shader.setMat4(model, matrix);
+    // 句柄只对当前程序有效：热重载替换程序后会失效，缓存句柄的代码需要
+    // 在 serial() 变化时重新获取（见 Mesh::BindMaterial）
+    // ========================================================================
+    UniformHandle getUniform(UniformName name) const
+    {
+        UniformHandle handle;
+        handle.location = location(name);
+        return handle;
+    }
+
     // ========================================================================
     // Uniform 变量设置函数
     // ========================================================================
     // 这些函数用于在着色器中设置 uniform 变量的值
+    // 名字可以是字符串字面量或 std::string，位置从缓存中查找
     // ========================================================================
 
     // 设置 bool 类型的 uniform 变量
-    void setBool(const std::string &name, bool value) const
+    void setBool(UniformName name, bool value) const
     {         
-        glUniform1i(glGetUniformLocation(ID, name.c_str()), (int)value); 
+        setBool(getUniform(name), value); 
     }
 
     // 设置 int 类型的 uniform 变量
-    void setInt(const std::string &name, int value) const
+    void setInt(UniformName name, int value) const
     { 
-        glUniform1i(glGetUniformLocation(ID, name.c_str()), value); 
+        setInt(getUniform(name), value); 
     }
 
     // 设置 float 类型的 uniform 变量
-    void setFloat(const std::string &name, float value) const
+    void setFloat(UniformName name, float value) const
     { 
-        glUniform1f(glGetUniformLocation(ID, name.c_str()), value); 
+        setFloat(getUniform(name), value); 
     }
 
     // 设置 vec2 类型的 uniform 变量
-    void setVec2(const std::string &name, const glm::vec2 &value) const
+    void setVec2(UniformName name, const glm::vec2 &value) const
     { 
-        glUniform2fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]); 
+        setVec2(getUniform(name), value); 
     }
-    void setVec2(const std::string &name, float x, float y) const
+    void setVec2(UniformName name, float x, float y) const
     { 
-        glUniform2f(glGetUniformLocation(ID, name.c_str()), x, y); 
+        setVec2(getUniform(name), glm::vec2(x, y)); 
     }
 
     // 设置 vec3 类型的 uniform 变量
-    void setVec3(const std::string &name, const glm::vec3 &value) const
+    void setVec3(UniformName name, const glm::vec3 &value) const
     { 
-        glUniform3fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]); 
+        setVec3(getUniform(name), value); 
     }
-    void setVec3(const std::string &name, float x, float y, float z) const
+    void setVec3(UniformName name, float x, float y, float z) const
     { 
-        glUniform3f(glGetUniformLocation(ID, name.c_str()), x, y, z); 
+        setVec3(getUniform(name), glm::vec3(x, y, z)); 
     }
 
     // 设置 vec4 类型的 uniform 变量
-    void setVec4(const std::string &name, const glm::vec4 &value) const
+    void setVec4(UniformName name, const glm::vec4 &value) const
     { 
-        glUniform4fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]); 
+        setVec4(getUniform(name), value); 
     }
-    void setVec4(const std::string &name, float x, float y, float z, float w) const
+    void setVec4(UniformName name, float x, float y, float z, float w) const
     { 
-        glUniform4f(glGetUniformLocation(ID, name.c_str()), x, y, z, w); 
+        setVec4(getUniform(name), glm::vec4(x, y, z, w)); 
     }
 
     // 设置 mat2 类型的 uniform 变量
-    void setMat2(const std::string &name, const glm::mat2 &mat) const
+    void setMat2(UniformName name, const glm::mat2 &mat) const
     {
-        glUniformMatrix2fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+        setMat2(getUniform(name), mat);
     }
 
     // 设置 mat3 类型的 uniform 变量
-    void setMat3(const std::string &name, const glm::mat3 &mat) const
+    void setMat3(UniformName name, const glm::mat3 &mat) const
     {
-        glUniformMatrix3fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+        setMat3(getUniform(name), mat);
     }
 
     // 设置 mat4 类型的 uniform 变量
-    void setMat4(const std::string &name, const glm::mat4 &mat) const
+    void setMat4(UniformName name, const glm::mat4 &mat) const
     {
-        glUniformMatrix4fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+        setMat4(getUniform(name), mat);
     }
 
+    // ========================================================================
+    // 使用句柄设置 uniform（热点循环用）
+    // ========================================================================
+    // 每个 uniform 在 CPU 端保存一份上次上传的值（影子副本），
+    // 值没有变化时跳过 glUniform* 调用，省去驱动的校验开销
+    // 注意：不要绕过 Shader 直接对这个程序调用 glUniform*，否则影子副本会过期
+    // ========================================================================
+    void setBool(UniformHandle handle, bool value) const
+    {
+        setInt(handle, (int)value);
+    }
+    void setInt(UniformHandle handle, int value) const
+    {
+        if (m_shadow.update(handle.location, &value, sizeof(value)))
+            glUniform1i(handle.location, value);
+    }
+    void setFloat(UniformHandle handle, float value) const
+    {
+        if (m_shadow.update(handle.location, &value, sizeof(value)))
+            glUniform1f(handle.location, value);
+    }
+    void setVec2(UniformHandle handle, const glm::vec2 &value) const
+    {
+        if (m_shadow.update(handle.location, &value[0], sizeof(value)))
+            glUniform2fv(handle.location, 1, &value[0]);
+    }
+    void setVec3(UniformHandle handle, const glm::vec3 &value) const
+    {
+        if (m_shadow.update(handle.location, &value[0], sizeof(value)))
+            glUniform3fv(handle.location, 1, &value[0]);
+    }
+    void setVec4(UniformHandle handle, const glm::vec4 &value) const
+    {
+        if (m_shadow.update(handle.location, &value[0], sizeof(value)))
+            glUniform4fv(handle.location, 1, &value[0]);
+    }
+    void setMat2(UniformHandle handle, const glm::mat2 &mat) const
+    {
+        if (m_shadow.update(handle.location, &mat[0][0], sizeof(mat)))
+            glUniformMatrix2fv(handle.location, 1, GL_FALSE, &mat[0][0]);
+    }
+    void setMat3(UniformHandle handle, const glm::mat3 &mat) const
+    {
+        if (m_shadow.update(handle.location, &mat[0][0], sizeof(mat)))
+            glUniformMatrix3fv(handle.location, 1, GL_FALSE, &mat[0][0]);
+    }
+    void setMat4(UniformHandle handle, const glm::mat4 &mat) const
+    {
+        if (m_shadow.update(handle.location, &mat[0][0], sizeof(mat)))
+            glUniformMatrix4fv(handle.location, 1, GL_FALSE, &mat[0][0]);
+    }
+
+    // ========================================================================
+    // 热重载
+    // ========================================================================
+    // 开启后，源文件（包括 #include 的文件）保存时会在下一帧开始前重新编译，
+    // 成功则替换 ID 并恢复之前设置过的 uniform 值，失败则继续使用旧程序
+    // 注意：新程序中 uniform 的位置可能不同，之前获取的 UniformHandle 需要重新获取
+    // ========================================================================
+    void enableHotReload()
+    {
+        m_hotReload = true;
+        ShaderWatcher::Instance().Watch(this, m_dependencies);
+    }
+
+    // 立即重新编译（ShaderWatcher 在帧边界调用），返回是否替换了程序
+    bool reload()
+    {
+        Shader fresh;
+        fresh.m_vertexPath = m_vertexPath;
+        fresh.m_fragmentPath = m_fragmentPath;
+        fresh.m_geometryPath = m_geometryPath;
+        fresh.m_defines = m_defines;
+
+        std::string vertexCode, fragmentCode, geometryCode;
+        fresh.loadSources(vertexCode, fragmentCode, geometryCode);
+
+        // 包含的文件可能变了，更新监视列表（即使这次编译失败，修好后也能再次触发）
+        m_dependencies = fresh.m_dependencies;
+        if (m_hotReload)
+            ShaderWatcher::Instance().Watch(this, m_dependencies);
+
+        fresh.createProgram(vertexCode, fragmentCode, geometryCode);
+        GLint linked = 0;
+        glGetProgramiv(fresh.ID, GL_LINK_STATUS, &linked);
+        if (!linked)
+        {
+            std::cout << "Shader hot reload failed, keeping previous program: " << m_fragmentPath << std::endl;
+            glDeleteProgram(fresh.ID);
+            return false;
+        }
+
+        // 把旧程序中设置过的 uniform 值复制到新程序（新程序的 uniform 全部是默认值）
+        GLint current = 0;
+        glGetIntegerv(GL_CURRENT_PROGRAM, &current);
+        fresh.copyUniformValues(*this);
+        glUseProgram(static_cast<GLuint>(current) == ID ? fresh.ID : static_cast<GLuint>(current));
+
+        // 替换程序
+        glDeleteProgram(ID);
+        ID = fresh.ID;
+        fresh.ID = 0;
+        std::swap(m_uniforms, fresh.m_uniforms);
+        std::swap(m_shadow, fresh.m_shadow);
+        m_serial = nextSerial();
+        std::cout << "Shader reloaded: " << m_fragmentPath << std::endl;
+        return true;
+    }
+
+    // ========================================================================
+    // 冗余 uniform 统计
+    // ========================================================================
+    // hits：值未变化而跳过的上传次数；misses：实际调用 glUniform* 的次数
+    // ========================================================================
+    const UniformStats& getUniformStats() const { return m_shadow.stats(); }
+    void resetUniformStats() { m_shadow.resetStats(); }
+
+    // ========================================================================
+    // 程序序号
+    // ========================================================================
+    // 每次成功创建（或热重载替换）程序时分配一个新的全局序号。
+    // 缓存了 uniform 位置的代码（如 Mesh）用它判断缓存是否过期；
+    // 不用 ID 判断是因为 OpenGL 会复用已删除程序的 ID
+    // ========================================================================
+    unsigned int serial() const { return m_serial; }
+
 private:
+    // ShaderLibrary 使用默认构造函数和 submitProgram/finishProgram 异步创建程序
+    friend class ShaderLibrary;
+
+    Shader() : ID(0) {}
+
+    // 源文件（热重载时重新读取）
+    std::string m_vertexPath;
+    std::string m_fragmentPath;
+    std::string m_geometryPath;            // 为空表示没有几何着色器
+    ShaderDefines m_defines;
+    std::vector<std::string> m_dependencies;   // 读取过的所有文件（包括 #include 的文件）
+    bool m_hotReload = false;
+    unsigned int m_serial = 0;             // 见 serial()
+
+    static unsigned int nextSerial()
+    {
+        static unsigned int s_counter = 0;
+        return ++s_counter;
+    }
+
+    // 按路径和宏读取并预处理所有阶段的源码，同时记录依赖文件
+    void loadSources(std::string& vertexCode, std::string& fragmentCode, std::string& geometryCode)
+    {
+        m_dependencies.clear();
+        vertexCode = ShaderPreprocessor::load(m_vertexPath, m_defines, &m_dependencies);
+        fragmentCode = ShaderPreprocessor::load(m_fragmentPath, m_defines, &m_dependencies);
+        geometryCode.clear();
+        if (!m_geometryPath.empty())
+            geometryCode = ShaderPreprocessor::load(m_geometryPath, m_defines, &m_dependencies);
+    }
+
+    // ========================================================================
+    // 按名字把另一个程序中设置过的 uniform 值上传到本程序
+    // ========================================================================
+    void copyUniformValues(const Shader& other)
+    {
+        glUseProgram(ID);
+        other.m_uniforms.forEach([&](const std::string& name, GLint otherLocation, GLenum type) {
+            size_t bytes = 0;
+            const void* data = other.m_shadow.get(otherLocation, bytes);
+            GLint newLocation = m_uniforms.find(UniformName(name));
+            if (data && newLocation >= 0 && m_shadow.update(newLocation, data, bytes))
+                uploadUniform(newLocation, type, data);
+        });
+    }
+
+    // 按 uniform 类型上传一份原始数据
+    static void uploadUniform(GLint location, GLenum type, const void* data)
+    {
+        const GLfloat* f = static_cast<const GLfloat*>(data);
+        const GLint* i = static_cast<const GLint*>(data);
+        const GLuint* u = static_cast<const GLuint*>(data);
+        switch (type)
+        {
+        case GL_FLOAT:             glUniform1fv(location, 1, f); break;
+        case GL_FLOAT_VEC2:        glUniform2fv(location, 1, f); break;
+        case GL_FLOAT_VEC3:        glUniform3fv(location, 1, f); break;
+        case GL_FLOAT_VEC4:        glUniform4fv(location, 1, f); break;
+        case GL_FLOAT_MAT2:        glUniformMatrix2fv(location, 1, GL_FALSE, f); break;
+        case GL_FLOAT_MAT3:        glUniformMatrix3fv(location, 1, GL_FALSE, f); break;
+        case GL_FLOAT_MAT4:        glUniformMatrix4fv(location, 1, GL_FALSE, f); break;
+        case GL_FLOAT_MAT2x3:      glUniformMatrix2x3fv(location, 1, GL_FALSE, f); break;
+        case GL_FLOAT_MAT2x4:      glUniformMatrix2x4fv(location, 1, GL_FALSE, f); break;
+        case GL_FLOAT_MAT3x2:      glUniformMatrix3x2fv(location, 1, GL_FALSE, f); break;
+        case GL_FLOAT_MAT3x4:      glUniformMatrix3x4fv(location, 1, GL_FALSE, f); break;
+        case GL_FLOAT_MAT4x2:      glUniformMatrix4x2fv(location, 1, GL_FALSE, f); break;
+        case GL_FLOAT_MAT4x3:      glUniformMatrix4x3fv(location, 1, GL_FALSE, f); break;
+        case GL_INT_VEC2:
+        case GL_BOOL_VEC2:         glUniform2iv(location, 1, i); break;
+        case GL_INT_VEC3:
+        case GL_BOOL_VEC3:         glUniform3iv(location, 1, i); break;
+        case GL_INT_VEC4:
+        case GL_BOOL_VEC4:         glUniform4iv(location, 1, i); break;
+        case GL_UNSIGNED_INT:      glUniform1uiv(location, 1, u); break;
+        case GL_UNSIGNED_INT_VEC2: glUniform2uiv(location, 1, u); break;
+        case GL_UNSIGNED_INT_VEC3: glUniform3uiv(location, 1, u); break;
+        case GL_UNSIGNED_INT_VEC4: glUniform4uiv(location, 1, u); break;
+        default:                   // int、bool 和各种 sampler
+            glUniform1iv(location, 1, i);
+            break;
+        }
+    }
+
+    // 已提交、还没完成的程序创建状态
+    struct PendingBuild {
+        bool pending = false;       // 是否已提交、还没调用 finishProgram
+        bool useCache = false;      // 是否使用程序二进制缓存
+        bool loaded = false;        // 是否已从缓存加载
+        uint64_t cacheKey = 0;
+        unsigned int vertex = 0;    // 着色器对象（从缓存加载时为 0）
+        unsigned int fragment = 0;
+        unsigned int geometry = 0;
+        double elapsedMs = 0.0;     // 提交阶段的耗时
+    };
+    PendingBuild m_build;
+
+    // 缓存的 uniform 位置表（链接后构建）
+    UniformCache m_uniforms;
+    // 每个 uniform 上次上传的值（set* 是 const 函数，所以声明为 mutable）
+    mutable UniformShadow m_shadow;
+
+    // 从缓存中查找 uniform 位置，找不到返回 -1
+    GLint location(const UniformName& name) const
+    {
+        return m_uniforms.find(name);
+    }
+
+    // ========================================================================
+    // 创建着色器程序（同步：提交后立即等待完成）
+    // ========================================================================
+    void createProgram(const std::string& vertexCode, const std::string& fragmentCode,
+                       const std::string& geometryCode)
+    {
+        submitProgram(vertexCode, fragmentCode, geometryCode);
+        finishProgram();
+    }
+
+    // ========================================================================
+    // 提交编译和链接（不查询任何状态）
+    // ========================================================================
+    // 先尝试从程序二进制缓存加载；缓存不存在、驱动不支持或驱动拒绝二进制时
+    // 正常编译链接。这里只提交命令、不调用 glGet*，驱动可以在后台线程编译
+    // （KHR_parallel_shader_compile），状态检查留给 finishProgram()
+    // geometryCode 为空表示没有几何着色器
+    // ========================================================================
+    void submitProgram(const std::string& vertexCode, const std::string& fragmentCode,
+                       const std::string& geometryCode)
+    {
+        auto start = std::chrono::steady_clock::now();
+
+        m_build = PendingBuild();
+        m_build.pending = true;
+        ID = glCreateProgram();
+
+        m_build.useCache = ProgramCache::isAvailable();
+        if (m_build.useCache)
+        {
+            m_build.cacheKey = ProgramCache::makeKey({ vertexCode, fragmentCode, geometryCode });
+            m_build.loaded = ProgramCache::load(m_build.cacheKey, ID);
+        }
+
+        if (!m_build.loaded)
+        {
+            // 缓存加载失败后程序对象处于未链接状态，换一个新的程序对象再编译
+            glDeleteProgram(ID);
+            ID = glCreateProgram();
+
+            m_build.vertex = compileStage(GL_VERTEX_SHADER, vertexCode);
+            m_build.fragment = compileStage(GL_FRAGMENT_SHADER, fragmentCode);
+            glAttachShader(ID, m_build.vertex);
+            glAttachShader(ID, m_build.fragment);
+            if (!geometryCode.empty())
+            {
+                m_build.geometry = compileStage(GL_GEOMETRY_SHADER, geometryCode);
+                glAttachShader(ID, m_build.geometry);
+            }
+
+            // 必须在链接前设置，否则驱动可能不保留可取回的二进制
+            if (m_build.useCache)
+                glProgramParameteri(ID, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+            glLinkProgram(ID);
+        }
+
+        m_build.elapsedMs = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - start).count();
+    }
+
+    // ========================================================================
+    // 完成程序创建（检查错误、写缓存、构建 uniform 缓存）
+    // ========================================================================
+    // 第一次查询状态时，如果驱动还在后台编译，这里会阻塞直到完成
+    // ========================================================================
+    void finishProgram()
+    {
+        if (!m_build.pending)
+            return;
+
+        auto start = std::chrono::steady_clock::now();
+        ProgramCacheStats& cacheStats = ProgramCache::stats();
+
+        if (m_build.loaded)
+        {
+            cacheStats.hits++;
+        }
+        else
+        {
+            cacheStats.misses++;
+
+            checkCompileErrors(m_build.vertex, "VERTEX");
+            checkCompileErrors(m_build.fragment, "FRAGMENT");
+            if (m_build.geometry)
+                checkCompileErrors(m_build.geometry, "GEOMETRY");
+            checkCompileErrors(ID, "PROGRAM");
+
+            GLint linked = 0;
+            glGetProgramiv(ID, GL_LINK_STATUS, &linked);
+            if (m_build.useCache && linked)
+                ProgramCache::store(m_build.cacheKey, ID);
+
+            // 删除着色器对象（已经链接到程序中，不再需要）
+            glDeleteShader(m_build.vertex);
+            glDeleteShader(m_build.fragment);
+            if (m_build.geometry) glDeleteShader(m_build.geometry);
+        }
+
+        // 缓存所有活动 uniform 的位置，并为它们分配影子副本
+        m_uniforms.build(ID);
+        m_shadow.reset(m_uniforms.maxLocation());
+
+        // 把 FrameData/LightData 等 uniform 块绑定到固定绑定点
+        // （uniform 块绑定不保存在程序二进制中，加载后也要重新设置）
+        BindStandardUniformBlocks(ID);
+
+        m_serial = nextSerial();
+        cacheStats.buildMs += m_build.elapsedMs + std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - start).count();
+        m_build = PendingBuild();
+    }
+
+    // 编译单个着色器阶段
+    unsigned int compileStage(GLenum type, const std::string& code)
+    {
+        const char* source = code.c_str();
+        unsigned int shader = glCreateShader(type);
+        glShaderSource(shader, 1, &source, NULL);
+        glCompileShader(shader);
+        return shader;
+    }
+
     // ========================================================================
     // 检查着色器编译/链接错误
     // ========================================================================
@@ -0,0 +1,218 @@
+// ============================================================================
+// ShaderLibrary 类 - 异步并行创建着色器程序
+// ============================================================================
+// Shader 的构造函数在编译、链接后立即查询 GL_COMPILE_STATUS/GL_LINK_STATUS，
+// 驱动只能在主线程上一个接一个地编译。ShaderLibrary 先一次性提交所有程序，
+// 把状态查询推迟到真正需要的时候：
+//   1. 支持 KHR_parallel_shader_compile（或 ARB 版本）时，驱动在后台线程
+//      并行编译，可以用 GL_COMPLETION_STATUS_KHR 无阻塞地查询是否完成
+//   2. 不支持时，驱动通常也会把编译推迟到第一次查询状态，
+//      提交后先去加载纹理、模型，最后再等待，同样能让两者重叠
+//
+// 用法（在 OnInitialize 中）：
+//   Shader* shader = m_shaders.submit(vsPath, fsPath);   // 只提交，不等待
+//   LoadTextures();                                      // 编译在后台进行
+//   m_shaders.finishAll();                               // 之后才能设置 uniform
+//
+// 同时是一个变体缓存：submit 可以带宏定义（见 ShaderPreprocessor），
+// 只有实际请求过的变体才会编译，并且每个只编译一次
+// ============================================================================
+
+#pragma once
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "shader.h"
+
+// KHR_parallel_shader_compile 的常量和函数（GLAD 只生成了核心功能）
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+typedef void (APIENTRYP PFNGLMAXSHADERCOMPILERTHREADSKHRPROC)(GLuint count);
+
+class ShaderLibrary
+{
+public:
+    ShaderLibrary() : m_parallelChecked(false), m_parallel(false) {}
+
+    // 只释放 Shader 对象（和 Shader 一样不删除程序，上下文销毁时由驱动回收）
+    ~ShaderLibrary() { clear(); }
+
+    ShaderLibrary(const ShaderLibrary&) = delete;
+    ShaderLibrary& operator=(const ShaderLibrary&) = delete;
+
+    // ========================================================================
+    // 提交一个程序变体（需要当前有 OpenGL 上下文）
+    // ========================================================================
+    // 返回的 Shader 由 ShaderLibrary 持有，ID 立即可用，
+    // 但在 isReady() 为 true（或调用 finish/finishAll）之前不能设置 uniform
+    //   - defines:      宏定义（顺序无关），同一份源码按宏编译出不同的变体
+    //   - geometryPath: 为空表示没有几何着色器
+    // 相同的文件和宏集合只会编译一次，之后直接返回已有的 Shader
+    // ========================================================================
+    Shader* submit(const std::string& vertexPath, const std::string& fragmentPath,
+                   const ShaderDefines& defines = ShaderDefines(),
+                   const std::string& geometryPath = std::string())
+    {
+        ShaderDefines normalized = ShaderPreprocessor::normalize(defines);
+        std::string key = variantKey(vertexPath, fragmentPath, geometryPath, normalized);
+        for (const Variant& variant : m_shaders)
+        {
+            if (variant.key == key)
+                return variant.shader;
+        }
+
+        enableParallelCompile();
+
+        Shader* shader = new Shader();
+        shader->m_vertexPath = vertexPath;
+        shader->m_fragmentPath = fragmentPath;
+        shader->m_geometryPath = geometryPath;
+        shader->m_defines = normalized;
+
+        std::string vertexCode, fragmentCode, geometryCode;
+        shader->loadSources(vertexCode, fragmentCode, geometryCode);
+        shader->submitProgram(vertexCode, fragmentCode, geometryCode);
+        if (ShaderWatcher::EnabledByEnv())
+            shader->enableHotReload();
+
+        Variant variant;
+        variant.key = key;
+        variant.shader = shader;
+        m_shaders.push_back(variant);
+        return shader;
+    }
+
+    // 已创建的程序（变体）数量
+    size_t size() const { return m_shaders.size(); }
+
+    // ========================================================================
+    // 就绪/等待状态
+    // ========================================================================
+    // 程序已经完成（编译链接结束，uniform 缓存已建立）
+    bool isReady(const Shader* shader) const
+    {
+        return shader && !shader->m_build.pending;
+    }
+
+    // 还没有完成的程序数
+    size_t pendingCount() const
+    {
+        size_t count = 0;
+        for (const Variant& variant : m_shaders)
+            if (variant.shader->m_build.pending)
+                count++;
+        return count;
+    }
+
+    // ========================================================================
+    // 完成所有驱动已经编译好的程序（不阻塞），返回剩余的等待数
+    // ========================================================================
+    // 可以在加载资源的间隙或每帧调用；不支持并行编译扩展时无法无阻塞地
+    // 查询，所以不做任何事，等待 finish/finishAll
+    // ========================================================================
+    size_t poll()
+    {
+        if (m_parallel)
+        {
+            for (const Variant& variant : m_shaders)
+            {
+                Shader* shader = variant.shader;
+                if (!shader->m_build.pending)
+                    continue;
+                GLint done = GL_FALSE;
+                glGetProgramiv(shader->ID, GL_COMPLETION_STATUS_KHR, &done);
+                if (done)
+                    shader->finishProgram();
+            }
+        }
+        return pendingCount();
+    }
+
+    // 等待并完成一个程序
+    void finish(Shader* shader)
+    {
+        if (shader)
+            shader->finishProgram();
+    }
+
+    // 等待并完成所有程序
+    void finishAll()
+    {
+        for (const Variant& variant : m_shaders)
+            variant.shader->finishProgram();
+    }
+
+    // 删除所有 Shader 对象
+    void clear()
+    {
+        for (const Variant& variant : m_shaders)
+            delete variant.shader;
+        m_shaders.clear();
+    }
+
+    // 驱动是否支持 KHR/ARB_parallel_shader_compile
+    bool isParallel() const { return m_parallel; }
+
+private:
+    // ========================================================================
+    // 检测并行编译扩展，并让驱动使用尽可能多的编译线程
+    // ========================================================================
+    void enableParallelCompile()
+    {
+        if (m_parallelChecked)
+            return;
+        m_parallelChecked = true;
+
+        const char* procName = nullptr;
+        if (hasExtension("GL_KHR_parallel_shader_compile"))
+            procName = "glMaxShaderCompilerThreadsKHR";
+        else if (hasExtension("GL_ARB_parallel_shader_compile"))
+            procName = "glMaxShaderCompilerThreadsARB";
+        if (!procName)
+            return;
+
+        m_parallel = true;
+        PFNGLMAXSHADERCOMPILERTHREADSKHRPROC maxThreads =
+            (PFNGLMAXSHADERCOMPILERTHREADSKHRPROC)glfwGetProcAddress(procName);
+        if (maxThreads)
+            maxThreads(0xFFFFFFFFu);   // 0xFFFFFFFF 表示由驱动决定线程数
+    }
+
+    static bool hasExtension(const char* name)
+    {
+        GLint count = 0;
+        glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+        for (GLint i = 0; i < count; i++)
+        {
+            const char* extension = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, i));
+            if (extension && std::strcmp(extension, name) == 0)
+                return true;
+        }
+        return false;
+    }
+
+    // 变体键：文件路径 + 规范化后的宏列表
+    static std::string variantKey(const std::string& vertexPath, const std::string& fragmentPath,
+                                  const std::string& geometryPath, const ShaderDefines& defines)
+    {
+        std::string key = vertexPath + "|" + fragmentPath + "|" + geometryPath;
+        for (const std::string& define : defines)
+            key += "|" + define;
+        return key;
+    }
+
+    struct Variant {
+        std::string key;
+        Shader* shader;
+    };
+
+    std::vector<Variant> m_shaders;
+    bool m_parallelChecked;
+    bool m_parallel;
+};
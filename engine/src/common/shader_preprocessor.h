@@ -0,0 +1,204 @@
+// ============================================================================
+// ShaderPreprocessor - GLSL #include 展开和宏排列（permutation）
+// ============================================================================
+// GLSL 本身不支持 #include，多个着色器里相同的 uniform 块、光照代码只能复制粘贴。
+// 这里在交给驱动编译之前先做一遍文本处理：
+//   1. 展开 #include "file"：先相对当前文件所在目录查找，再相对 engine/src 查找；
+//      每个文件只展开一次（相当于 #pragma once），所以被包含的文件不需要头文件保护
+//   2. 在 #version 之后插入宏定义，同一份源码可以编译出不同的变体，例如：
+//        { "LIGHT_POINT", "HAS_SPECULAR_MAP" }
+//        { "SHININESS=64.0" }   // NAME=VALUE 形式带值
+//   3. 插入 #line 指令，编译错误中的行号仍然对应原始文件
+//      （#line 的第二个参数是文件序号：0 为主文件，之后按首次包含的顺序编号）
+// ============================================================================
+
+#pragma once
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// 宏定义列表，每一项为 "NAME" 或 "NAME=VALUE"
+typedef std::vector<std::string> ShaderDefines;
+
+class ShaderPreprocessor
+{
+public:
+    // ========================================================================
+    // 读取文件并展开 #include、插入宏定义
+    // ========================================================================
+    // 读取失败时输出错误并返回空字符串
+    // dependencies 不为空时，追加读取过的所有文件（主文件和被包含的文件），
+    // 热重载用它来决定需要监视哪些文件
+    // ========================================================================
+    static std::string load(const std::string& path, const ShaderDefines& defines = ShaderDefines(),
+                            std::vector<std::string>* dependencies = nullptr)
+    {
+        std::vector<std::string> files;
+        std::string output;
+        bool success = expand(path, defines, files, output, 0);
+        if (dependencies)
+            dependencies->insert(dependencies->end(), files.begin(), files.end());
+        if (!success)
+            return std::string();
+        return output;
+    }
+
+    // ========================================================================
+    // 规范化宏列表（排序、去重），相同集合得到相同的源码和缓存键
+    // ========================================================================
+    static ShaderDefines normalize(ShaderDefines defines)
+    {
+        std::sort(defines.begin(), defines.end());
+        defines.erase(std::unique(defines.begin(), defines.end()), defines.end());
+        return defines;
+    }
+
+private:
+    // 最大包含深度（防止循环包含之外的异常情况）
+    static const int MAX_INCLUDE_DEPTH = 16;
+
+    static bool expand(const std::string& path, const ShaderDefines& defines,
+                       std::vector<std::string>& files, std::string& output, int depth)
+    {
+        // 每个文件只展开一次
+        std::string canonical = canonicalPath(path);
+        if (std::find(files.begin(), files.end(), canonical) != files.end())
+            return true;
+
+        // 读取失败也记录下来，热重载时文件修好后还能重新加载
+        int fileIndex = static_cast<int>(files.size());
+        files.push_back(canonical);
+
+        std::string source;
+        if (!readFile(path, source))
+            return false;
+
+        std::string directory = path.substr(0, path.find_last_of("/\\") + 1);
+        std::istringstream lines(source);
+        std::string line;
+        int lineNumber = 0;
+        bool definesInserted = (depth > 0);
+
+        while (std::getline(lines, line))
+        {
+            lineNumber++;
+            std::string directive = trimLeft(line);
+
+            // #version 必须是第一条语句，宏定义放在它后面
+            if (!definesInserted && directive.compare(0, 8, "#version") == 0)
+            {
+                output += line + "\n";
+                for (const std::string& define : normalize(defines))
+                {
+                    size_t equals = define.find('=');
+                    if (equals == std::string::npos)
+                        output += "#define " + define + "\n";
+                    else
+                        output += "#define " + define.substr(0, equals) + " " + define.substr(equals + 1) + "\n";
+                }
+                output += lineDirective(lineNumber + 1, fileIndex);
+                definesInserted = true;
+                continue;
+            }
+
+            if (directive.compare(0, 8, "#include") == 0)
+            {
+                std::string name = includeName(directive);
+                if (name.empty() || depth >= MAX_INCLUDE_DEPTH)
+                {
+                    std::cout << "ERROR::SHADER::INVALID_INCLUDE: " << path << ":" << lineNumber
+                              << ": " << line << std::endl;
+                    return false;
+                }
+
+                std::string includePath = resolveInclude(directory, name);
+                output += lineDirective(1, static_cast<int>(files.size()));
+                if (!expand(includePath, ShaderDefines(), files, output, depth + 1))
+                    return false;
+                output += lineDirective(lineNumber + 1, fileIndex);
+                continue;
+            }
+
+            output += line + "\n";
+        }
+        return true;
+    }
+
+    static bool readFile(const std::string& path, std::string& source)
+    {
+        std::ifstream file;
+        file.exceptions(std::ifstream::failbit | std::ifstream::badbit);
+        try
+        {
+            file.open(path);
+            std::stringstream stream;
+            stream << file.rdbuf();
+            file.close();
+            source = stream.str();
+            return true;
+        }
+        catch (std::ifstream::failure& e)
+        {
+            std::cout << "ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ: " << path << ": " << e.what() << std::endl;
+        }
+        return false;
+    }
+
+    // 先相对当前文件目录，再相对 engine/src
+    static std::string resolveInclude(const std::string& directory, const std::string& name)
+    {
+        std::string local = directory + name;
+        if (std::ifstream(local).good())
+            return local;
+        return std::string(PROJECT_ROOT) + "/engine/src/" + name;
+    }
+
+    // 取出 #include "name" 或 #include <name> 中的文件名
+    static std::string includeName(const std::string& directive)
+    {
+        size_t open = directive.find_first_of("\"<", 8);
+        if (open == std::string::npos)
+            return std::string();
+        char closeChar = directive[open] == '"' ? '"' : '>';
+        size_t close = directive.find(closeChar, open + 1);
+        if (close == std::string::npos)
+            return std::string();
+        return directive.substr(open + 1, close - open - 1);
+    }
+
+    // 去掉 "/./" 和 "dir/../"，让同一个文件通过不同相对路径包含时也能识别出来
+    static std::string canonicalPath(const std::string& path)
+    {
+        std::vector<std::string> parts;
+        std::istringstream stream(path);
+        std::string part;
+        while (std::getline(stream, part, '/'))
+        {
+            if (part == ".")
+                continue;
+            if (part == ".." && !parts.empty() && parts.back() != ".." && !parts.back().empty())
+                parts.pop_back();
+            else
+                parts.push_back(part);
+        }
+        std::string result;
+        for (size_t i = 0; i < parts.size(); i++)
+            result += (i ? "/" : "") + parts[i];
+        return result;
+    }
+
+    static std::string trimLeft(const std::string& line)
+    {
+        size_t start = line.find_first_not_of(" \t");
+        return start == std::string::npos ? std::string() : line.substr(start);
+    }
+
+    static std::string lineDirective(int line, int fileIndex)
+    {
+        return "#line " + std::to_string(line) + " " + std::to_string(fileIndex) + "\n";
+    }
+};
@@ -0,0 +1,199 @@
+// ============================================================================
+// ShaderWatcher 类实现
+// ============================================================================
+
+#include "shader_watcher.h"
+#include "shader.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#if defined(__linux__)
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+bool ShaderWatcher::s_active = false;
+
+// ============================================================================
+// 单例
+// ============================================================================
+ShaderWatcher& ShaderWatcher::Instance()
+{
+    static ShaderWatcher s_instance;
+    return s_instance;
+}
+
+bool ShaderWatcher::EnabledByEnv()
+{
+    const char* value = std::getenv("OPENGL_SHADER_HOT_RELOAD");
+    return value && std::strcmp(value, "0") != 0;
+}
+
+// ============================================================================
+// 构造函数和析构函数
+// ============================================================================
+ShaderWatcher::ShaderWatcher()
+    : m_inotify(-1)
+    , m_running(false)
+{
+    s_active = true;
+#if defined(__linux__)
+    m_inotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (m_inotify < 0)
+    {
+        std::cout << "ShaderWatcher: inotify_init1 failed, hot reload disabled" << std::endl;
+        return;
+    }
+    m_running = true;
+    m_thread = std::thread(&ShaderWatcher::ThreadMain, this);
+#else
+    std::cout << "ShaderWatcher: hot reload is only supported on Linux" << std::endl;
+#endif
+}
+
+ShaderWatcher::~ShaderWatcher()
+{
+    s_active = false;
+    m_running = false;
+    if (m_thread.joinable())
+        m_thread.join();
+#if defined(__linux__)
+    if (m_inotify >= 0)
+        close(m_inotify);
+#endif
+}
+
+// ============================================================================
+// 注册/注销
+// ============================================================================
+void ShaderWatcher::Watch(Shader* shader, const std::vector<std::string>& files)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_shaders[shader] = files;
+    for (const std::string& file : files)
+        AddDirectoryWatch(file);
+}
+
+void ShaderWatcher::Unwatch(Shader* shader)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_shaders.erase(shader);
+}
+
+// 监视目录而不是文件：很多编辑器保存时先写临时文件再重命名，
+// 直接监视文件的话，替换之后监视就失效了
+void ShaderWatcher::AddDirectoryWatch(const std::string& file)
+{
+#if defined(__linux__)
+    if (m_inotify < 0)
+        return;
+
+    std::string directory = file.substr(0, file.find_last_of('/'));
+    for (const auto& entry : m_directories)
+    {
+        if (entry.second == directory)
+            return;
+    }
+
+    int wd = inotify_add_watch(m_inotify, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+    if (wd < 0)
+    {
+        std::cout << "ShaderWatcher: cannot watch " << directory << std::endl;
+        return;
+    }
+    m_directories[wd] = directory;
+#else
+    (void)file;
+#endif
+}
+
+// ============================================================================
+// 后台线程
+// ============================================================================
+void ShaderWatcher::ThreadMain()
+{
+#if defined(__linux__)
+    alignas(inotify_event) char buffer[4096];
+
+    while (m_running)
+    {
+        // 带超时等待，这样析构时线程能及时退出
+        pollfd fd = { m_inotify, POLLIN, 0 };
+        if (poll(&fd, 1, 100) <= 0)
+            continue;
+
+        ssize_t length = read(m_inotify, buffer, sizeof(buffer));
+        if (length <= 0)
+            continue;
+
+        auto now = std::chrono::steady_clock::now();
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (char* ptr = buffer; ptr < buffer + length; )
+        {
+            const inotify_event* event = reinterpret_cast<const inotify_event*>(ptr);
+            ptr += sizeof(inotify_event) + event->len;
+
+            auto directory = m_directories.find(event->wd);
+            if (directory == m_directories.end() || event->len == 0)
+                continue;
+            m_changed[directory->second + "/" + event->name] = now;
+        }
+    }
+#endif
+}
+
+// ============================================================================
+// 帧边界：重载发生变化的着色器
+// ============================================================================
+int ShaderWatcher::Poll()
+{
+    std::vector<Shader*> dirty;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_changed.empty())
+            return 0;
+
+        // 只处理已经稳定下来的文件（最后一次修改之后超过 SETTLE_MS）
+        auto now = std::chrono::steady_clock::now();
+        std::vector<std::string> settled;
+        for (auto it = m_changed.begin(); it != m_changed.end(); )
+        {
+            if (now - it->second >= std::chrono::milliseconds(SETTLE_MS))
+            {
+                settled.push_back(it->first);
+                it = m_changed.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+
+        for (const auto& entry : m_shaders)
+        {
+            for (const std::string& file : entry.second)
+            {
+                bool changed = false;
+                for (const std::string& path : settled)
+                    changed = changed || path == file;
+                if (changed)
+                {
+                    dirty.push_back(entry.first);
+                    break;
+                }
+            }
+        }
+    }
+
+    // reload 会重新调用 Watch（包含的文件可能变了），所以在锁外进行
+    int reloaded = 0;
+    for (Shader* shader : dirty)
+    {
+        if (shader->reload())
+            reloaded++;
+    }
+    return reloaded;
+}
@@ -0,0 +1,77 @@
+// ============================================================================
+// ShaderWatcher 类 - 着色器热重载
+// ============================================================================
+// 调整着色器（例如后期处理的卷积核）时，每改一次都要重启整个程序、
+// 重新加载所有纹理和模型。开启热重载后：
+//   1. 后台线程用 inotify 监视着色器源文件（包括 #include 的文件）所在的目录
+//   2. 文件保存后，主线程在帧边界（Application::Run 每帧开始时调用 Poll）
+//      重新编译对应的着色器，成功则替换程序 ID，失败则继续使用旧程序
+//
+// 开启方式：设置环境变量 OPENGL_SHADER_HOT_RELOAD=1（所有着色器），
+// 或者对单个着色器调用 Shader::enableHotReload()
+// 只支持 Linux（inotify），其他平台上调用不会有任何效果
+// ============================================================================
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class Shader;
+
+class ShaderWatcher
+{
+public:
+    // 全局唯一的监视器（第一次使用时创建，程序退出时停止线程）
+    static ShaderWatcher& Instance();
+
+    // 是否通过环境变量 OPENGL_SHADER_HOT_RELOAD 开启了全局热重载
+    static bool EnabledByEnv();
+
+    // 是否已经创建（有着色器开启过热重载），没有创建时不需要每帧 Poll
+    static bool IsActive() { return s_active; }
+
+    // ========================================================================
+    // 注册/注销（主线程调用）
+    // ========================================================================
+    // files 为着色器用到的所有源文件（规范化后的路径），重复调用会替换文件列表
+    void Watch(Shader* shader, const std::vector<std::string>& files);
+    void Unwatch(Shader* shader);
+
+    // ========================================================================
+    // 在帧边界调用（主线程，需要当前有 OpenGL 上下文）
+    // ========================================================================
+    // 重新编译源文件发生变化的着色器，返回成功重载的数量
+    int Poll();
+
+private:
+    ShaderWatcher();
+    ~ShaderWatcher();
+
+    ShaderWatcher(const ShaderWatcher&) = delete;
+    ShaderWatcher& operator=(const ShaderWatcher&) = delete;
+
+    // 后台线程：读取 inotify 事件，记录变化的文件
+    void ThreadMain();
+    // 确保文件所在目录已被监视（需要持有 m_mutex）
+    void AddDirectoryWatch(const std::string& file);
+
+    // 编辑器保存文件时通常会产生多个事件，最后一个事件之后等这么久再重载
+    static const int SETTLE_MS = 100;
+
+    static bool s_active;
+
+    int m_inotify;                                    // inotify 文件描述符，-1 表示不可用
+    std::thread m_thread;
+    std::atomic<bool> m_running;
+
+    std::mutex m_mutex;                               // 保护下面的成员
+    std::map<int, std::string> m_directories;         // inotify 监视描述符 -> 目录
+    std::map<Shader*, std::vector<std::string>> m_shaders;
+    std::map<std::string, std::chrono::steady_clock::time_point> m_changed;   // 变化的文件 -> 最后修改时间
+};
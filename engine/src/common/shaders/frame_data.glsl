@@ -0,0 +1,8 @@
+// 每帧数据（UBO，绑定点 0，所有着色器共享，由 CameraApplication::UploadFrameData 上传）
+// 内存布局见 common/uniform_buffer.h 中的 FrameData
+layout (std140) uniform FrameData {
+    mat4 view;                          // 视图矩阵
+    mat4 projection;                    // 投影矩阵
+    vec3 viewPos;                       // 相机位置（世界空间）
+    float time;                         // 时间（秒）
+};
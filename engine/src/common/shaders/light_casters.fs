@@ -0,0 +1,126 @@
+#version 330 core
+// ============================================================================
+// 投光物（Light Casters）通用片段着色器 - Phong 光照
+// ============================================================================
+// 由 Shader/ShaderLibrary 传入的宏选择变体（只编译实际用到的组合）：
+//   光源类型（三选一）：
+//     LIGHT_DIRECTIONAL  方向光：固定方向，无衰减（lesson11_1、lesson12_3）
+//     LIGHT_POINT        点光源：距离衰减（lesson11_2、lesson12_2）
+//     LIGHT_SPOT         聚光灯：距离衰减 + 内外锥角平滑边缘（lesson11_3）
+//   材质：
+//     HAS_SPECULAR_MAP   使用镜面反射贴图，否则使用固定的镜面强度 SPECULAR_STRENGTH
+//     MODEL_TEXTURES     使用 Mesh::Draw 的纹理命名（texture_diffuse1、texture_specular1），
+//                        否则使用 material.diffuse、material.specular
+//     MODEL_TEXTURE_ARRAYS  与 MODEL_TEXTURES 一起使用：纹理是纹理数组，层号来自实例属性
+//                        （Model 的 textureArrays 选项，见 common/texture_array.h）
+// ============================================================================
+out vec4 FragColor;                     // 输出：最终片段颜色
+
+in vec3 Normal;                         // 输入：法线向量（从顶点着色器）
+in vec3 FragPos;                        // 输入：片段位置（世界空间）
+in vec2 TexCoord;                       // 输入：纹理坐标（从顶点着色器）
+
+#include "frame_data.glsl"
+#include "light_data.glsl"
+
+#if !defined(LIGHT_DIRECTIONAL) && !defined(LIGHT_POINT) && !defined(LIGHT_SPOT)
+#error "light_casters.fs requires LIGHT_DIRECTIONAL, LIGHT_POINT or LIGHT_SPOT"
+#endif
+
+#ifndef SPECULAR_STRENGTH
+#define SPECULAR_STRENGTH 0.5
+#endif
+
+// 材质属性（使用纹理贴图）
+#ifdef MODEL_TEXTURES
+// 纹理命名约定为 texture_diffuseN, texture_specularN 等，N 从 1 开始
+#ifdef MODEL_TEXTURE_ARRAYS
+flat in vec4 TextureLayers;             // 输入：漫反射、镜面反射贴图的层（x、y）
+uniform sampler2DArray texture_diffuse1;
+uniform sampler2DArray texture_specular1;
+#define DIFFUSE_COORD vec3(TexCoord, TextureLayers.x)
+#define SPECULAR_COORD vec3(TexCoord, TextureLayers.y)
+#else
+uniform sampler2D texture_diffuse1;     // 漫反射贴图 1
+uniform sampler2D texture_specular1;    // 镜面反射贴图 1
+#endif
+#define DIFFUSE_MAP texture_diffuse1
+#define SPECULAR_MAP texture_specular1
+
+struct Material {
+    float shininess;                    // 高光指数（Shininess）
+};
+#else
+struct Material {
+    sampler2D diffuse;                  // 漫反射贴图
+    sampler2D specular;                 // 镜面反射贴图
+    float shininess;                    // 高光指数（Shininess）
+};
+#define DIFFUSE_MAP material.diffuse
+#define SPECULAR_MAP material.specular
+#endif
+
+uniform Material material;              // 材质
+
+#ifndef DIFFUSE_COORD
+#define DIFFUSE_COORD TexCoord
+#define SPECULAR_COORD TexCoord
+#endif
+
+void main()
+{
+    vec3 diffuseColor = vec3(texture(DIFFUSE_MAP, DIFFUSE_COORD));
+#ifdef HAS_SPECULAR_MAP
+    vec3 specularColor = vec3(texture(SPECULAR_MAP, SPECULAR_COORD));
+#else
+    vec3 specularColor = vec3(SPECULAR_STRENGTH);
+#endif
+
+    // 环境光（Ambient）
+    vec3 ambient = light.ambient * diffuseColor;
+
+    // 漫反射（Diffuse）
+    vec3 norm = normalize(Normal);
+#ifdef LIGHT_DIRECTIONAL
+    // 方向光：光源方向是固定的，不需要计算（直接使用 light.direction）
+    vec3 lightDir = normalize(-light.direction);  // 注意：取反，因为 direction 指向光源
+#else
+    // 点光源/聚光灯：计算从片段到光源的方向
+    vec3 lightDir = normalize(light.position - FragPos);
+#endif
+    float diff = max(dot(norm, lightDir), 0.0);
+    vec3 diffuse = light.diffuse * (diff * diffuseColor);
+
+    // 镜面反射（Specular）
+    vec3 viewDir = normalize(viewPos - FragPos);
+    vec3 reflectDir = reflect(-lightDir, norm);
+    float spec = pow(max(dot(viewDir, reflectDir), 0.0), material.shininess);
+    vec3 specular = light.specular * (spec * specularColor);
+
+#ifdef LIGHT_SPOT
+    // 计算聚光灯强度（Spotlight Intensity）
+    // 计算片段到光源的方向与光源方向的夹角
+    float theta = dot(lightDir, normalize(-light.direction));
+    float epsilon = light.cutOff - light.outerCutOff;
+    float intensity = clamp((theta - light.outerCutOff) / epsilon, 0.0, 1.0);
+    
+    // 应用聚光灯强度
+    diffuse *= intensity;
+    specular *= intensity;
+#endif
+
+#if defined(LIGHT_POINT) || defined(LIGHT_SPOT)
+    // 计算距离衰减（Distance Attenuation）
+    float distance = length(light.position - FragPos);
+    float attenuation = 1.0 / (light.constant + light.linear * distance + light.quadratic * (distance * distance));
+
+    // 应用衰减（环境光不受衰减影响，因为它模拟间接光照）
+    ambient *= attenuation;
+    diffuse *= attenuation;
+    specular *= attenuation;
+#endif
+
+    // 最终颜色 = 环境光 + 漫反射 + 镜面反射
+    vec3 result = ambient + diffuse + specular;
+    FragColor = vec4(result, 1.0);
+}
@@ -0,0 +1,14 @@
+// 光源属性（UBO，绑定点 1，内存布局见 common/uniform_buffer.h 中的 LightData）
+// 同时覆盖方向光、点光源和聚光灯；块的实例名为 light，所以通过 light.xxx 访问
+layout (std140) uniform LightData {
+    vec3 position;                      // 光源位置（世界空间）
+    float cutOff;                       // 内角余弦值（聚光灯）
+    vec3 direction;                     // 光源方向（世界空间）
+    float outerCutOff;                  // 外角余弦值（聚光灯）
+    vec3 ambient;                       // 环境光颜色
+    float constant;                     // 衰减常数项
+    vec3 diffuse;                       // 漫反射颜色
+    float linear;                       // 衰减线性项
+    vec3 specular;                      // 镜面反射颜色
+    float quadratic;                    // 衰减二次项
+} light;
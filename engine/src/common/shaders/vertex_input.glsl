@@ -0,0 +1,63 @@
+// 顶点输入（对应 Mesh 的顶点格式，见 common/vertex_format.h）
+// 默认为 float 格式；定义 PACKED_VERTEX 时读取压缩格式并在这里解码。
+// 着色器统一用下面的函数读取，同一份源码两种格式都能用：
+//   vertexPosition()  模型空间位置
+//   vertexNormal()    模型空间法线
+//   vertexTangent()   模型空间切线
+//   vertexBitangent() 模型空间副切线
+//   instanceMatrix()  实例矩阵：Model 中网格所在节点的变换（定义 MODEL_INSTANCES 时读取，否则为单位矩阵）
+//   textureLayers()   纹理数组中的层：漫反射、镜面反射、法线、高度贴图（定义 MODEL_TEXTURE_ARRAYS 时读取）
+#ifdef PACKED_VERTEX
+layout (location = 0) in vec3 aPos;          // float，或归一化到 [0, 1] 的 unorm16
+layout (location = 1) in vec2 aNormal;       // 八面体编码的法线
+layout (location = 2) in vec2 aTexCoord;     // half
+layout (location = 3) in vec4 aTangent;      // xy: 八面体编码的切线，z: 副切线方向（±1）
+
+#ifdef MODEL_INSTANCES
+layout (location = 13) in vec3 aPositionScale;   // 每个实例一个，Model 批处理时网格的量化范围可以不同
+layout (location = 14) in vec3 aPositionOffset;
+#else
+// 只用于单独绘制的 Mesh；绘制 Model 的着色器必须定义 MODEL_INSTANCES
+uniform vec3 meshPositionScale;              // 由 Mesh::Draw 设置
+uniform vec3 meshPositionOffset;
+#define aPositionScale meshPositionScale
+#define aPositionOffset meshPositionOffset
+#endif
+
+vec3 octDecode(vec2 e)
+{
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    float t = max(-n.z, 0.0);                // 下半球从四个角展开回来
+    n.x += n.x >= 0.0 ? -t : t;
+    n.y += n.y >= 0.0 ? -t : t;
+    return normalize(n);
+}
+
+vec3 vertexPosition()  { return aPos * aPositionScale + aPositionOffset; }
+vec3 vertexNormal()    { return octDecode(aNormal); }
+vec3 vertexTangent()   { return octDecode(aTangent.xy); }
+vec3 vertexBitangent() { return cross(vertexNormal(), vertexTangent()) * (aTangent.z < 0.0 ? -1.0 : 1.0); }
+#else
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aNormal;
+layout (location = 2) in vec2 aTexCoord;
+layout (location = 3) in vec3 aTangent;
+layout (location = 4) in vec3 aBitangent;
+
+vec3 vertexPosition()  { return aPos; }
+vec3 vertexNormal()    { return aNormal; }
+vec3 vertexTangent()   { return aTangent; }
+vec3 vertexBitangent() { return aBitangent; }
+#endif
+
+#ifdef MODEL_INSTANCES
+layout (location = 8) in mat4 aInstanceMatrix;   // 每个实例一个（占 8～11 四个位置，见 common/model.h）
+mat4 instanceMatrix() { return aInstanceMatrix; }
+#else
+mat4 instanceMatrix() { return mat4(1.0); }
+#endif
+
+#ifdef MODEL_TEXTURE_ARRAYS
+layout (location = 12) in vec4 aTextureLayers;   // 每个实例一个（见 common/model.h 的 textureArrays 选项）
+vec4 textureLayers() { return aTextureLayers; }
+#endif
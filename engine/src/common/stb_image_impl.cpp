@@ -10,3 +10,23 @@
 #include <stb_image.h>
 
 
+
+// stb_image 没有提供读取翻转设置的函数；工作线程解码时需要用请求时的设置（见 texture_loader.h）
+int stbi_get_flip_vertically_on_load()
+{
+    return stbi__vertically_flip_on_load;
+}
+
+// 按 flip 决定是否上下翻转来加载图片，不改变调用线程的翻转设置。
+// stbi_set_flip_vertically_on_load_thread 设置后会一直覆盖这个线程的全局设置；
+// ThreadPool 没有工作线程时任务在主线程上执行，直接调用它会改掉主线程之后所有 stbi_load 的翻转
+unsigned char* stbi_load_flipped(const char* filename, int* x, int* y, int* components, int desired, int flip)
+{
+    int previousLocal = stbi__vertically_flip_on_load_local;
+    int previousSet = stbi__vertically_flip_on_load_set;
+    stbi_set_flip_vertically_on_load_thread(flip);
+    unsigned char* data = stbi_load(filename, x, y, components, desired);
+    stbi__vertically_flip_on_load_local = previousLocal;
+    stbi__vertically_flip_on_load_set = previousSet;
+    return data;
+}
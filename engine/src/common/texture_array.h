@@ -0,0 +1,195 @@
+// ============================================================================
+// TextureArrayPacker - 把尺寸和格式相同的纹理打包成 GL_TEXTURE_2D_ARRAY
+// ============================================================================
+// 每个网格绑定自己的纹理时，材质不同的网格不能合并到同一次绘制中。
+// 把同一尺寸、同一格式的纹理放进一个纹理数组的不同层后，这些网格绑定的是同一个纹理，
+// 着色器按每个实例的层号采样（见 Model 的 textureArrays 选项和 shaders/vertex_input.glsl）
+//   1. add() 记录图片文件，build() 在工作线程中并行解码（RGB 展开为 RGBA，与 RGBA 图片共用数组）
+//   2. 按 宽 x 高 x 通道数 x 是否 sRGB 分组，每组创建一个纹理数组（超过 GL_MAX_ARRAY_TEXTURE_LAYERS 时分成多个）
+//   3. mip 链由 MipGenerator 生成后逐层上传（OPENGL_CPU_MIPMAPS=0 时用 glGenerateMipmap）
+//
+// 没有使用图集（一张大纹理 + 重映射 UV）：图集中的纹理不能 GL_REPEAT 平铺，
+// 较小的 mip 级别也会混入相邻纹理的颜色；纹理数组的每一层仍然是独立的纹理
+// 数组纹理直接上传（不经过压缩纹理缓存和 TextureStreamer），由创建者调用 release() 删除
+// ============================================================================
+
+#pragma once
+
+#include <glad/glad.h>
+#include <stb_image.h>
+
+#include <algorithm>
+#include <iostream>
+#include <map>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "compressed_texture.h"
+#include "mip_generator.h"
+#include "texture_flags.h"
+#include "texture_upload.h"
+#include "thread_pool.h"
+
+class TextureArrayPacker
+{
+public:
+    // 图片在纹理数组中的位置（texture 为 0 表示图片没有加载成功）
+    struct Layer {
+        unsigned int texture = 0;
+        int layer = -1;
+    };
+
+    TextureArrayPacker() = default;
+    TextureArrayPacker(const TextureArrayPacker&) = delete;
+    TextureArrayPacker& operator=(const TextureArrayPacker&) = delete;
+
+    // ========================================================================
+    // 加入一个图片文件（flags 同 TextureCache：翻转、sRGB），返回编号
+    // ========================================================================
+    size_t add(const std::string& path, unsigned int flags)
+    {
+        m_images.push_back({ path, flags, Layer() });
+        return m_images.size() - 1;
+    }
+
+    // ========================================================================
+    // 解码加入的图片并创建纹理数组（需要 OpenGL 上下文）；已经 build 过的图片不再处理
+    // ========================================================================
+    void build()
+    {
+        std::vector<Decoded> decoded(m_images.size() - m_built);
+        ThreadPool::Instance().parallelFor(decoded.size(), [&](size_t i) {
+            decode(m_images[m_built + i], decoded[i]);
+        });
+
+        // 分组：键相同的图片可以放进同一个数组
+        std::map<std::tuple<int, int, int, bool>, std::vector<size_t>> groups;
+        size_t packed = 0;
+        for (size_t i = 0; i < decoded.size(); i++)
+        {
+            const Decoded& image = decoded[i];
+            if (image.chain.levels.empty())
+            {
+                std::cout << "Texture failed to load at path: " << m_images[m_built + i].path << std::endl;
+                continue;
+            }
+            packed++;
+            bool srgb = (m_images[m_built + i].flags & TEXTURE_FLAG_SRGB) != 0 && image.chain.components >= 3;
+            groups[std::make_tuple(image.chain.levels[0].width, image.chain.levels[0].height,
+                                   image.chain.components, srgb)].push_back(i);
+        }
+
+        GLint maxLayers = 256;
+        glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &maxLayers);
+        size_t arraysBefore = m_textures.size();
+        for (const auto& group : groups)
+        {
+            const std::vector<size_t>& members = group.second;
+            for (size_t first = 0; first < members.size(); first += size_t(maxLayers))
+            {
+                size_t count = std::min(members.size() - first, size_t(maxLayers));
+                unsigned int texture = upload(decoded, members, first, count, std::get<3>(group.first));
+                for (size_t layer = 0; layer < count; layer++)
+                    m_images[m_built + members[first + layer]].result = { texture, static_cast<int>(layer) };
+            }
+        }
+        std::cout << "TextureArrayPacker: packed " << packed << " textures into "
+                  << m_textures.size() - arraysBefore << " texture arrays" << std::endl;
+        m_built = m_images.size();
+    }
+
+    // 第 index 个图片的位置（build 之后有效）
+    Layer layer(size_t index) const { return m_images[index].result; }
+
+    // 创建的纹理数组
+    const std::vector<unsigned int>& textures() const { return m_textures; }
+
+    // 删除所有纹理数组
+    void release()
+    {
+        if (!m_textures.empty())
+            glDeleteTextures(static_cast<GLsizei>(m_textures.size()), m_textures.data());
+        m_textures.clear();
+        m_images.clear();
+        m_built = 0;
+    }
+
+private:
+    struct Image {
+        std::string path;
+        unsigned int flags = 0;
+        Layer result;
+    };
+
+    struct Decoded {
+        MipChain chain;                   // 只有第 0 级（OPENGL_CPU_MIPMAPS=0）或完整的 mip 链
+    };
+
+    // 工作线程：解码并生成 mip 链（与 TextureLoader 相同，RGB 展开为 RGBA）
+    static void decode(const Image& image, Decoded& out)
+    {
+        int width, height, components;
+        int desired = stbi_info(image.path.c_str(), &width, &height, &components) && components == 3 ? STBI_rgb_alpha : 0;
+        // 翻转按 flags 显式传入：没有工作线程时 decode 在主线程上执行，不能改主线程的 stb_image 设置
+        unsigned char* data = stbi_load_flipped(image.path.c_str(), &width, &height, &components, desired,
+                                                (image.flags & TEXTURE_FLAG_FLIP) ? 1 : 0);
+        if (!data)
+            return;
+        components = desired ? desired : components;
+        if (MipGenerator::isEnabled())
+            MipGenerator::generate(data, width, height, components, MipGenerator::optionsFor(image.flags), out.chain);
+        else
+        {
+            out.chain.components = components;
+            out.chain.levels.push_back({ width, height, 0, size_t(width) * height * components });
+            out.chain.data.assign(data, data + out.chain.levels[0].size);
+        }
+        stbi_image_free(data);
+    }
+
+    // 创建一个纹理数组，members[first, first + count) 依次作为各层
+    unsigned int upload(const std::vector<Decoded>& decoded, const std::vector<size_t>& members, size_t first,
+                        size_t count, bool srgb)
+    {
+        const MipChain& reference = decoded[members[first]].chain;
+        GLenum internalFormat = TextureInternalFormat(reference.components, srgb ? TEXTURE_FLAG_SRGB : TEXTURE_FLAG_NONE);
+        GLenum format = TextureDataFormat(reference.components);
+        GLsizei layers = static_cast<GLsizei>(count);
+
+        unsigned int texture;
+        glGenTextures(1, &texture);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, texture);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        for (size_t level = 0; level < reference.levels.size(); level++)
+        {
+            const MipChain::Level& info = reference.levels[level];
+            GLint mip = static_cast<GLint>(level);
+            glTexImage3D(GL_TEXTURE_2D_ARRAY, mip, internalFormat, info.width, info.height, layers, 0, format,
+                         GL_UNSIGNED_BYTE, nullptr);
+            for (size_t layer = 0; layer < count; layer++)
+            {
+                const MipChain& chain = decoded[members[first + layer]].chain;
+                glTexSubImage3D(GL_TEXTURE_2D_ARRAY, mip, 0, 0, static_cast<GLint>(layer), info.width, info.height, 1,
+                                format, GL_UNSIGNED_BYTE, chain.level(level));
+            }
+        }
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        if (reference.levels.size() == 1)
+            glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+        else
+            glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, static_cast<GLint>(reference.levels.size()) - 1);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+        m_textures.push_back(texture);
+        return texture;
+    }
+
+    std::vector<Image> m_images;
+    std::vector<unsigned int> m_textures;
+    size_t m_built = 0;                   // m_images 中已经 build 过的数量
+};
@@ -0,0 +1,128 @@
+// ============================================================================
+// TextureCache - 进程内共享的纹理缓存
+// ============================================================================
+// 同一个图片文件被多个模型（或一个 lesson 的多个地方）引用时只解码、上传一次：
+//   - 键为规范化的绝对路径 + 加载选项（是否翻转、是否 sRGB），哈希表查找
+//   - 每个纹理有引用计数，acquire/insert 加一，release 减一，减到 0 时删除纹理
+//
+// 只能在有 OpenGL 上下文的主线程上使用；Application 销毁上下文之前
+// 调用 clear() 删除所有还在缓存中的纹理（见 Application::Cleanup）
+// 删除纹理时同时取消它在 TextureStreamer 中还没有上传的部分，并从 TextureResidency 中移除
+// ============================================================================
+
+#pragma once
+
+#include <glad/glad.h>
+
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+
+#include "texture_flags.h"
+#include "texture_residency.h"
+#include "texture_streamer.h"
+
+class TextureCache
+{
+public:
+    static TextureCache& Instance()
+    {
+        static TextureCache s_instance;
+        return s_instance;
+    }
+
+    // ========================================================================
+    // 查找已经加载的纹理，找到时引用计数加一并返回纹理 ID，没有找到返回 0
+    // ========================================================================
+    unsigned int acquire(const std::string& path, unsigned int flags)
+    {
+        auto it = m_entries.find(makeKey(path, flags));
+        if (it == m_entries.end())
+            return 0;
+        it->second.references++;
+        return it->second.id;
+    }
+
+    // ========================================================================
+    // 加入刚加载的纹理（引用计数为 1）
+    // ========================================================================
+    void insert(const std::string& path, unsigned int flags, unsigned int id)
+    {
+        if (id == 0)
+            return;
+        std::string key = makeKey(path, flags);
+        Entry& entry = m_entries[key];
+        if (entry.id)
+            m_keys.erase(entry.id);
+        entry.id = id;
+        entry.references = 1;
+        m_keys[id] = key;
+    }
+
+    // ========================================================================
+    // 引用计数减一，减到 0 时删除纹理；不在缓存中的纹理直接删除
+    // ========================================================================
+    void release(unsigned int id)
+    {
+        if (id == 0)
+            return;
+        auto key = m_keys.find(id);
+        if (key == m_keys.end())
+        {
+            TextureStreamer::Instance().cancel(id);
+            TextureResidency::Instance().untrack(id);
+            glDeleteTextures(1, &id);
+            return;
+        }
+        auto entry = m_entries.find(key->second);
+        if (--entry->second.references > 0)
+            return;
+        TextureStreamer::Instance().cancel(id);
+        TextureResidency::Instance().untrack(id);
+        glDeleteTextures(1, &id);
+        m_entries.erase(entry);
+        m_keys.erase(key);
+    }
+
+    // 删除所有纹理（上下文销毁之前调用）
+    void clear()
+    {
+        for (const auto& entry : m_entries)
+        {
+            TextureStreamer::Instance().cancel(entry.second.id);
+            TextureResidency::Instance().untrack(entry.second.id);
+            glDeleteTextures(1, &entry.second.id);
+        }
+        m_entries.clear();
+        m_keys.clear();
+    }
+
+    // 缓存中的纹理数
+    size_t size() const { return m_entries.size(); }
+
+    // 规范化的绝对路径（文件不存在时只做词法上的规范化）
+    static std::string canonicalPath(const std::string& path)
+    {
+        std::error_code error;
+        std::filesystem::path canonical = std::filesystem::weakly_canonical(path, error);
+        if (error)
+            canonical = std::filesystem::absolute(path, error).lexically_normal();
+        return canonical.string();
+    }
+
+private:
+    TextureCache() = default;
+
+    struct Entry {
+        unsigned int id = 0;
+        unsigned int references = 0;
+    };
+
+    static std::string makeKey(const std::string& path, unsigned int flags)
+    {
+        return canonicalPath(path) + '|' + std::to_string(flags);
+    }
+
+    std::unordered_map<std::string, Entry> m_entries;        // 键 -> 纹理
+    std::unordered_map<unsigned int, std::string> m_keys;    // 纹理 ID -> 键
+};
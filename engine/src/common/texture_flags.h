@@ -0,0 +1,15 @@
+// ============================================================================
+// TextureFlags - 纹理加载选项
+// ============================================================================
+// 影响纹理内容的加载选项：TextureCache 的缓存键、压缩格式和 mipmap 的生成方式都取决于它
+// ============================================================================
+
+#pragma once
+
+enum TextureFlags {
+    TEXTURE_FLAG_NONE       = 0,
+    TEXTURE_FLAG_FLIP       = 1 << 0,   // 加载时上下翻转
+    TEXTURE_FLAG_SRGB       = 1 << 1,   // 使用 sRGB 内部格式
+    TEXTURE_FLAG_NORMAL_MAP = 1 << 2,   // 法线贴图（压缩时使用质量更高的 BC7）
+    TEXTURE_FLAG_ALPHA_TEST = 1 << 3,   // 镂空纹理（生成 mipmap 时保持 alpha 覆盖率）
+};
@@ -0,0 +1,258 @@
+// ============================================================================
+// TextureLoader - 在工作线程中解码纹理，在主线程上传
+// ============================================================================
+// stbi_load 解码一张几 MB 的 JPEG 要几十毫秒，模型的纹理一张接一张解码时，
+// 加载时间主要花在这里。TextureLoader 把解码交给 ThreadPool：
+//   1. request() 立即创建纹理对象并上传 1x1 的占位图，返回的 ID 马上可以绑定
+//   2. 工作线程解码图片，完成后放进“已完成”列表
+//   3. 主线程（有 OpenGL 上下文）在 poll()/finish() 中上传已完成的图片
+// mipmap 也在工作线程上生成（MipGenerator），主线程只上传各级数据
+// finish() 在等待的同时按完成顺序上传，解码和上传是重叠进行的
+//
+// 图片是否上下翻转沿用调用 request() 时的 stbi_set_flip_vertically_on_load 设置
+// 驱动支持块压缩时，工作线程先读取（或生成）压缩纹理缓存，见 compressed_texture.h
+// 压缩纹理和 CPU 生成的 mip 链交给 TextureStreamer 分帧上传，见 texture_streamer.h，
+// 并由 TextureResidency 管理显存预算，见 texture_residency.h
+// ============================================================================
+
+#pragma once
+
+#include <glad/glad.h>
+#include <stb_image.h>
+
+#include <condition_variable>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "compressed_texture.h"
+#include "mip_generator.h"
+#include "texture_cache.h"
+#include "texture_residency.h"
+#include "texture_streamer.h"
+#include "texture_upload.h"
+#include "thread_pool.h"
+
+// ============================================================================
+// 把解码后的图片上传到纹理并生成 mipmap（需要 OpenGL 上下文）
+// ============================================================================
+// MipGenerator 启用时在 CPU 上生成 mip 链（按 flags 做 sRGB 滤波、保持 alpha 覆盖率），
+// 否则使用 glGenerateMipmap
+// ============================================================================
+inline void UploadTextureImage(unsigned int textureID, const unsigned char* data, int width, int height, int nrComponents,
+                               unsigned int flags = TEXTURE_FLAG_NONE)
+{
+    if (MipGenerator::isEnabled())
+    {
+        MipChain chain;
+        MipGenerator::generate(data, width, height, nrComponents, MipGenerator::optionsFor(flags), chain);
+        UploadTextureChain(textureID, chain, nrComponents, flags);
+        return;
+    }
+
+    GLenum format = TextureDataFormat(nrComponents);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glBindTexture(GL_TEXTURE_2D, textureID);
+    glTexImage2D(GL_TEXTURE_2D, 0, TextureInternalFormat(nrComponents, flags), width, height, 0, format,
+                 GL_UNSIGNED_BYTE, data);
+    glGenerateMipmap(GL_TEXTURE_2D);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    SetTextureSampling2D();
+}
+
+// ============================================================================
+// 同步加载一个图片文件到 2D 纹理（主线程），返回纹理 ID；失败时返回 0
+// ============================================================================
+// 各 lesson 的 loadTexture 共用：
+//   1. 同一个文件（相同的 flags）只加载一次，其他地方再用时共享（见 texture_cache.h），
+//      不再使用时调用 TextureCache::Instance().release(id)
+//   2. 驱动支持时使用块压缩纹理缓存（见 compressed_texture.h）
+//   3. 否则解码后用 UploadTextureImage 上传（CPU 生成 mipmap）
+// 与 stbi_set_flip_vertically_on_load(flags & TEXTURE_FLAG_FLIP) 一样会修改全局的翻转设置
+// hasAlpha 不为空时，新加载的纹理带透明通道则设为 true（从缓存共享时不修改）
+// ============================================================================
+inline unsigned int LoadTextureFile(const char* path, unsigned int flags, bool* hasAlpha = nullptr)
+{
+    if (unsigned int cached = TextureCache::Instance().acquire(path, flags))
+        return cached;
+
+    if (unsigned int compressed = LoadCompressedTexture(path, flags, hasAlpha))
+    {
+        TextureCache::Instance().insert(path, flags, compressed);
+        return compressed;
+    }
+
+    stbi_set_flip_vertically_on_load((flags & TEXTURE_FLAG_FLIP) != 0);
+    int width, height, nrComponents;
+    unsigned char* data = stbi_load(path, &width, &height, &nrComponents, 0);
+    if (!data)
+    {
+        std::cout << "Failed to load texture: " << path << std::endl;
+        return 0;
+    }
+
+    unsigned int textureID;
+    glGenTextures(1, &textureID);
+    UploadTextureImage(textureID, data, width, height, nrComponents, flags);
+    stbi_image_free(data);
+    if (hasAlpha)
+        *hasAlpha = nrComponents == 4;
+    TextureCache::Instance().insert(path, flags, textureID);
+    return textureID;
+}
+
+class TextureLoader
+{
+public:
+    TextureLoader() : m_state(std::make_shared<State>()), m_pending(0) {}
+
+    // 没有上传的图片在最后一个解码任务结束时释放，纹理保持占位图
+    ~TextureLoader() = default;
+
+    TextureLoader(const TextureLoader&) = delete;
+    TextureLoader& operator=(const TextureLoader&) = delete;
+
+    // ========================================================================
+    // 创建纹理并开始解码 filename，返回纹理 ID（解码完成前内容为 placeholder 颜色）
+    // flags 中的 TEXTURE_FLAG_SRGB/TEXTURE_FLAG_NORMAL_MAP 决定内部格式和压缩格式
+    // ========================================================================
+    unsigned int request(const std::string& filename, const unsigned char placeholder[4],
+                         unsigned int flags = TEXTURE_FLAG_NONE)
+    {
+        unsigned int textureID;
+        glGenTextures(1, &textureID);
+        glBindTexture(GL_TEXTURE_2D, textureID);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, placeholder);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glBindTexture(GL_TEXTURE_2D, 0);
+
+        m_pending++;
+        int flip = stbi_get_flip_vertically_on_load();
+        unsigned int support = CompressedTextureCache::support();
+        std::shared_ptr<State> state = m_state;
+        ThreadPool::Instance().submit([state, textureID, filename, flip, flags, support] {
+            Image image;
+            image.textureID = textureID;
+            image.filename = filename;
+            image.flags = flip ? flags | TEXTURE_FLAG_FLIP : flags & ~TEXTURE_FLAG_FLIP;
+            image.isCompressed = CompressedTextureCache::loadOrCook(filename, image.flags, support, true, image.compressed);
+            if (!image.isCompressed && MipGenerator::isEnabled())
+            {
+                // RGB 图片展开为 RGBA，mip 链用 SIMD 生成
+                int width, height, components;
+                int desired = stbi_info(filename.c_str(), &width, &height, &components) && components == 3 ? STBI_rgb_alpha : 0;
+                unsigned char* data = stbi_load_flipped(filename.c_str(), &image.width, &image.height,
+                                                        &image.nrComponents, desired, flip);
+                if (data)
+                {
+                    MipGenerator::generate(data, image.width, image.height, desired ? desired : image.nrComponents,
+                                           MipGenerator::optionsFor(image.flags), image.mips);
+                    stbi_image_free(data);
+                }
+            }
+            else if (!image.isCompressed)
+                image.data = stbi_load_flipped(filename.c_str(), &image.width, &image.height, &image.nrComponents, 0, flip);
+
+            std::lock_guard<std::mutex> lock(state->mutex);
+            state->ready.push_back(std::move(image));
+            state->readyChanged.notify_one();
+        });
+        return textureID;
+    }
+
+    // ========================================================================
+    // 上传已经解码完成的图片，不等待；返回还没有上传的数量
+    // ========================================================================
+    size_t poll()
+    {
+        if (m_pending == 0)
+            return 0;
+        std::vector<Image> ready;
+        {
+            std::lock_guard<std::mutex> lock(m_state->mutex);
+            ready.swap(m_state->ready);
+        }
+        upload(ready);
+        return m_pending;
+    }
+
+    // ========================================================================
+    // 等待所有图片解码完成并上传
+    // ========================================================================
+    void finish()
+    {
+        while (m_pending > 0)
+        {
+            std::vector<Image> ready;
+            {
+                std::unique_lock<std::mutex> lock(m_state->mutex);
+                m_state->readyChanged.wait(lock, [this] { return !m_state->ready.empty(); });
+                ready.swap(m_state->ready);
+            }
+            upload(ready);
+        }
+    }
+
+    // 还没有上传的纹理数
+    size_t pending() const { return m_pending; }
+
+private:
+    struct Image {
+        unsigned int textureID = 0;
+        std::string filename;
+        unsigned char* data = nullptr;    // stbi_load 的结果（没有在 CPU 上生成 mipmap 时使用）
+        int width = 0;
+        int height = 0;
+        int nrComponents = 0;
+        unsigned int flags = 0;           // TextureFlags
+        bool isCompressed = false;        // 为 true 时使用 compressed 而不是 data
+        CompressedImage compressed;
+        MipChain mips;                    // CPU 生成的 mip 链，解码失败时为空
+    };
+
+    // 与解码任务共享的状态（TextureLoader 销毁后任务仍可能在运行）
+    struct State {
+        std::mutex mutex;
+        std::condition_variable readyChanged;
+        std::vector<Image> ready;         // 已解码、等待上传的图片
+
+        ~State()
+        {
+            for (Image& image : ready)
+                stbi_image_free(image.data);
+        }
+    };
+
+    void upload(std::vector<Image>& images)
+    {
+        for (Image& image : images)
+        {
+            if (image.isCompressed)
+            {
+                TextureResidency::Instance().track(image.textureID, image.filename, image.flags, image.compressed);
+                TextureStreamer::Instance().enqueue(image.textureID, std::move(image.compressed));
+            }
+            else if (!image.mips.levels.empty())
+            {
+                TextureResidency::Instance().track(image.textureID, image.filename, image.flags, image.mips,
+                                                   image.nrComponents);
+                TextureStreamer::Instance().enqueue(image.textureID, std::move(image.mips), image.nrComponents,
+                                                    image.flags);
+            }
+            else if (image.data)
+                UploadTextureImage(image.textureID, image.data, image.width, image.height, image.nrComponents,
+                                   image.flags);
+            else
+                std::cout << "Texture failed to load at path: " << image.filename << std::endl;
+            stbi_image_free(image.data);
+            m_pending--;
+        }
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+
+    std::shared_ptr<State> m_state;
+    size_t m_pending;                     // 已请求、还没有上传的数量（只在主线程使用）
+};
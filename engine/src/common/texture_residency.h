@@ -0,0 +1,399 @@
+// ============================================================================
+// TextureResidency - 纹理显存预算：按 LRU 和屏幕上的需求释放、补回高分辨率 mip 级别
+// ============================================================================
+// 纹理加载后一直保留完整的 mip 链，大场景的纹理可能超出低端机器的显存。
+// TextureResidency 记录每个纹理每一级的字节数，把常驻的纹理数据控制在预算以内：
+//   1. 绘制时 touch() 报告纹理被使用，以及它在屏幕上大约多少像素（决定需要的最清晰级别）
+//   2. 每帧开始时 update() 统计常驻字节数，超出预算时按最近使用时间从旧到新释放最清晰的级别：
+//      先释放最近没有用到的纹理和比需要更清晰的级别，仍然超出时再降低正在使用的纹理
+//      释放的方法是把这些级别重新指定为 0x0 并提高 GL_TEXTURE_BASE_LEVEL，纹理 ID 不变
+//   3. 正在使用的纹理需要更清晰的级别、并且预算放得下时，在工作线程中重新读取
+//      （压缩纹理缓存或解码+生成 mip 链），再交给 TextureStreamer 从小到大补回
+//
+// 只管理从文件加载的 2D 纹理（TextureLoader 调用 track()），
+// 每个纹理至少保留最大边不超过 MIN_RESIDENT_SIZE 的级别
+// 预算：环境变量 OPENGL_TEXTURE_BUDGET_MB，不设置（或为 0）时只统计不释放
+// ============================================================================
+
+#pragma once
+
+#include <glad/glad.h>
+#include <stb_image.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "compressed_texture.h"
+#include "mip_generator.h"
+#include "texture_flags.h"
+#include "texture_streamer.h"
+#include "texture_upload.h"
+#include "thread_pool.h"
+
+class TextureResidency
+{
+public:
+    static TextureResidency& Instance()
+    {
+        static TextureResidency s_instance;
+        return s_instance;
+    }
+
+    TextureResidency(const TextureResidency&) = delete;
+    TextureResidency& operator=(const TextureResidency&) = delete;
+
+    // ========================================================================
+    // 开始管理一个纹理（数据已经交给 TextureStreamer 或已经上传）
+    // path 和 flags 用于之后重新读取被释放的级别，与加载时相同
+    // ========================================================================
+    void track(unsigned int textureID, const std::string& path, unsigned int flags, const CompressedImage& image)
+    {
+        if (image.levels.empty())
+            return;
+        Entry& entry = add(textureID, path, flags, image.levels[0].width, image.levels[0].height);
+        entry.compressed = true;
+        entry.internalFormat = image.format;
+        for (const CompressedImage::Level& level : image.levels)
+            entry.levelBytes.push_back(level.size);
+    }
+
+    // nrComponents 是图片本来的通道数（与 UploadTextureChain 相同）
+    void track(unsigned int textureID, const std::string& path, unsigned int flags, const MipChain& chain,
+               int nrComponents)
+    {
+        if (chain.levels.empty())
+            return;
+        Entry& entry = add(textureID, path, flags, chain.levels[0].width, chain.levels[0].height);
+        entry.internalFormat = TextureInternalFormat(nrComponents, flags);
+        entry.format = TextureDataFormat(chain.components);
+        entry.nrComponents = nrComponents;
+        // RGB8 在显存中通常按 4 字节对齐存放
+        size_t texelBytes = nrComponents == 3 ? 4 : size_t(nrComponents);
+        for (const MipChain::Level& level : chain.levels)
+            entry.levelBytes.push_back(size_t(level.width) * level.height * texelBytes);
+    }
+
+    // 纹理被删除（TextureCache 删除纹理时调用）
+    void untrack(unsigned int textureID) { m_entries.erase(textureID); }
+
+    // ========================================================================
+    // 绘制时报告纹理被使用；screenPixels 为纹理在屏幕上的大约尺寸（像素），
+    // 0 表示未知（需要最清晰的级别）
+    // ========================================================================
+    void touch(unsigned int textureID, float screenPixels = 0.0f)
+    {
+        auto it = m_entries.find(textureID);
+        if (it == m_entries.end())
+            return;
+        Entry& entry = it->second;
+        int level = 0;
+        if (screenPixels > 0.0f)
+        {
+            float ratio = float(std::max(entry.width, entry.height)) / screenPixels;
+            level = ratio > 1.0f ? static_cast<int>(std::floor(std::log2(ratio))) : 0;
+            level = std::min(level, static_cast<int>(entry.levelBytes.size()) - 1);
+        }
+        // 一帧中多次使用时取最清晰的需求
+        entry.demandLevel = entry.lastUsed == m_frame ? std::min(entry.demandLevel, level) : level;
+        entry.lastUsed = m_frame;
+    }
+
+    // ========================================================================
+    // 每帧开始时调用（主线程，在 TextureStreamer::update 之前）
+    // ========================================================================
+    void update()
+    {
+        m_frame++;
+        collectRestores();
+        if (m_budget == 0 || m_entries.empty())
+            return;
+
+        size_t resident = residentBytes();
+        if (resident > m_budget)
+            evict(resident);
+        else
+            restore(resident);
+    }
+
+    // 停止管理所有纹理（上下文销毁之前调用）；还在读取的数据被丢弃
+    void clear()
+    {
+        m_entries.clear();
+        m_state = std::make_shared<State>();
+        m_restoring = 0;
+    }
+
+    // 常驻的纹理字节数（只统计管理的纹理）
+    size_t residentBytes() const
+    {
+        size_t bytes = 0;
+        for (const auto& entry : m_entries)
+            bytes += entry.second.bytes(entry.second.residentLevel, entry.second.levelCount());
+        return bytes;
+    }
+
+    // 预算（字节，0 表示不限制）
+    size_t budget() const { return m_budget; }
+
+private:
+    static const int MIN_RESIDENT_SIZE = 64;            // 始终保留的级别的最大边长
+    static const unsigned int MAX_RESTORES = 4;         // 同时在工作线程中读取的纹理数
+
+    struct Entry {
+        std::string path;
+        unsigned int flags = 0;
+        unsigned int serial = 0;                        // 区分重复使用的纹理 ID
+        bool compressed = false;
+        GLenum internalFormat = 0;
+        GLenum format = 0;                              // 未压缩纹理上传时的像素格式
+        int nrComponents = 0;
+        int width = 0;
+        int height = 0;
+        std::vector<size_t> levelBytes;                 // 每一级在显存中的字节数
+
+        int residentLevel = 0;                          // 常驻的最清晰的级别（= GL_TEXTURE_BASE_LEVEL）
+        int demandLevel = 0;                            // 最近一次使用时需要的最清晰的级别
+        unsigned int lastUsed = 0;                      // 最近一次使用的帧
+        bool restoring = false;                         // 正在工作线程中读取
+
+        int levelCount() const { return static_cast<int>(levelBytes.size()); }
+
+        size_t bytes(int first, int end) const
+        {
+            size_t total = 0;
+            for (int level = first; level < end; level++)
+                total += levelBytes[level];
+            return total;
+        }
+
+        // 至少保留的级别
+        int tailLevel() const
+        {
+            int level = 0;
+            while (level + 1 < levelCount() && std::max(width >> level, height >> level) > MIN_RESIDENT_SIZE)
+                level++;
+            return level;
+        }
+    };
+
+    // 工作线程读取的结果
+    struct Restore {
+        unsigned int textureID = 0;
+        unsigned int serial = 0;
+        int firstLevel = 0;
+        bool loaded = false;
+        CompressedImage image;
+        MipChain chain;
+    };
+
+    // 与读取任务共享的状态
+    struct State {
+        std::mutex mutex;
+        std::vector<Restore> ready;
+    };
+
+    TextureResidency() : m_state(std::make_shared<State>()), m_frame(0), m_serial(0), m_restoring(0)
+    {
+        const char* value = std::getenv("OPENGL_TEXTURE_BUDGET_MB");
+        m_budget = value ? size_t(std::max(0L, std::atol(value))) * 1024 * 1024 : 0;
+    }
+
+    Entry& add(unsigned int textureID, const std::string& path, unsigned int flags, int width, int height)
+    {
+        Entry& entry = m_entries[textureID];
+        entry = Entry();
+        entry.path = path;
+        entry.flags = flags;
+        entry.serial = ++m_serial;
+        entry.width = width;
+        entry.height = height;
+        entry.lastUsed = m_frame;
+        return entry;
+    }
+
+    // 最近两帧内用到过
+    bool recentlyUsed(const Entry& entry) const { return m_frame - entry.lastUsed <= 1; }
+
+    // 正在上传或读取的纹理不能释放
+    static bool busy(unsigned int textureID, const Entry& entry)
+    {
+        return entry.restoring || TextureStreamer::Instance().queued(textureID);
+    }
+
+    // ========================================================================
+    // 释放级别直到不超出预算：按最近使用时间从旧到新，
+    // 第一轮只释放最近没用到的纹理和比需要更清晰的级别，第二轮降低所有纹理到保留的级别
+    // ========================================================================
+    void evict(size_t resident)
+    {
+        std::vector<std::pair<unsigned int, Entry*>> order;
+        for (auto& entry : m_entries)
+        {
+            if (!entry.second.path.empty() && !busy(entry.first, entry.second))
+                order.push_back({ entry.first, &entry.second });
+        }
+        std::sort(order.begin(), order.end(),
+                  [](const auto& a, const auto& b) { return a.second->lastUsed < b.second->lastUsed; });
+
+        GLint bound = 0;
+        glGetIntegerv(GL_TEXTURE_BINDING_2D, &bound);
+        size_t before = resident;
+        int levels = 0;
+        for (int pass = 0; pass < 2 && resident > m_budget; pass++)
+        {
+            for (auto& item : order)
+            {
+                Entry& entry = *item.second;
+                int limit = entry.tailLevel();
+                if (pass == 0 && recentlyUsed(entry))
+                    limit = std::min(limit, entry.demandLevel);
+                // 一次释放一级，刚好不超出预算时停止
+                while (resident > m_budget && entry.residentLevel < limit)
+                {
+                    resident -= entry.levelBytes[entry.residentLevel];
+                    dropLevel(item.first, entry);
+                    levels++;
+                }
+                if (resident <= m_budget)
+                    break;
+            }
+        }
+        glBindTexture(GL_TEXTURE_2D, bound);
+
+        if (levels > 0)
+            std::cout << "TextureResidency: evicted " << levels << " mip levels (" << (before - resident) / (1024.0 * 1024.0)
+                      << " MB), resident " << resident / (1024.0 * 1024.0) << " / " << m_budget / (1024 * 1024)
+                      << " MB" << std::endl;
+    }
+
+    // 释放最清晰的常驻级别
+    static void dropLevel(unsigned int textureID, Entry& entry)
+    {
+        int level = entry.residentLevel++;
+        glBindTexture(GL_TEXTURE_2D, textureID);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, entry.residentLevel);
+        if (entry.compressed)
+            glCompressedTexImage2D(GL_TEXTURE_2D, level, entry.internalFormat, 0, 0, 0, 0, nullptr);
+        else
+            glTexImage2D(GL_TEXTURE_2D, level, entry.internalFormat, 0, 0, 0, entry.format, GL_UNSIGNED_BYTE, nullptr);
+    }
+
+    // ========================================================================
+    // 正在使用、需要更清晰级别的纹理，预算放得下时开始重新读取
+    // ========================================================================
+    void restore(size_t resident)
+    {
+        unsigned int support = 0;
+        bool supportKnown = false;
+        for (auto& item : m_entries)
+        {
+            if (m_restoring >= MAX_RESTORES)
+                break;
+            Entry& entry = item.second;
+            if (entry.path.empty() || entry.residentLevel <= entry.demandLevel || !recentlyUsed(entry) ||
+                busy(item.first, entry))
+                continue;
+            size_t needed = entry.bytes(entry.demandLevel, entry.residentLevel);
+            if (resident + needed > m_budget)
+                continue;
+            resident += needed;
+
+            if (entry.compressed && !supportKnown)
+            {
+                support = CompressedTextureCache::support();
+                supportKnown = true;
+            }
+            entry.restoring = true;
+            m_restoring++;
+            submitRestore(item.first, entry, support);
+        }
+    }
+
+    void submitRestore(unsigned int textureID, const Entry& entry, unsigned int support)
+    {
+        std::shared_ptr<State> state = m_state;
+        std::string path = entry.path;
+        unsigned int flags = entry.flags;
+        unsigned int serial = entry.serial;
+        int firstLevel = entry.demandLevel;
+        bool compressed = entry.compressed;
+        ThreadPool::Instance().submit([state, textureID, path, flags, serial, firstLevel, compressed, support] {
+            Restore result;
+            result.textureID = textureID;
+            result.serial = serial;
+            result.firstLevel = firstLevel;
+            if (compressed)
+                result.loaded = CompressedTextureCache::loadOrCook(path, flags, support, true, result.image);
+            else
+            {
+                // 与 TextureLoader 相同：RGB 图片展开为 RGBA
+                int width, height, components;
+                int desired = stbi_info(path.c_str(), &width, &height, &components) && components == 3 ? STBI_rgb_alpha : 0;
+                unsigned char* data = stbi_load_flipped(path.c_str(), &width, &height, &components, desired,
+                                                        (flags & TEXTURE_FLAG_FLIP) ? 1 : 0);
+                if (data)
+                {
+                    MipGenerator::generate(data, width, height, desired ? desired : components,
+                                           MipGenerator::optionsFor(flags), result.chain);
+                    stbi_image_free(data);
+                    result.loaded = true;
+                }
+            }
+
+            std::lock_guard<std::mutex> lock(state->mutex);
+            state->ready.push_back(std::move(result));
+        });
+    }
+
+    // 把读取完成的级别交给 TextureStreamer
+    void collectRestores()
+    {
+        if (m_restoring == 0)
+            return;
+        std::vector<Restore> ready;
+        {
+            std::lock_guard<std::mutex> lock(m_state->mutex);
+            ready.swap(m_state->ready);
+        }
+        for (Restore& result : ready)
+        {
+            m_restoring--;
+            auto it = m_entries.find(result.textureID);
+            if (it == m_entries.end() || it->second.serial != result.serial)
+                continue;
+            Entry& entry = it->second;
+            entry.restoring = false;
+
+            size_t levelCount = entry.compressed ? result.image.levels.size() : result.chain.levels.size();
+            if (!result.loaded || levelCount != entry.levelBytes.size())
+            {
+                // 文件已经变化或无法读取：不再释放这个纹理
+                std::cout << "TextureResidency: failed to reload " << entry.path << std::endl;
+                entry.path.clear();
+                continue;
+            }
+            if (entry.compressed)
+                TextureStreamer::Instance().enqueue(result.textureID, std::move(result.image), GL_TEXTURE_2D,
+                                                    result.firstLevel, entry.residentLevel - 1);
+            else
+                TextureStreamer::Instance().enqueue(result.textureID, std::move(result.chain), entry.nrComponents,
+                                                    entry.flags, GL_TEXTURE_2D, result.firstLevel,
+                                                    entry.residentLevel - 1);
+            entry.residentLevel = std::min(entry.residentLevel, result.firstLevel);
+        }
+    }
+
+    std::unordered_map<unsigned int, Entry> m_entries;   // 纹理 ID -> 记录
+    std::shared_ptr<State> m_state;
+    size_t m_budget;
+    unsigned int m_frame;
+    unsigned int m_serial;
+    unsigned int m_restoring;                           // 已经提交、还没有收回结果的读取任务数
+};
@@ -0,0 +1,479 @@
+// ============================================================================
+// TextureStreamer - 按每帧预算分批上传纹理
+// ============================================================================
+// 一张 2048x2048 的纹理连同 mip 链有 20 MB 左右，用 glTexImage2D 一次上传会让加载后的
+// 前几帧卡顿。TextureStreamer 把已经解码（或读取压缩缓存）的纹理排队，每帧只上传
+// 不超过预算的字节数：
+//   1. 从最小的 mip 级别开始上传，每完成一级就把 GL_TEXTURE_BASE_LEVEL 降到这一级，
+//      纹理一开始就能显示（模糊），之后逐渐变清晰
+//   2. 大的级别按行（压缩格式按块行）拆成多次 glTexSubImage2D，每帧的上传量有上限
+//   3. 数据先复制到像素缓冲对象（PBO）再由驱动异步读取；PBO 是一个环（每帧一个），
+//      GL 4.4 以上持久映射并用 fence 等待 RING_SIZE 帧之前的上传完成，否则每帧重新分配
+//      （orphan）后映射
+// Application 每帧开始时调用 update()，上传耗时和字节数记录到 FrameProfiler
+//
+// 每帧预算：环境变量 OPENGL_TEXTURE_UPLOAD_BUDGET_KB（默认 4096）
+// 设置 OPENGL_TEXTURE_STREAMING=0 时 enqueue 直接上传全部数据（用于对比）
+// ============================================================================
+
+#pragma once
+
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <vector>
+
+#include "compressed_texture.h"
+#include "frame_profiler.h"
+#include "mip_generator.h"
+#include "texture_upload.h"
+
+class TextureStreamer
+{
+public:
+    static TextureStreamer& Instance()
+    {
+        static TextureStreamer s_instance;
+        return s_instance;
+    }
+
+    static bool isEnabled()
+    {
+        const char* value = std::getenv("OPENGL_TEXTURE_STREAMING");
+        return !value || std::strcmp(value, "0") != 0;
+    }
+
+    TextureStreamer(const TextureStreamer&) = delete;
+    TextureStreamer& operator=(const TextureStreamer&) = delete;
+
+    // ========================================================================
+    // 排队上传 CPU 生成的 mip 链（nrComponents 决定内部格式，见 UploadTextureChain）
+    // ========================================================================
+    // target 为 GL_TEXTURE_2D 或立方体贴图的一个面（GL_TEXTURE_CUBE_MAP_POSITIVE_X + i）；
+    // 2D 纹理会设置与 UploadTextureImage 相同的采样参数，立方体贴图的参数由调用者设置
+    // 只上传 firstLevel 到 lastLevel（-1 为最后一级）：纹理已有 lastLevel 以下的级别时用于
+    // 补回被 TextureResidency 释放的级别，见 texture_residency.h
+    // ========================================================================
+    void enqueue(unsigned int textureID, MipChain chain, int nrComponents, unsigned int flags,
+                 GLenum target = GL_TEXTURE_2D, int firstLevel = 0, int lastLevel = -1)
+    {
+        bool whole = firstLevel == 0 && lastLevel < 0;
+        if (!isEnabled() && whole)
+        {
+            if (target == GL_TEXTURE_2D)
+                UploadTextureChain(textureID, chain, nrComponents, flags);
+            else
+                uploadDirect(textureID, target, TextureInternalFormat(nrComponents, flags),
+                             TextureDataFormat(chain.components), chain);
+            return;
+        }
+
+        Job job = makeJob(textureID, target, chain.levels.size(), firstLevel, lastLevel);
+        if (job.level < job.firstLevel)
+            return;
+        job.internalFormat = TextureInternalFormat(nrComponents, flags);
+        job.format = TextureDataFormat(chain.components);
+        for (const MipChain::Level& level : chain.levels)
+            job.levels.push_back({ level.width, level.height, level.offset, level.size,
+                                   size_t(level.width) * chain.components, level.height });
+        job.mips = std::move(chain);
+        m_jobs.push_back(std::move(job));
+        if (!isEnabled())
+            finish();
+    }
+
+    // 排队上传块压缩纹理（见 compressed_texture.h），级别范围同上
+    void enqueue(unsigned int textureID, CompressedImage image, GLenum target = GL_TEXTURE_2D,
+                 int firstLevel = 0, int lastLevel = -1)
+    {
+        bool whole = firstLevel == 0 && lastLevel < 0;
+        if (!isEnabled() && whole)
+        {
+            if (target == GL_TEXTURE_2D)
+                UploadCompressedTexture(textureID, image);
+            else
+            {
+                glBindTexture(GL_TEXTURE_CUBE_MAP, textureID);
+                CompressedTextureCache::uploadLevels(target, image);
+                glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAX_LEVEL, static_cast<GLint>(image.levels.size()) - 1);
+            }
+            return;
+        }
+
+        Job job = makeJob(textureID, target, image.levels.size(), firstLevel, lastLevel);
+        if (job.level < job.firstLevel)
+            return;
+        job.compressed = true;
+        job.internalFormat = image.format;
+        for (const CompressedImage::Level& level : image.levels)
+        {
+            int blockRows = std::max(1, (level.height + 3) / 4);
+            job.levels.push_back({ level.width, level.height, level.offset, level.size,
+                                   level.size / blockRows, blockRows });
+        }
+        job.image = std::move(image);
+        m_jobs.push_back(std::move(job));
+        if (!isEnabled())
+            finish();
+    }
+
+    // ========================================================================
+    // 上传本帧预算内的数据（每帧调用一次，需要 OpenGL 上下文）
+    // ========================================================================
+    void update()
+    {
+        if (m_jobs.empty())
+            return;
+        auto start = std::chrono::steady_clock::now();
+        size_t bytes = step();
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        FrameProfiler::RecordTextureUpload(ms, bytes);
+
+        m_stats.frames++;
+        m_stats.bytes += bytes;
+        m_stats.maxMs = std::max(m_stats.maxMs, ms);
+        if (m_jobs.empty())
+        {
+            std::cout << "TextureStreamer: streamed " << m_stats.textures << " textures ("
+                      << m_stats.bytes / (1024.0 * 1024.0) << " MB) over " << m_stats.frames << " frames, max "
+                      << m_stats.maxMs << " ms/frame (budget " << m_budget / 1024 << " KB/frame)" << std::endl;
+            m_stats = Stats();
+        }
+    }
+
+    // 不限预算，上传所有排队的数据
+    void finish()
+    {
+        while (!m_jobs.empty())
+            step();
+    }
+
+    // 纹理被删除：丢弃还没有上传的部分（TextureCache 删除纹理时调用）
+    void cancel(unsigned int textureID)
+    {
+        m_jobs.erase(std::remove_if(m_jobs.begin(), m_jobs.end(),
+                                    [textureID](const Job& job) { return job.textureID == textureID; }),
+                     m_jobs.end());
+    }
+
+    // 丢弃所有排队的纹理并删除 PBO（上下文销毁之前调用）
+    void clear()
+    {
+        m_jobs.clear();
+        for (Slot& slot : m_slots)
+        {
+            if (slot.fence)
+                glDeleteSync(slot.fence);
+            if (slot.buffer)
+                glDeleteBuffers(1, &slot.buffer);
+            slot = Slot();
+        }
+        m_stats = Stats();
+    }
+
+    // 还在排队的纹理数
+    size_t pending() const { return m_jobs.size(); }
+
+    // 纹理是否还有没有上传的部分
+    bool queued(unsigned int textureID) const
+    {
+        for (const Job& job : m_jobs)
+        {
+            if (job.textureID == textureID)
+                return true;
+        }
+        return false;
+    }
+
+private:
+    static const unsigned int RING_SIZE = 3;            // PBO 数量（同时在使用中的帧数）
+    static const size_t MIN_BUDGET = 256 * 1024;        // 至少能放下一行/一个块行
+
+    struct Level {
+        int width;
+        int height;
+        size_t offset;                                  // 在数据中的字节偏移
+        size_t size;
+        size_t rowBytes;                                // 一行（压缩格式为一个块行）的字节数
+        int rows;                                       // 行数（压缩格式为块行数）
+    };
+
+    struct Job {
+        unsigned int textureID = 0;
+        GLenum bindTarget = GL_TEXTURE_2D;              // 绑定目标（立方体贴图为 GL_TEXTURE_CUBE_MAP）
+        GLenum imageTarget = GL_TEXTURE_2D;             // 上传目标（立方体贴图的面）
+        bool compressed = false;
+        GLenum internalFormat = 0;                      // 压缩格式时为 GL 压缩格式
+        GLenum format = 0;
+        std::vector<Level> levels;
+        MipChain mips;                                  // 数据（二者之一）
+        CompressedImage image;
+
+        int level = 0;                                  // 正在上传的级别（从 lastLevel 往前）
+        int firstLevel = 0;                             // 上传到这一级为止
+        int row = 0;                                    // 这一级已经上传的行数
+        bool started = false;                           // 从最后一级开始的纹理在第一次上传时设置参数
+
+        const unsigned char* data() const { return compressed ? image.data() : mips.data.data(); }
+    };
+
+    struct Slot {
+        GLuint buffer = 0;
+        unsigned char* mapped = nullptr;                // 持久映射的地址
+        GLsync fence = nullptr;                         // 最后一次使用这个 PBO 的上传
+    };
+
+    struct Stats {
+        unsigned int textures = 0;
+        unsigned int frames = 0;
+        size_t bytes = 0;
+        double maxMs = 0.0;
+    };
+
+    // 一次上传（一个级别的若干行）
+    struct Chunk {
+        unsigned int textureID;
+        GLenum bindTarget;
+        GLenum imageTarget;
+        bool compressed;
+        GLenum internalFormat;
+        GLenum format;
+        int levelCount;
+        int level;
+        int width;
+        int height;                                     // 级别的尺寸
+        int y;                                          // 起始像素行
+        int rows;                                       // 像素行数
+        size_t offset;                                  // 在 PBO 中的偏移
+        size_t bytes;
+        size_t levelBytes;
+        bool startJob;                                  // 纹理的第一次上传：设置参数
+        bool levelComplete;                             // 这一级上传完成
+    };
+
+    TextureStreamer() : m_persistent(false), m_frame(0)
+    {
+        const char* value = std::getenv("OPENGL_TEXTURE_UPLOAD_BUDGET_KB");
+        size_t budget = value ? size_t(std::max(0L, std::atol(value))) * 1024 : 4096 * 1024;
+        m_budget = std::max(budget, MIN_BUDGET);
+    }
+
+    static Job makeJob(unsigned int textureID, GLenum target, size_t levelCount, int firstLevel, int lastLevel)
+    {
+        int last = static_cast<int>(levelCount) - 1;
+        Job job;
+        job.textureID = textureID;
+        job.imageTarget = target;
+        job.bindTarget = target == GL_TEXTURE_2D ? GL_TEXTURE_2D : GL_TEXTURE_CUBE_MAP;
+        job.level = lastLevel < 0 ? last : std::min(lastLevel, last);
+        job.firstLevel = std::max(firstLevel, 0);
+        job.started = job.level != last;
+        return job;
+    }
+
+    static void uploadDirect(unsigned int textureID, GLenum target, GLenum internalFormat, GLenum format,
+                             const MipChain& chain)
+    {
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glBindTexture(GL_TEXTURE_CUBE_MAP, textureID);
+        for (size_t level = 0; level < chain.levels.size(); level++)
+        {
+            const MipChain::Level& info = chain.levels[level];
+            glTexImage2D(target, static_cast<GLint>(level), internalFormat, info.width, info.height, 0, format,
+                         GL_UNSIGNED_BYTE, chain.level(level));
+        }
+        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAX_LEVEL, static_cast<GLint>(chain.levels.size()) - 1);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    }
+
+    void createBuffers()
+    {
+        m_persistent = GLAD_GL_VERSION_4_4 != 0;
+        for (Slot& slot : m_slots)
+        {
+            glGenBuffers(1, &slot.buffer);
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, slot.buffer);
+            if (m_persistent)
+            {
+                GLbitfield access = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+                glBufferStorage(GL_PIXEL_UNPACK_BUFFER, m_budget, nullptr, access);
+                slot.mapped = static_cast<unsigned char*>(glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, m_budget, access));
+            }
+            else
+                glBufferData(GL_PIXEL_UNPACK_BUFFER, m_budget, nullptr, GL_STREAM_DRAW);
+        }
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    }
+
+    // ========================================================================
+    // 一帧的上传：选出预算内的行复制到 PBO，再从 PBO 上传，返回字节数
+    // ========================================================================
+    size_t step()
+    {
+        if (m_slots[0].buffer == 0)
+            createBuffers();
+        Slot& slot = m_slots[m_frame++ % RING_SIZE];
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, slot.buffer);
+
+        unsigned char* mapped = slot.mapped;
+        if (m_persistent)
+        {
+            // 等待 RING_SIZE 帧之前从这个 PBO 的上传完成（通常早已完成）
+            if (slot.fence)
+            {
+                glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000ull);
+                glDeleteSync(slot.fence);
+                slot.fence = nullptr;
+            }
+        }
+        else
+        {
+            // 重新分配存储（驱动仍在读取的旧存储在上传完成后释放），不需要等待
+            glBufferData(GL_PIXEL_UNPACK_BUFFER, m_budget, nullptr, GL_STREAM_DRAW);
+            mapped = static_cast<unsigned char*>(glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, m_budget,
+                                                                  GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+        }
+        if (!mapped)
+        {
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+            return 0;
+        }
+
+        std::vector<Chunk> chunks;
+        size_t used = plan(mapped, chunks);
+        if (!m_persistent)
+            glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+
+        // 有的 lesson 只在初始化时绑定一次纹理，上传之后恢复当前纹理单元的绑定
+        GLint bound2D = 0, boundCube = 0;
+        glGetIntegerv(GL_TEXTURE_BINDING_2D, &bound2D);
+        glGetIntegerv(GL_TEXTURE_BINDING_CUBE_MAP, &boundCube);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        for (const Chunk& chunk : chunks)
+            upload(slot.buffer, chunk);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        glBindTexture(GL_TEXTURE_2D, bound2D);
+        glBindTexture(GL_TEXTURE_CUBE_MAP, boundCube);
+
+        if (m_persistent && used > 0)
+            slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        return used;
+    }
+
+    // 从队首开始，按级别从小到大、每级从上到下取行，直到放不下；数据复制到 mapped
+    size_t plan(unsigned char* mapped, std::vector<Chunk>& chunks)
+    {
+        size_t used = 0;
+        while (!m_jobs.empty())
+        {
+            Job& job = m_jobs.front();
+            const Level& level = job.levels[job.level];
+            int rows = static_cast<int>(std::min<size_t>((m_budget - used) / level.rowBytes, level.rows - job.row));
+            if (rows <= 0)
+                break;
+
+            Chunk chunk;
+            chunk.textureID = job.textureID;
+            chunk.bindTarget = job.bindTarget;
+            chunk.imageTarget = job.imageTarget;
+            chunk.compressed = job.compressed;
+            chunk.internalFormat = job.internalFormat;
+            chunk.format = job.format;
+            chunk.levelCount = static_cast<int>(job.levels.size());
+            chunk.level = job.level;
+            chunk.width = level.width;
+            chunk.height = level.height;
+            int rowHeight = job.compressed ? 4 : 1;
+            chunk.y = job.row * rowHeight;
+            chunk.rows = std::min(rows * rowHeight, level.height - chunk.y);
+            chunk.offset = used;
+            chunk.bytes = size_t(rows) * level.rowBytes;
+            chunk.levelBytes = level.size;
+            chunk.startJob = !job.started;
+            job.row += rows;
+            chunk.levelComplete = job.row == level.rows;
+            chunks.push_back(chunk);
+
+            std::memcpy(mapped + used, job.data() + level.offset + size_t(chunk.y / rowHeight) * level.rowBytes,
+                        chunk.bytes);
+            used += chunk.bytes;
+            job.started = true;
+
+            if (chunk.levelComplete)
+            {
+                job.level--;
+                job.row = 0;
+                if (job.level < job.firstLevel)
+                {
+                    m_stats.textures++;
+                    m_jobs.pop_front();
+                }
+            }
+        }
+        return used;
+    }
+
+    static void upload(GLuint buffer, const Chunk& chunk)
+    {
+        glBindTexture(chunk.bindTarget, chunk.textureID);
+        if (chunk.startJob)
+        {
+            // 还没有上传的级别不参与采样：只使用 BASE_LEVEL 到 MAX_LEVEL
+            glTexParameteri(chunk.bindTarget, GL_TEXTURE_MAX_LEVEL, chunk.levelCount - 1);
+            if (chunk.bindTarget == GL_TEXTURE_2D)
+            {
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, chunk.levelCount - 1);
+                SetTextureSampling2D();
+            }
+        }
+
+        const void* offset = reinterpret_cast<const void*>(chunk.offset);
+        bool wholeLevel = chunk.y == 0 && chunk.rows == chunk.height;
+        if (wholeLevel)
+        {
+            if (chunk.compressed)
+                glCompressedTexImage2D(chunk.imageTarget, chunk.level, chunk.internalFormat, chunk.width, chunk.height,
+                                       0, static_cast<GLsizei>(chunk.bytes), offset);
+            else
+                glTexImage2D(chunk.imageTarget, chunk.level, chunk.internalFormat, chunk.width, chunk.height, 0,
+                             chunk.format, GL_UNSIGNED_BYTE, offset);
+        }
+        else
+        {
+            // 分多帧上传的级别：第一次先分配存储（不能绑定 PBO，否则空指针被当作偏移）
+            if (chunk.y == 0)
+            {
+                glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+                if (chunk.compressed)
+                    glCompressedTexImage2D(chunk.imageTarget, chunk.level, chunk.internalFormat, chunk.width,
+                                           chunk.height, 0, static_cast<GLsizei>(chunk.levelBytes), nullptr);
+                else
+                    glTexImage2D(chunk.imageTarget, chunk.level, chunk.internalFormat, chunk.width, chunk.height, 0,
+                                 chunk.format, GL_UNSIGNED_BYTE, nullptr);
+                glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer);
+            }
+            if (chunk.compressed)
+                glCompressedTexSubImage2D(chunk.imageTarget, chunk.level, 0, chunk.y, chunk.width, chunk.rows,
+                                          chunk.internalFormat, static_cast<GLsizei>(chunk.bytes), offset);
+            else
+                glTexSubImage2D(chunk.imageTarget, chunk.level, 0, chunk.y, chunk.width, chunk.rows, chunk.format,
+                                GL_UNSIGNED_BYTE, offset);
+        }
+
+        if (chunk.levelComplete && chunk.bindTarget == GL_TEXTURE_2D)
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, chunk.level);
+    }
+
+    std::deque<Job> m_jobs;
+    Slot m_slots[RING_SIZE];
+    size_t m_budget;                                    // 每帧（每个 PBO）的字节数
+    bool m_persistent;
+    unsigned int m_frame;
+    Stats m_stats;
+};
@@ -0,0 +1,69 @@
+// ============================================================================
+// 纹理上传的公共函数：内部格式、采样参数、上传 CPU 生成的 mip 链
+// ============================================================================
+// TextureLoader 和 TextureStreamer 共用，需要 OpenGL 上下文
+// ============================================================================
+
+#pragma once
+
+#include <glad/glad.h>
+
+#include "mip_generator.h"
+#include "texture_flags.h"
+
+// ============================================================================
+// 上传 CPU 生成的 mip 链（需要 OpenGL 上下文）
+// ============================================================================
+// nrComponents 是图片本来的通道数，决定内部格式；chain 的通道数可以更多
+// （RGB 图片展开为 RGBA 以使用 SIMD 滤波，多出的 alpha 在上传时丢弃）
+// flags 中有 TEXTURE_FLAG_SRGB 时 RGB/RGBA 图片使用 sRGB 内部格式，采样时由硬件转换到线性空间
+// ============================================================================
+inline GLenum TextureDataFormat(int nrComponents)
+{
+    if (nrComponents == 1)
+        return GL_RED;
+    if (nrComponents == 2)
+        return GL_RG;
+    if (nrComponents == 4)
+        return GL_RGBA;
+    return GL_RGB;
+}
+
+inline GLenum TextureInternalFormat(int nrComponents, unsigned int flags)
+{
+    bool srgb = (flags & TEXTURE_FLAG_SRGB) != 0;
+    if (nrComponents == 1)
+        return GL_R8;
+    if (nrComponents == 2)
+        return GL_RG8;
+    if (nrComponents == 4)
+        return srgb ? GL_SRGB8_ALPHA8 : GL_RGBA8;
+    return srgb ? GL_SRGB8 : GL_RGB8;
+}
+
+inline void SetTextureSampling2D()
+{
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+}
+
+inline void UploadTextureChain(unsigned int textureID, const MipChain& chain, int nrComponents, unsigned int flags)
+{
+    GLenum internalFormat = TextureInternalFormat(nrComponents, flags);
+    GLenum format = TextureDataFormat(chain.components);
+
+    // 每行的字节数不一定是 4 的倍数（单通道或 RGB 图片）
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glBindTexture(GL_TEXTURE_2D, textureID);
+    for (size_t level = 0; level < chain.levels.size(); level++)
+    {
+        const MipChain::Level& info = chain.levels[level];
+        glTexImage2D(GL_TEXTURE_2D, static_cast<GLint>(level), internalFormat, info.width, info.height, 0, format,
+                     GL_UNSIGNED_BYTE, chain.level(level));
+    }
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, static_cast<GLint>(chain.levels.size()) - 1);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    SetTextureSampling2D();
+}
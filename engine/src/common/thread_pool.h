@@ -0,0 +1,172 @@
+// ============================================================================
+// ThreadPool - 加载资源用的工作线程池
+// ============================================================================
+// 模型导入、纹理解码这类 CPU 工作互不相关，可以分给多个线程并行执行，
+// 只有调用 OpenGL 的部分留在有上下文的主线程上
+//
+// parallelFor(count, fn) 把 fn(0) ... fn(count - 1) 分给工作线程执行，
+// 调用线程也参与，全部完成后返回；工作线程中再调用 parallelFor 也不会死锁
+// submit(task) 提交一个任务后立即返回，完成的通知由任务自己负责
+//
+// 线程数：环境变量 OPENGL_WORKER_THREADS，默认 CPU 核数 - 1（加上调用线程正好用满）；
+// 设置为 0 时所有工作都在调用线程上串行执行（用于对比）
+// ============================================================================
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdlib>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+class ThreadPool
+{
+public:
+    // 全局线程池（第一次使用时创建）
+    static ThreadPool& Instance()
+    {
+        static ThreadPool s_instance(defaultThreadCount());
+        return s_instance;
+    }
+
+    explicit ThreadPool(unsigned int threads) : m_stopping(false)
+    {
+        for (unsigned int i = 0; i < threads; i++)
+            m_workers.emplace_back(&ThreadPool::workerMain, this);
+    }
+
+    ~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopping = true;
+        }
+        m_wake.notify_all();
+        for (std::thread& worker : m_workers)
+            worker.join();
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // 工作线程数（不包括调用线程）
+    size_t size() const { return m_workers.size(); }
+
+    // ========================================================================
+    // 并行执行 fn(i)，i 从 0 到 count - 1，返回时全部执行完毕
+    // ========================================================================
+    // 各次调用的耗时可以相差很大（比如大小不一的网格），所以不预先分块，
+    // 每个线程执行完一个再领下一个
+    // ========================================================================
+    void parallelFor(size_t count, const std::function<void(size_t)>& fn)
+    {
+        if (count == 0)
+            return;
+        if (m_workers.empty() || count == 1)
+        {
+            for (size_t i = 0; i < count; i++)
+                fn(i);
+            return;
+        }
+
+        // 没轮到执行的辅助任务可能在 parallelFor 返回之后才开始，所以共享状态用 shared_ptr
+        auto job = std::make_shared<Job>(fn, count);
+        size_t helpers = std::min(m_workers.size(), count - 1);
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            for (size_t i = 0; i < helpers; i++)
+                m_tasks.push_back([job] { job->run(); });
+        }
+        m_wake.notify_all();
+
+        job->run();
+
+        std::unique_lock<std::mutex> lock(job->mutex);
+        job->done.wait(lock, [&] { return job->finished == job->count; });
+    }
+
+    // ========================================================================
+    // 提交一个任务，立即返回（没有工作线程时在调用线程上直接执行）
+    // ========================================================================
+    void submit(std::function<void()> task)
+    {
+        if (m_workers.empty())
+        {
+            task();
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_tasks.push_back(std::move(task));
+        }
+        m_wake.notify_one();
+    }
+
+private:
+    struct Job {
+        Job(const std::function<void(size_t)>& fn, size_t count)
+            : fn(fn), count(count), next(0), finished(0) {}
+
+        // 领取并执行，直到没有剩下的
+        void run()
+        {
+            size_t executed = 0;
+            for (size_t i = next++; i < count; i = next++)
+            {
+                fn(i);
+                executed++;
+            }
+            if (executed == 0)
+                return;
+            std::lock_guard<std::mutex> lock(mutex);
+            finished += executed;
+            if (finished == count)
+                done.notify_all();
+        }
+
+        std::function<void(size_t)> fn;   // 只在 finished < count 时使用
+        size_t count;
+        std::atomic<size_t> next;
+        size_t finished;                   // 由 mutex 保护
+        std::mutex mutex;
+        std::condition_variable done;
+    };
+
+    static unsigned int defaultThreadCount()
+    {
+        if (const char* value = std::getenv("OPENGL_WORKER_THREADS"))
+            return static_cast<unsigned int>(std::max(0, std::atoi(value)));
+        unsigned int cores = std::thread::hardware_concurrency();
+        return cores > 1 ? cores - 1 : 0;
+    }
+
+    void workerMain()
+    {
+        for (;;)
+        {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_wake.wait(lock, [this] { return m_stopping || !m_tasks.empty(); });
+                if (m_tasks.empty())
+                    return;
+                task = std::move(m_tasks.front());
+                m_tasks.pop_front();
+            }
+            task();
+        }
+    }
+
+    std::vector<std::thread> m_workers;
+    std::mutex m_mutex;                          // 保护下面的成员
+    std::condition_variable m_wake;
+    std::deque<std::function<void()>> m_tasks;
+    bool m_stopping;
+};
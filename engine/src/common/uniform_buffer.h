@@ -0,0 +1,196 @@
+// ============================================================================
+// UniformBuffer 模板 - Uniform 缓冲对象（UBO）
+// ============================================================================
+// 相机矩阵、光源参数等数据对所有着色器都一样，如果用普通 uniform，每个着色器
+// 程序都要单独上传一遍。UBO 把这些数据放在一块缓冲里，每帧上传一次，
+// 绑定到固定的绑定点后，所有着色器程序都直接读取它
+//
+// C++ 结构体必须和 GLSL 中 layout (std140) 的内存布局完全一致，
+// 所以每个结构体都用 STD140_MEMBER 在编译期检查成员偏移
+// ============================================================================
+
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <cstddef>  // for offsetof
+#include <cstring>
+
+// ============================================================================
+// 固定的绑定点（Shader 链接后会自动把同名的 uniform 块绑定到这里）
+// ============================================================================
+enum UniformBlockBinding : GLuint {
+    FRAME_DATA_BINDING = 0,   // uniform FrameData
+    LIGHT_DATA_BINDING = 1,   // uniform LightData
+};
+
+// ============================================================================
+// std140 对齐规则（基本对齐）
+// ============================================================================
+//   float / int     : 4
+//   vec2            : 8
+//   vec3 / vec4     : 16
+//   mat3 / mat4     : 16（按列，每列占一个 vec4）
+// ============================================================================
+template <typename T> struct Std140Alignment;
+template <> struct Std140Alignment<float>     { static const size_t value = 4; };
+template <> struct Std140Alignment<int>       { static const size_t value = 4; };
+template <> struct Std140Alignment<glm::vec2> { static const size_t value = 8; };
+template <> struct Std140Alignment<glm::vec3> { static const size_t value = 16; };
+template <> struct Std140Alignment<glm::vec4> { static const size_t value = 16; };
+template <> struct Std140Alignment<glm::mat4> { static const size_t value = 16; };
+
+// 检查成员偏移是否等于 std140 布局中的偏移，并且满足 std140 对齐
+#define STD140_MEMBER(Type, member, expectedOffset)                                          \
+    static_assert(offsetof(Type, member) == (expectedOffset),                                \
+                  #Type "::" #member " does not match its std140 offset");                   \
+    static_assert((expectedOffset) % Std140Alignment<decltype(Type::member)>::value == 0,    \
+                  #Type "::" #member " violates std140 alignment")
+
+// ============================================================================
+// FrameData - 每帧数据（绑定点 0）
+// ============================================================================
+// 对应的 GLSL：
+//   layout (std140) uniform FrameData {
+//       mat4 view;
+//       mat4 projection;
+//       vec3 viewPos;
+//       float time;
+//   };
+// ============================================================================
+struct FrameData {
+    glm::mat4 view;          // 视图矩阵
+    glm::mat4 projection;    // 投影矩阵
+    glm::vec3 viewPos;       // 相机位置（世界空间）
+    float time;              // 时间（秒），紧跟在 vec3 后面，填满 16 字节
+};
+STD140_MEMBER(FrameData, view, 0);
+STD140_MEMBER(FrameData, projection, 64);
+STD140_MEMBER(FrameData, viewPos, 128);
+STD140_MEMBER(FrameData, time, 140);
+static_assert(sizeof(FrameData) == 144, "FrameData size does not match std140");
+
+// ============================================================================
+// LightData - 光源数据（绑定点 1）
+// ============================================================================
+// 同时覆盖方向光、点光源和聚光灯，每个 vec3 后面跟一个 float 填满 16 字节
+// 对应的 GLSL（实例名 light，所以着色器中仍然写 light.position 等）：
+//   layout (std140) uniform LightData {
+//       vec3 position;   float cutOff;
+//       vec3 direction;  float outerCutOff;
+//       vec3 ambient;    float constant;
+//       vec3 diffuse;    float linear;
+//       vec3 specular;   float quadratic;
+//   } light;
+// ============================================================================
+struct LightData {
+    glm::vec3 position;      // 光源位置（点光源、聚光灯）
+    float cutOff;            // 内角余弦值（聚光灯）
+    glm::vec3 direction;     // 光源方向（方向光、聚光灯）
+    float outerCutOff;       // 外角余弦值（聚光灯）
+    glm::vec3 ambient;       // 环境光颜色
+    float constant;          // 衰减常数项
+    glm::vec3 diffuse;       // 漫反射颜色
+    float linear;            // 衰减线性项
+    glm::vec3 specular;      // 镜面反射颜色
+    float quadratic;         // 衰减二次项
+};
+STD140_MEMBER(LightData, position, 0);
+STD140_MEMBER(LightData, cutOff, 12);
+STD140_MEMBER(LightData, direction, 16);
+STD140_MEMBER(LightData, outerCutOff, 28);
+STD140_MEMBER(LightData, ambient, 32);
+STD140_MEMBER(LightData, constant, 44);
+STD140_MEMBER(LightData, diffuse, 48);
+STD140_MEMBER(LightData, linear, 60);
+STD140_MEMBER(LightData, specular, 64);
+STD140_MEMBER(LightData, quadratic, 76);
+static_assert(sizeof(LightData) == 80, "LightData size does not match std140");
+
+// ============================================================================
+// 把程序中的标准 uniform 块绑定到固定绑定点
+// ============================================================================
+// GLSL 330 不支持 layout (binding = N)，所以在链接后按块名设置
+// ============================================================================
+inline void BindStandardUniformBlocks(GLuint program)
+{
+    GLuint frameIndex = glGetUniformBlockIndex(program, "FrameData");
+    if (frameIndex != GL_INVALID_INDEX)
+        glUniformBlockBinding(program, frameIndex, FRAME_DATA_BINDING);
+
+    GLuint lightIndex = glGetUniformBlockIndex(program, "LightData");
+    if (lightIndex != GL_INVALID_INDEX)
+        glUniformBlockBinding(program, lightIndex, LIGHT_DATA_BINDING);
+}
+
+// ============================================================================
+// UniformBuffer 模板
+// ============================================================================
+template <typename T>
+class UniformBuffer
+{
+public:
+    UniformBuffer() : m_ubo(0), m_binding(0), m_valid(false) {}
+    ~UniformBuffer() { destroy(); }
+
+    UniformBuffer(const UniformBuffer&) = delete;
+    UniformBuffer& operator=(const UniformBuffer&) = delete;
+
+    // ========================================================================
+    // 创建缓冲并绑定到绑定点（需要当前有 OpenGL 上下文）
+    // ========================================================================
+    void create(GLuint binding)
+    {
+        destroy();
+        m_binding = binding;
+        glGenBuffers(1, &m_ubo);
+        glBindBuffer(GL_UNIFORM_BUFFER, m_ubo);
+        glBufferData(GL_UNIFORM_BUFFER, sizeof(T), NULL, GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+        bind();
+    }
+
+    // ========================================================================
+    // 释放缓冲（必须在 OpenGL 上下文销毁之前调用）
+    // ========================================================================
+    void destroy()
+    {
+        if (m_ubo)
+        {
+            glDeleteBuffers(1, &m_ubo);
+            m_ubo = 0;
+        }
+        m_valid = false;
+    }
+
+    // 重新绑定到绑定点（其他代码改动了该绑定点时使用）
+    void bind() const
+    {
+        glBindBufferBase(GL_UNIFORM_BUFFER, m_binding, m_ubo);
+    }
+
+    // ========================================================================
+    // 上传数据（和上次相同则跳过）
+    // ========================================================================
+    void update(const T& data)
+    {
+        if (m_valid && std::memcmp(&m_shadow, &data, sizeof(T)) == 0)
+            return;
+
+        glBindBuffer(GL_UNIFORM_BUFFER, m_ubo);
+        glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(T), &data);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+        m_shadow = data;
+        m_valid = true;
+    }
+
+    bool isCreated() const { return m_ubo != 0; }
+    GLuint getID() const { return m_ubo; }
+
+private:
+    GLuint m_ubo;       // 缓冲对象 ID
+    GLuint m_binding;   // 绑定点
+    T m_shadow;         // 上次上传的数据
+    bool m_valid;       // m_shadow 是否有效
+};
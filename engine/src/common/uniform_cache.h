@@ -0,0 +1,282 @@
+// ============================================================================
+// Uniform 位置缓存
+// ============================================================================
+// glGetUniformLocation 每次都要让驱动做一次字符串查找，在每帧、每个物体都要
+// 设置 uniform 的循环里开销很明显。这里在着色器链接后一次性枚举所有活动
+// uniform（glGetActiveUniform），把名字的哈希值和位置存进一个开放寻址的
+// 扁平哈希表，之后的查找不再调用驱动，也不需要构造 std::string
+// ============================================================================
+
+#pragma once
+
+#include <glad/glad.h>
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// ============================================================================
+// 编译期字符串哈希（FNV-1a 32 位）
+// ============================================================================
+constexpr uint32_t HashUniformName(std::string_view name)
+{
+    uint32_t hash = 2166136261u;
+    for (char c : name)
+    {
+        hash ^= static_cast<uint8_t>(c);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+// ============================================================================
+// UniformName - 带预计算哈希值的 uniform 名称
+// ============================================================================
+// 可以由字符串字面量、std::string 隐式构造
+// 对于热点代码，可以声明为 static constexpr，让哈希在编译期算好：
+//   static constexpr UniformName MODEL("model");
+// ============================================================================
+struct UniformName {
+    std::string_view name;
+    uint32_t hash;
+
+    constexpr UniformName(const char* str) : name(str), hash(HashUniformName(name)) {}
+    constexpr UniformName(std::string_view str) : name(str), hash(HashUniformName(str)) {}
+    UniformName(const std::string& str) : name(str), hash(HashUniformName(name)) {}
+};
+
+// ============================================================================
+// UniformHandle - 已解析的 uniform 位置
+// ============================================================================
+// 通过 Shader::getUniform() 获取一次，之后在循环中直接使用
+// 找不到的 uniform 位置为 -1（和 glGetUniformLocation 一样，设置时会被忽略）
+// ============================================================================
+struct UniformHandle {
+    GLint location = -1;
+
+    bool valid() const { return location >= 0; }
+};
+
+// ============================================================================
+// UniformCache - 名称哈希 -> 位置 的扁平哈希表（开放寻址，线性探测）
+// ============================================================================
+class UniformCache
+{
+public:
+    // ========================================================================
+    // 从已链接的程序中枚举活动 uniform
+    // ========================================================================
+    void build(GLuint program)
+    {
+        m_entries.clear();
+        m_count = 0;
+        m_maxLocation = -1;
+
+        GLint count = 0;
+        GLint maxLength = 0;
+        glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &count);
+        glGetProgramiv(program, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+
+        // 容量为 2 的幂且至少是元素数的 2 倍（数组会展开为多个元素，先按 count 估计）
+        size_t capacity = 16;
+        while (capacity < static_cast<size_t>(count) * 2)
+            capacity *= 2;
+        m_entries.assign(capacity, Entry());
+
+        std::vector<char> buffer(maxLength > 0 ? maxLength : 1);
+        for (GLint i = 0; i < count; i++)
+        {
+            GLint size = 0;
+            GLenum type = 0;
+            GLsizei length = 0;
+            glGetActiveUniform(program, static_cast<GLuint>(i), static_cast<GLsizei>(buffer.size()),
+                               &length, &size, &type, buffer.data());
+            std::string name(buffer.data(), length);
+
+            // uniform 块中的成员没有位置，跳过
+            GLint location = glGetUniformLocation(program, name.c_str());
+            if (location < 0)
+                continue;
+
+            insert(name, location, type);
+
+            // 数组：驱动返回 "name[0]"，同时注册 "name" 和每个 "name[i]"
+            size_t bracket = name.rfind("[0]");
+            if (size > 1 || (bracket != std::string::npos && bracket + 3 == name.size()))
+            {
+                std::string base = name.substr(0, bracket);
+                insert(base, location, type);
+                for (GLint element = 1; element < size; element++)
+                {
+                    std::string elementName = base + "[" + std::to_string(element) + "]";
+                    insert(elementName, glGetUniformLocation(program, elementName.c_str()), type);
+                }
+            }
+        }
+    }
+
+    // ========================================================================
+    // 查找（不调用驱动、不分配内存）
+    // ========================================================================
+    GLint find(const UniformName& name) const
+    {
+        if (m_entries.empty())
+            return -1;
+
+        size_t mask = m_entries.size() - 1;
+        for (size_t i = name.hash & mask; ; i = (i + 1) & mask)
+        {
+            const Entry& entry = m_entries[i];
+            if (entry.location == EMPTY)
+                return -1;
+            if (entry.hash == name.hash && entry.name == name.name)
+                return entry.location;
+        }
+    }
+
+    size_t size() const { return m_count; }
+
+    // 遍历所有 uniform：func(名称, 位置, 类型 GL_FLOAT_VEC3 等)
+    template <typename Func>
+    void forEach(Func func) const
+    {
+        for (const Entry& entry : m_entries)
+        {
+            if (entry.location != EMPTY)
+                func(entry.name, entry.location, entry.type);
+        }
+    }
+
+    // 最大的 uniform 位置（没有 uniform 时为 -1）
+    GLint maxLocation() const { return m_maxLocation; }
+
+private:
+    static const GLint EMPTY = -2;
+
+    struct Entry {
+        uint32_t hash = 0;
+        GLint location = EMPTY;
+        GLenum type = 0;      // uniform 类型（数组为元素类型）
+        std::string name;     // 用于处理哈希冲突
+    };
+
+    void insert(const std::string& name, GLint location, GLenum type)
+    {
+        if (location < 0)
+            return;
+        if (location > m_maxLocation)
+            m_maxLocation = location;
+
+        // 负载因子超过 1/2 时扩容
+        if ((m_count + 1) * 2 > m_entries.size())
+            grow();
+
+        uint32_t hash = HashUniformName(name);
+        size_t mask = m_entries.size() - 1;
+        for (size_t i = hash & mask; ; i = (i + 1) & mask)
+        {
+            Entry& entry = m_entries[i];
+            if (entry.location == EMPTY)
+            {
+                entry.hash = hash;
+                entry.location = location;
+                entry.type = type;
+                entry.name = name;
+                m_count++;
+                return;
+            }
+            if (entry.hash == hash && entry.name == name)
+                return;
+        }
+    }
+
+    void grow()
+    {
+        std::vector<Entry> old;
+        old.swap(m_entries);
+        m_entries.assign(old.empty() ? 16 : old.size() * 2, Entry());
+        m_count = 0;
+        for (const Entry& entry : old)
+        {
+            if (entry.location != EMPTY)
+                insert(entry.name, entry.location, entry.type);
+        }
+    }
+
+    std::vector<Entry> m_entries;
+    size_t m_count = 0;
+    GLint m_maxLocation = -1;
+};
+
+// ============================================================================
+// UniformStats - 冗余 uniform 上传统计
+// ============================================================================
+struct UniformStats {
+    uint64_t hits = 0;     // 值未变化、跳过上传的次数
+    uint64_t misses = 0;   // 实际上传的次数
+};
+
+// ============================================================================
+// UniformShadow - 每个 uniform 上次上传值的 CPU 端副本
+// ============================================================================
+// 以 uniform 位置为下标的数组，每个槽位最多保存一个 mat4（64 字节）
+// uniform 值是程序对象的状态，所以每个着色器程序各有一份
+// ============================================================================
+class UniformShadow
+{
+public:
+    // 重新分配槽位（程序重新链接后调用，之前的值全部作废）
+    void reset(GLint maxLocation)
+    {
+        m_slots.assign(maxLocation >= 0 ? static_cast<size_t>(maxLocation) + 1 : 0, Slot());
+    }
+
+    // 记录新值，返回 true 表示值发生了变化、需要调用 glUniform*
+    bool update(GLint location, const void* data, size_t bytes)
+    {
+        // 不存在的 uniform：glUniform*(-1, ...) 本来就是空操作
+        if (location < 0)
+            return false;
+
+        if (static_cast<size_t>(location) >= m_slots.size() || bytes > sizeof(Slot::data))
+        {
+            m_stats.misses++;
+            return true;
+        }
+
+        Slot& slot = m_slots[location];
+        if (slot.size == bytes && std::memcmp(slot.data, data, bytes) == 0)
+        {
+            m_stats.hits++;
+            return false;
+        }
+
+        std::memcpy(slot.data, data, bytes);
+        slot.size = static_cast<uint32_t>(bytes);
+        m_stats.misses++;
+        return true;
+    }
+
+    // 取出某个位置上次上传的值，还没有上传过返回 nullptr
+    const void* get(GLint location, size_t& bytes) const
+    {
+        if (location < 0 || static_cast<size_t>(location) >= m_slots.size() || m_slots[location].size == 0)
+            return nullptr;
+        bytes = m_slots[location].size;
+        return m_slots[location].data;
+    }
+
+    const UniformStats& stats() const { return m_stats; }
+    void resetStats() { m_stats = UniformStats(); }
+
+private:
+    struct Slot {
+        float data[16];      // 最大为 mat4
+        uint32_t size = 0;   // 0 表示还没有上传过
+    };
+
+    std::vector<Slot> m_slots;
+    UniformStats m_stats;
+};
@@ -0,0 +1,308 @@
+// ============================================================================
+// 顶点格式 - 完整的 float 格式和压缩（量化）格式
+// ============================================================================
+// Vertex 结构体每个顶点 88 字节：法线、切线、副切线各 3 个 float，
+// 再加上 4 个 int + 4 个 float 的骨骼数据，即使是没有骨骼动画的静态模型也一样。
+// 顶点多的模型大部分显存和带宽都花在这些用不到的精度上。
+//
+// 压缩格式（VERTEX_FORMAT_PACKED / VERTEX_FORMAT_QUANTIZED）：
+//   位置      3 x float（12 字节），或按网格包围盒量化为 4 x unorm16（8 字节）
+//   法线      八面体编码，2 x snorm16（4 字节）
+//   纹理坐标  2 x half（4 字节）
+//   切线      八面体编码 2 x snorm8 + 副切线方向符号（4 字节），副切线在着色器中重建
+//   骨骼      只有网格带骨骼权重时才存储：索引 4 x uint8/uint16，权重 4 x unorm8
+// 静态网格每个顶点 20 字节（量化）或 24 字节，约为原来的 1/4
+//
+// 着色器需要定义 PACKED_VERTEX 并包含 common/shaders/vertex_input.glsl，
+// 用 vertexPosition()/vertexNormal() 等函数读取顶点数据（见该文件）
+// ============================================================================
+
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/packing.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>  // for offsetof
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#define MAX_BONE_INFLUENCE 4
+
+// ============================================================================
+// Vertex 结构体 - 顶点数据
+// ============================================================================
+struct Vertex {
+    glm::vec3 Position;    // 位置
+    glm::vec3 Normal;      // 法线
+    glm::vec2 TexCoords;   // 纹理坐标
+    glm::vec3 Tangent;     // 切线
+    glm::vec3 Bitangent;   // 副切线
+    int m_BoneIDs[MAX_BONE_INFLUENCE];  // 骨骼索引（用于骨骼动画）
+    float m_Weights[MAX_BONE_INFLUENCE]; // 骨骼权重（用于骨骼动画）
+};
+
+// ============================================================================
+// 顶点格式
+// ============================================================================
+enum VertexFormat {
+    VERTEX_FORMAT_FLOAT,       // 原样上传 Vertex（默认，着色器不需要任何修改）
+    VERTEX_FORMAT_PACKED,      // 压缩格式，位置保持 float
+    VERTEX_FORMAT_QUANTIZED    // 压缩格式，位置按包围盒量化为 unorm16
+};
+
+// ============================================================================
+// 压缩格式的布局（每个网格根据自己的数据计算）
+// ============================================================================
+struct PackedVertexLayout {
+    bool quantized = false;        // 位置是否量化
+    bool hasBones = false;         // 是否存储骨骼数据
+    bool wideBoneIds = false;      // 骨骼索引是否需要 uint16（超过 255）
+    GLsizei stride = 0;            // 每个顶点的字节数
+    unsigned int normalOffset = 0;
+    unsigned int texCoordsOffset = 0;
+    unsigned int tangentOffset = 0;
+    unsigned int boneIdsOffset = 0;
+    unsigned int weightsOffset = 0;
+
+    // 反量化参数：着色器中 位置 = aPos * positionScale + positionOffset
+    // （不量化时为 1 和 0）
+    glm::vec3 positionScale = glm::vec3(1.0f);
+    glm::vec3 positionOffset = glm::vec3(0.0f);
+};
+
+class VertexPacker
+{
+public:
+    // ========================================================================
+    // 根据顶点数据计算布局（包围盒、是否有骨骼、骨骼索引范围）
+    // ========================================================================
+    static PackedVertexLayout makeLayout(const std::vector<Vertex>& vertices, bool quantize)
+    {
+        PackedVertexLayout layout;
+        layout.quantized = quantize;
+
+        int maxBoneId = 0;
+        glm::vec3 minimum(0.0f), maximum(0.0f);
+        for (size_t i = 0; i < vertices.size(); i++)
+        {
+            const Vertex& vertex = vertices[i];
+            minimum = i ? glm::min(minimum, vertex.Position) : vertex.Position;
+            maximum = i ? glm::max(maximum, vertex.Position) : vertex.Position;
+            for (int j = 0; j < MAX_BONE_INFLUENCE; j++)
+            {
+                if (vertex.m_Weights[j] > 0.0f)
+                {
+                    layout.hasBones = true;
+                    maxBoneId = std::max(maxBoneId, vertex.m_BoneIDs[j]);
+                }
+            }
+        }
+        layout.wideBoneIds = maxBoneId > 255;
+
+        if (quantize)
+        {
+            layout.positionOffset = minimum;
+            // 某个方向厚度为 0 时（例如平面），任何比例都能还原出同一个值
+            layout.positionScale = glm::max(maximum - minimum, glm::vec3(1e-6f));
+        }
+
+        unsigned int offset = quantize ? 4 * sizeof(uint16_t) : 3 * sizeof(float);
+        layout.normalOffset = offset;     offset += 2 * sizeof(int16_t);
+        layout.texCoordsOffset = offset;  offset += 2 * sizeof(uint16_t);
+        layout.tangentOffset = offset;    offset += 4 * sizeof(int8_t);
+        if (layout.hasBones)
+        {
+            layout.boneIdsOffset = offset;
+            offset += MAX_BONE_INFLUENCE * (layout.wideBoneIds ? sizeof(uint16_t) : sizeof(uint8_t));
+            layout.weightsOffset = offset;
+            offset += MAX_BONE_INFLUENCE * sizeof(uint8_t);
+        }
+        layout.stride = static_cast<GLsizei>(offset);
+        return layout;
+    }
+
+    // ========================================================================
+    // 按布局把顶点打包成字节数组（直接用于 glBufferData）
+    // ========================================================================
+    static std::vector<unsigned char> pack(const std::vector<Vertex>& vertices, const PackedVertexLayout& layout)
+    {
+        std::vector<unsigned char> data(vertices.size() * layout.stride);
+        for (size_t i = 0; i < vertices.size(); i++)
+        {
+            const Vertex& vertex = vertices[i];
+            unsigned char* out = data.data() + i * layout.stride;
+
+            // 位置
+            if (layout.quantized)
+            {
+                glm::vec3 unit = (vertex.Position - layout.positionOffset) / layout.positionScale;
+                uint16_t position[4] = { unorm16(unit.x), unorm16(unit.y), unorm16(unit.z), 0 };
+                std::memcpy(out, position, sizeof(position));
+            }
+            else
+            {
+                std::memcpy(out, &vertex.Position, sizeof(vertex.Position));
+            }
+
+            // 法线（八面体编码，16 位精度）
+            uint32_t normal = glm::packSnorm2x16(octEncode(vertex.Normal));
+            std::memcpy(out + layout.normalOffset, &normal, sizeof(normal));
+
+            // 纹理坐标（half 可以表示重复平铺用的大于 1 的坐标）
+            uint32_t texCoords = glm::packHalf2x16(vertex.TexCoords);
+            std::memcpy(out + layout.texCoordsOffset, &texCoords, sizeof(texCoords));
+
+            // 切线（八面体编码，8 位精度足够）+ 副切线方向 = sign(dot(cross(N, T), B))
+            float handedness = glm::dot(glm::cross(vertex.Normal, vertex.Tangent), vertex.Bitangent) < 0.0f ? -1.0f : 1.0f;
+            glm::vec2 tangent = octEncode(vertex.Tangent);
+            uint32_t tangentFrame = glm::packSnorm4x8(glm::vec4(tangent, handedness, 0.0f));
+            std::memcpy(out + layout.tangentOffset, &tangentFrame, sizeof(tangentFrame));
+
+            if (layout.hasBones)
+                packBones(vertex, layout, out);
+        }
+        return data;
+    }
+
+    // ========================================================================
+    // 设置压缩格式的顶点属性指针（需要绑定好 VAO 和 VBO）
+    // ========================================================================
+    // 属性位置和 float 格式相同（0 位置、1 法线、2 纹理坐标、3 切线、5 骨骼索引、6 权重），
+    // 4（副切线）不再使用
+    // ========================================================================
+    static void setupAttributes(const PackedVertexLayout& layout)
+    {
+        GLsizei stride = layout.stride;
+
+        // 位置：unorm16 归一化到 [0, 1]，在着色器里反量化
+        glEnableVertexAttribArray(0);
+        if (layout.quantized)
+            glVertexAttribPointer(0, 3, GL_UNSIGNED_SHORT, GL_TRUE, stride, (void*)0);
+        else
+            glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, (void*)0);
+
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(1, 2, GL_SHORT, GL_TRUE, stride, (void*)(uintptr_t)layout.normalOffset);
+
+        glEnableVertexAttribArray(2);
+        glVertexAttribPointer(2, 2, GL_HALF_FLOAT, GL_FALSE, stride, (void*)(uintptr_t)layout.texCoordsOffset);
+
+        glEnableVertexAttribArray(3);
+        glVertexAttribPointer(3, 4, GL_BYTE, GL_TRUE, stride, (void*)(uintptr_t)layout.tangentOffset);
+
+        if (layout.hasBones)
+        {
+            glEnableVertexAttribArray(5);
+            glVertexAttribIPointer(5, 4, layout.wideBoneIds ? GL_UNSIGNED_SHORT : GL_UNSIGNED_BYTE,
+                                   stride, (void*)(uintptr_t)layout.boneIdsOffset);
+
+            glEnableVertexAttribArray(6);
+            glVertexAttribPointer(6, 4, GL_UNSIGNED_BYTE, GL_TRUE, stride, (void*)(uintptr_t)layout.weightsOffset);
+        }
+    }
+
+    // ========================================================================
+    // 八面体编码：把单位向量映射到 [-1, 1]^2 的正方形（解码见 vertex_input.glsl）
+    // ========================================================================
+    static glm::vec2 octEncode(glm::vec3 n)
+    {
+        float length = std::abs(n.x) + std::abs(n.y) + std::abs(n.z);
+        if (length <= 0.0f)
+            return glm::vec2(0.0f);    // 零向量（例如没有切线）解码为 +Z
+        n /= length;
+
+        glm::vec2 result(n.x, n.y);
+        if (n.z < 0.0f)
+        {
+            // 下半球折叠到四个角上
+            result.x = (1.0f - std::abs(n.y)) * (n.x >= 0.0f ? 1.0f : -1.0f);
+            result.y = (1.0f - std::abs(n.x)) * (n.y >= 0.0f ? 1.0f : -1.0f);
+        }
+        return result;
+    }
+
+private:
+    static uint16_t unorm16(float value)
+    {
+        return static_cast<uint16_t>(std::lround(glm::clamp(value, 0.0f, 1.0f) * 65535.0f));
+    }
+
+    // 骨骼权重量化到 unorm8 之后和仍然为 255（误差加到最大的权重上）
+    static void packBones(const Vertex& vertex, const PackedVertexLayout& layout, unsigned char* out)
+    {
+        uint8_t weights[MAX_BONE_INFLUENCE];
+        uint16_t ids[MAX_BONE_INFLUENCE];
+        float total = 0.0f;
+        for (int j = 0; j < MAX_BONE_INFLUENCE; j++)
+            total += std::max(vertex.m_Weights[j], 0.0f);
+
+        int sum = 0, largest = 0;
+        for (int j = 0; j < MAX_BONE_INFLUENCE; j++)
+        {
+            float weight = total > 0.0f ? std::max(vertex.m_Weights[j], 0.0f) / total : 0.0f;
+            weights[j] = static_cast<uint8_t>(std::lround(weight * 255.0f));
+            ids[j] = static_cast<uint16_t>(std::max(vertex.m_BoneIDs[j], 0));
+            sum += weights[j];
+            if (weights[j] > weights[largest])
+                largest = j;
+        }
+        if (total > 0.0f)
+            weights[largest] = static_cast<uint8_t>(weights[largest] + 255 - sum);
+
+        if (layout.wideBoneIds)
+        {
+            std::memcpy(out + layout.boneIdsOffset, ids, sizeof(ids));
+        }
+        else
+        {
+            for (int j = 0; j < MAX_BONE_INFLUENCE; j++)
+                out[layout.boneIdsOffset + j] = static_cast<uint8_t>(ids[j]);
+        }
+        std::memcpy(out + layout.weightsOffset, weights, sizeof(weights));
+    }
+};
+
+// ============================================================================
+// 为当前绑定的 VAO 和 GL_ARRAY_BUFFER 设置顶点属性指针
+// ============================================================================
+inline void SetupVertexAttributes(VertexFormat format, const PackedVertexLayout& layout)
+{
+    // 压缩格式：属性指针使用对应的归一化整数/half 类型
+    if (format != VERTEX_FORMAT_FLOAT)
+    {
+        VertexPacker::setupAttributes(layout);
+        return;
+    }
+
+    // 顶点位置
+    glEnableVertexAttribArray(0);	
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)0);
+    
+    // 顶点法线
+    glEnableVertexAttribArray(1);	
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, Normal));
+    
+    // 顶点纹理坐标
+    glEnableVertexAttribArray(2);	
+    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, TexCoords));
+    
+    // 顶点切线
+    glEnableVertexAttribArray(3);
+    glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, Tangent));
+    
+    // 顶点副切线
+    glEnableVertexAttribArray(4);
+    glVertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, Bitangent));
+    
+    // 骨骼 ID
+    glEnableVertexAttribArray(5);
+    glVertexAttribIPointer(5, 4, GL_INT, sizeof(Vertex), (void*)offsetof(Vertex, m_BoneIDs));
+
+    // 骨骼权重
+    glEnableVertexAttribArray(6);
+    glVertexAttribPointer(6, 4, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, m_Weights));
+}
@@ -2,8 +2,8 @@
 layout (location = 0) in vec3 aPos;      // 输入：顶点位置
 
 uniform mat4 model;                     // 模型矩阵
-uniform mat4 view;                      // 视图矩阵
-uniform mat4 projection;                // 投影矩阵
+
+#include "common/shaders/frame_data.glsl"
 
 void main()
 {
@@ -20,56 +20,16 @@
 #include <string>
 #include "common/camera_application.h"  // CameraApplication 基类
 #include "common/shader.h"               // Shader 类
+#include "common/shader_library.h"       // ShaderLibrary 类（异步编译）
+#include "common/texture_loader.h"       // LoadTextureFile（共享纹理、压缩纹理缓存、CPU mipmap）
 
 // ============================================================================
 // 辅助函数：加载纹理
 // ============================================================================
 static unsigned int loadTexture(const char* path, bool flipVertically = true)
 {
-    unsigned int textureID;
-    glGenTextures(1, &textureID);
-    
-    int width, height, nrChannels;
-    
-    // 设置是否垂直翻转图片
-    stbi_set_flip_vertically_on_load(flipVertically);
-    
-    // 加载图片
-    unsigned char *data = stbi_load(path, &width, &height, &nrChannels, 0);
-    
-    if (data)
-    {
-        // 根据通道数确定格式
-        GLenum format;
-        if (nrChannels == 1)
-            format = GL_RED;
-        else if (nrChannels == 3)
-            format = GL_RGB;
-        else if (nrChannels == 4)
-            format = GL_RGBA;
-        
-        glBindTexture(GL_TEXTURE_2D, textureID);
-        glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-        glGenerateMipmap(GL_TEXTURE_2D);
-        
-        // 设置纹理参数
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-        
-        // 释放图片数据
-        stbi_image_free(data);
-    }
-    else
-    {
-        std::cout << "Failed to load texture: " << path << std::endl;
-        // 加载失败时，删除已创建的纹理对象并返回 0
-        glDeleteTextures(1, &textureID);
-        return 0;
-    }
-    
-    return textureID;
+    // 共享、压缩纹理缓存和 mipmap 生成见 common/texture_loader.h
+    return LoadTextureFile(path, flipVertically ? TEXTURE_FLAG_FLIP : TEXTURE_FLAG_NONE);
 }
 
 // ============================================================================
@@ -116,14 +76,16 @@ protected:
         // 调用基类初始化（启用鼠标捕获）
         CameraApplication::OnInitialize();
 
-        // 创建着色器程序
-        std::string lightingVertexPath = std::string(PROJECT_ROOT) + "/engine/src/lesson/lesson11/5.1.light_casters.vs";
-        std::string lightingFragmentPath = std::string(PROJECT_ROOT) + "/engine/src/lesson/lesson11/5.1.light_casters.fs";
-        m_lightingShader = new Shader(lightingVertexPath.c_str(), lightingFragmentPath.c_str());
+        // 提交着色器程序（只提交不等待，编译和下面的纹理加载重叠进行）
+        // 光照着色器使用通用的投光物着色器，用宏选择方向光变体
+        std::string lightingVertexPath = std::string(PROJECT_ROOT) + "/engine/src/common/shaders/light_casters.vs";
+        std::string lightingFragmentPath = std::string(PROJECT_ROOT) + "/engine/src/common/shaders/light_casters.fs";
+        m_lightingShader = m_shaders.submit(lightingVertexPath, lightingFragmentPath,
+                                            { "LIGHT_DIRECTIONAL", "HAS_SPECULAR_MAP" });
 
         std::string lightCubeVertexPath = std::string(PROJECT_ROOT) + "/engine/src/lesson/lesson11/5.1.light_cube.vs";
         std::string lightCubeFragmentPath = std::string(PROJECT_ROOT) + "/engine/src/lesson/lesson11/5.1.light_cube.fs";
-        m_lightCubeShader = new Shader(lightCubeVertexPath.c_str(), lightCubeFragmentPath.c_str());
+        m_lightCubeShader = m_shaders.submit(lightCubeVertexPath, lightCubeFragmentPath);
 
         // 设置顶点数据
         SetupVertices();
@@ -131,10 +93,16 @@ protected:
         // 加载纹理
         LoadTextures();
         
+        // 等待着色器编译完成（之后才能设置 uniform）
+        m_shaders.finishAll();
+        
         // 配置着色器（设置纹理单元）
         m_lightingShader->use();
         m_lightingShader->setInt("material.diffuse", 0);   // 纹理单元 0
         m_lightingShader->setInt("material.specular", 1);  // 纹理单元 1
+
+        // 光源参数使用 UBO（绑定点 LIGHT_DATA_BINDING），着色器链接时已自动绑定
+        m_lightData.create(LIGHT_DATA_BINDING);
     }
 
     // ========================================================================
@@ -158,40 +126,28 @@ protected:
         // ====================================================================
         // 渲染被光照的立方体
         // ====================================================================
+        // 上传每帧数据（view、projection、viewPos），所有着色器共享
+        UploadFrameData();
+
         m_lightingShader->use();
         
-        // 设置光源方向（方向光使用方向向量，而不是位置）
-        // 注意：方向向量指向光源，所以在着色器中需要取反
-        m_lightingShader->setVec3("light.direction", -0.2f, -1.0f, -0.3f);
-        m_lightingShader->setVec3("viewPos", m_camera.Position);
-
         // 光源属性
         // 使用光源强度系数和颜色来计算各分量
+        LightData light = {};
+        // 设置光源方向（方向光使用方向向量，而不是位置）
+        // 注意：方向向量指向光源，所以在着色器中需要取反
+        light.direction = glm::vec3(-0.2f, -1.0f, -0.3f);
         // 环境光通常是光源强度的 0.2 倍
-        glm::vec3 ambient = m_lightColor * m_lightIntensity * 0.2f;
+        light.ambient = m_lightColor * m_lightIntensity * 0.2f;
         // 漫反射是光源强度的主要部分（0.5 倍）
-        glm::vec3 diffuse = m_lightColor * m_lightIntensity * 0.5f;
+        light.diffuse = m_lightColor * m_lightIntensity * 0.5f;
         // 镜面反射通常是光源强度的 1.0 倍（高光）
-        glm::vec3 specular = m_lightColor * m_lightIntensity * 1.0f;
-        
-        m_lightingShader->setVec3("light.ambient", ambient);
-        m_lightingShader->setVec3("light.diffuse", diffuse);
-        m_lightingShader->setVec3("light.specular", specular);
+        light.specular = m_lightColor * m_lightIntensity * 1.0f;
+        m_lightData.update(light);
 
         // 材质属性（使用纹理贴图，只需要设置 shininess）
         m_lightingShader->setFloat("material.shininess", 32.0f);
 
-        // 设置投影和视图矩阵
-        glm::mat4 projection = glm::perspective(
-            glm::radians(m_camera.Zoom), 
-            (float)m_width / (float)m_height, 
-            0.1f, 
-            100.0f
-        );
-        glm::mat4 view = m_camera.GetViewMatrix();
-        m_lightingShader->setMat4("projection", projection);
-        m_lightingShader->setMat4("view", view);
-
         // 绑定纹理
         glActiveTexture(GL_TEXTURE0);
         glBindTexture(GL_TEXTURE_2D, m_diffuseMap);
@@ -227,10 +183,10 @@ protected:
         glDeleteVertexArrays(1, &m_cubeVAO);
         glDeleteVertexArrays(1, &m_lightCubeVAO);
         glDeleteBuffers(1, &m_VBO);
-        glDeleteTextures(1, &m_diffuseMap);
-        glDeleteTextures(1, &m_specularMap);
-        delete m_lightingShader;
-        delete m_lightCubeShader;
+        TextureCache::Instance().release(m_diffuseMap);
+        TextureCache::Instance().release(m_specularMap);
+        m_shaders.clear();
+        m_lightData.destroy();
     }
 
 private:
@@ -349,6 +305,9 @@ private:
     // ========================================================================
     Shader* m_lightingShader;      // 光照着色器
     Shader* m_lightCubeShader;     // 光源立方体的着色器（虽然不使用，但保留）
+    ShaderLibrary m_shaders;       // 持有上面两个着色器
+    
+    UniformBuffer<LightData> m_lightData;  // 光源参数 UBO
     
     unsigned int m_cubeVAO;         // 被光照立方体的 VAO
     unsigned int m_lightCubeVAO;    // 光源立方体的 VAO（虽然不使用，但保留）
@@ -2,6 +2,7 @@
 layout (location = 0) in vec3 aPos;      // 输入：顶点位置
 layout (location = 1) in vec3 aNormal;  // 输入：法线向量
 layout (location = 2) in vec2 aTexCoord;// 输入：纹理坐标
+layout (location = 8) in mat4 aInstanceMatrix; // 输入：实例矩阵（网格所在节点的变换，见 common/model.h）
 
 out vec2 TexCoord;                       // 输出：纹理坐标（传递给片段着色器）
 
@@ -15,6 +16,6 @@ void main()
     TexCoord = aTexCoord;
     
     // 应用模型、视图和投影变换
-    gl_Position = projection * view * model * vec4(aPos, 1.0);
+    gl_Position = projection * view * model * aInstanceMatrix * vec4(aPos, 1.0);
 }
 
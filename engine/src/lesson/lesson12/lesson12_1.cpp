@@ -94,6 +94,8 @@ protected:
         model = glm::translate(model, glm::vec3(0.0f, 0.0f, 0.0f)); // 将其向下平移，使其位于场景中心
         model = glm::scale(model, glm::vec3(1.0f, 1.0f, 1.0f));     // 它对于我们的场景来说有点大，所以缩小它
         m_shader->setMat4("model", model);
+        // 模型在屏幕上的大小决定纹理需要的清晰度（见 common/texture_residency.h）
+        m_model->SetScreenSize(model, view, projection, m_height);
         m_model->Draw(*m_shader);
     }
 
@@ -43,10 +43,14 @@ protected:
         // 告诉 stb_image.h 在加载纹理时翻转 y 轴（在加载模型之前）
         stbi_set_flip_vertically_on_load(true);
 
-        // 创建着色器程序
-        std::string vertexPath = std::string(PROJECT_ROOT) + "/engine/src/lesson/lesson12/2.model_loading_point_light.vs";
-        std::string fragmentPath = std::string(PROJECT_ROOT) + "/engine/src/lesson/lesson12/2.model_loading_point_light.fs";
-        m_shader = new Shader(vertexPath.c_str(), fragmentPath.c_str());
+        // 创建着色器程序（通用的投光物着色器，用宏选择点光源变体和模型纹理命名）
+        std::string vertexPath = std::string(PROJECT_ROOT) + "/engine/src/common/shaders/light_casters.vs";
+        std::string fragmentPath = std::string(PROJECT_ROOT) + "/engine/src/common/shaders/light_casters.fs";
+        m_shader = new Shader(vertexPath.c_str(), fragmentPath.c_str(), nullptr,
+                              { "LIGHT_POINT", "HAS_SPECULAR_MAP", "MODEL_TEXTURES", "MODEL_INSTANCES" });
+
+        // 光源参数使用 UBO（绑定点 LIGHT_DATA_BINDING），着色器链接时已自动绑定
+        m_lightData.create(LIGHT_DATA_BINDING);
 
         // 加载模型
         std::string modelPath = std::string(PROJECT_ROOT) + "/engine/assets/models/backpack/backpack.obj";
@@ -78,42 +82,37 @@ protected:
         glClearColor(0.05f, 0.05f, 0.05f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
+        // 上传每帧数据（view、projection、viewPos），所有着色器共享
+        UploadFrameData();
+
         // 激活着色器
         m_shader->use();
 
         // 设置点光源属性
-        m_shader->setVec3("light.position", m_lightPos);
-        m_shader->setVec3("viewPos", m_camera.Position);
+        LightData light = {};
+        light.position = m_lightPos;
 
         // 光源属性
-        m_shader->setVec3("light.ambient", 0.2f, 0.2f, 0.2f);
-        m_shader->setVec3("light.diffuse", 0.5f, 0.5f, 0.5f);
-        m_shader->setVec3("light.specular", 1.0f, 1.0f, 1.0f);
+        light.ambient = glm::vec3(0.2f, 0.2f, 0.2f);
+        light.diffuse = glm::vec3(0.5f, 0.5f, 0.5f);
+        light.specular = glm::vec3(1.0f, 1.0f, 1.0f);
         
         // 衰减系数
-        m_shader->setFloat("light.constant", 1.0f);
-        m_shader->setFloat("light.linear", 0.09f);
-        m_shader->setFloat("light.quadratic", 0.032f);
+        light.constant = 1.0f;
+        light.linear = 0.09f;
+        light.quadratic = 0.032f;
+        m_lightData.update(light);
 
         // 材质属性（shininess）
         m_shader->setFloat("material.shininess", 32.0f);
 
-        // 视图/投影变换
-        glm::mat4 projection = glm::perspective(
-            glm::radians(m_camera.Zoom), 
-            (float)m_width / (float)m_height, 
-            0.1f, 
-            100.0f
-        );
-        glm::mat4 view = m_camera.GetViewMatrix();
-        m_shader->setMat4("projection", projection);
-        m_shader->setMat4("view", view);
-
         // 渲染加载的模型
         glm::mat4 model = glm::mat4(1.0f);
         model = glm::translate(model, glm::vec3(0.0f, 0.0f, 0.0f));
         model = glm::scale(model, glm::vec3(1.0f, 1.0f, 1.0f));
         m_shader->setMat4("model", model);
+        // 模型在屏幕上的大小决定纹理需要的清晰度（见 common/texture_residency.h）
+        m_model->SetScreenSize(model, m_camera.GetViewMatrix(), GetProjectionMatrix(), m_height);
         m_model->Draw(*m_shader);
     }
 
@@ -124,6 +123,7 @@ protected:
     {
         delete m_shader;
         delete m_model;
+        m_lightData.destroy();
     }
 
 private:
@@ -132,6 +132,7 @@ private:
     // ========================================================================
     Shader* m_shader;        // 着色器
     Model* m_model;         // 模型
+    UniformBuffer<LightData> m_lightData;  // 光源参数 UBO
     glm::vec3 m_lightPos;    // 光源位置
 };
 
@@ -19,56 +19,15 @@
 #include <string>
 #include "common/camera_application.h"  // CameraApplication 基类
 #include "common/shader.h"               // Shader 类
+#include "common/texture_loader.h"       // LoadTextureFile（共享纹理、压缩纹理缓存、CPU mipmap）
 
 // ============================================================================
 // 辅助函数：加载纹理
 // ============================================================================
 static unsigned int loadTexture(const char* path, bool flipVertically = true)
 {
-    unsigned int textureID;
-    glGenTextures(1, &textureID);
-    
-    int width, height, nrChannels;
-    
-    // 设置是否垂直翻转图片
-    stbi_set_flip_vertically_on_load(flipVertically);
-    
-    // 加载图片
-    unsigned char *data = stbi_load(path, &width, &height, &nrChannels, 0);
-    
-    if (data)
-    {
-        // 根据通道数确定格式
-        GLenum format;
-        if (nrChannels == 1)
-            format = GL_RED;
-        else if (nrChannels == 3)
-            format = GL_RGB;
-        else if (nrChannels == 4)
-            format = GL_RGBA;
-        
-        glBindTexture(GL_TEXTURE_2D, textureID);
-        glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-        glGenerateMipmap(GL_TEXTURE_2D);
-        
-        // 设置纹理参数
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-        
-        // 释放图片数据
-        stbi_image_free(data);
-    }
-    else
-    {
-        std::cout << "Failed to load texture: " << path << std::endl;
-        // 加载失败时，删除已创建的纹理对象并返回 0
-        glDeleteTextures(1, &textureID);
-        return 0;
-    }
-    
-    return textureID;
+    // 共享、压缩纹理缓存和 mipmap 生成见 common/texture_loader.h
+    return LoadTextureFile(path, flipVertically ? TEXTURE_FLAG_FLIP : TEXTURE_FLAG_NONE);
 }
 
 // ============================================================================
@@ -234,8 +193,8 @@ protected:
         glDeleteVertexArrays(1, &m_planeVAO);
         glDeleteBuffers(1, &m_cubeVBO);
         glDeleteBuffers(1, &m_planeVBO);
-        glDeleteTextures(1, &m_cubeTexture);
-        glDeleteTextures(1, &m_floorTexture);
+        TextureCache::Instance().release(m_cubeTexture);
+        TextureCache::Instance().release(m_floorTexture);
         delete m_normalShader;
         delete m_outlineShader;
     }
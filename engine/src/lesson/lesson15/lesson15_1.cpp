@@ -22,57 +22,28 @@
 #include <algorithm>
 #include "common/camera_application.h"  // CameraApplication 基类
 #include "common/shader.h"               // Shader 类
+#include "common/texture_loader.h"       // LoadTextureFile（共享纹理、压缩纹理缓存、CPU mipmap）
 
 // ============================================================================
 // 辅助函数：加载纹理
 // ============================================================================
-static unsigned int loadTexture(const char* path, bool flipVertically = true)
+// extraFlags：其他 TextureFlags，例如镂空纹理的 TEXTURE_FLAG_ALPHA_TEST（mipmap 保持 alpha 覆盖率）
+// ============================================================================
+static unsigned int loadTexture(const char* path, bool flipVertically = true, unsigned int extraFlags = TEXTURE_FLAG_NONE)
 {
-    unsigned int textureID;
-    glGenTextures(1, &textureID);
-    
-    int width, height, nrChannels;
-    
-    // 设置是否垂直翻转图片
-    stbi_set_flip_vertically_on_load(flipVertically);
-    
-    // 加载图片
-    unsigned char *data = stbi_load(path, &width, &height, &nrChannels, 0);
-    
-    if (data)
+    // 共享、压缩纹理缓存和 mipmap 生成见 common/texture_loader.h
+    // （CPU 生成 mipmap 时按 flags 保持 alpha 覆盖率，见 common/mip_generator.h）
+    unsigned int flags = (flipVertically ? TEXTURE_FLAG_FLIP : TEXTURE_FLAG_NONE) | extraFlags;
+    bool hasAlpha = false;
+    unsigned int textureID = LoadTextureFile(path, flags, &hasAlpha);
+
+    // 对于透明纹理，使用 GL_CLAMP_TO_EDGE 防止边缘半透明（不透明纹理保持 GL_REPEAT）
+    if (hasAlpha)
     {
-        // 根据通道数确定格式
-        GLenum format;
-        if (nrChannels == 1)
-            format = GL_RED;
-        else if (nrChannels == 3)
-            format = GL_RGB;
-        else if (nrChannels == 4)
-            format = GL_RGBA;
-        
         glBindTexture(GL_TEXTURE_2D, textureID);
-        glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-        glGenerateMipmap(GL_TEXTURE_2D);
-        
-        // 设置纹理参数
-        // 对于透明纹理（RGBA），使用 GL_CLAMP_TO_EDGE 防止边缘半透明
-        // 对于不透明纹理，使用 GL_REPEAT
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, format == GL_RGBA ? GL_CLAMP_TO_EDGE : GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, format == GL_RGBA ? GL_CLAMP_TO_EDGE : GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-        
-        // 释放图片数据
-        stbi_image_free(data);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
     }
-    else
-    {
-        std::cout << "Failed to load texture: " << path << std::endl;
-        // 加载失败时，删除已创建的纹理对象并返回 0
-        glDeleteTextures(1, &textureID);
-        return 0;
-    }
-    
     return textureID;
 }
 
@@ -225,7 +196,7 @@ protected:
         glDeleteBuffers(1, &m_transparentVBO);
         glDeleteTextures(1, &m_cubeTexture);
         glDeleteTextures(1, &m_floorTexture);
-        glDeleteTextures(1, &m_transparentTexture);
+        TextureCache::Instance().release(m_transparentTexture);
         delete m_shader;
     }
 
@@ -356,7 +327,7 @@ private:
         
         // 加载透明窗户纹理
         std::string windowPath = std::string(PROJECT_ROOT) + "/engine/assets/texture/lesson/window.png";
-        m_transparentTexture = loadTexture(windowPath.c_str(), true);
+        m_transparentTexture = loadTexture(windowPath.c_str(), true, TEXTURE_FLAG_ALPHA_TEST);
         
         if (m_transparentTexture == 0)
         {
@@ -20,10 +20,45 @@
 #include <vector>
 #include "common/camera_application.h"  // CameraApplication 基类
 #include "common/shader.h"               // Shader 类
+#include "common/shader_library.h"       // ShaderLibrary 类（异步编译）
+#include "common/compressed_texture.h"   // 块压缩纹理缓存
+#include "common/texture_streamer.h"     // TextureStreamer 类（分帧上传）
+#include "common/thread_pool.h"          // ThreadPool 类（并行读取六个面）
 
 // ============================================================================
 // 辅助函数：加载立方体贴图
 // ============================================================================
+// 驱动支持块压缩时，六个面并行读取（或生成）压缩纹理缓存（见 common/compressed_texture.h）
+// 各个面交给 TextureStreamer 分帧上传（见 common/texture_streamer.h），六个面都上传后才能采样
+// ============================================================================
+static bool loadCompressedCubemap(unsigned int textureID, const std::vector<std::string>& faces)
+{
+    unsigned int support = CompressedTextureCache::support();
+    if (!support || faces.size() != 6)
+        return false;
+
+    int flip = stbi_get_flip_vertically_on_load();
+    unsigned int flags = flip ? TEXTURE_FLAG_FLIP : TEXTURE_FLAG_NONE;
+    std::vector<CompressedImage> images(faces.size());
+    std::vector<char> loaded(faces.size(), 0);
+    ThreadPool::Instance().parallelFor(faces.size(), [&](size_t i) {
+        loaded[i] = CompressedTextureCache::loadOrCook(faces[i], flags, support, false, images[i]);
+    });
+
+    // 六个面的格式和尺寸必须一致
+    for (size_t i = 0; i < images.size(); i++)
+    {
+        if (!loaded[i] || images[i].format != images[0].format ||
+            images[i].levels[0].width != images[0].levels[0].width ||
+            images[i].levels[0].height != images[0].levels[0].height)
+            return false;
+    }
+    for (size_t i = 0; i < images.size(); i++)
+        TextureStreamer::Instance().enqueue(textureID, std::move(images[i]),
+                                            GL_TEXTURE_CUBE_MAP_POSITIVE_X + static_cast<GLenum>(i));
+    return true;
+}
+
 static unsigned int loadCubemap(std::vector<std::string> faces)
 {
     unsigned int textureID;
@@ -31,20 +66,19 @@ static unsigned int loadCubemap(std::vector<std::string> faces)
     glBindTexture(GL_TEXTURE_CUBE_MAP, textureID);
 
     int width, height, nrChannels;
-    for (unsigned int i = 0; i < faces.size(); i++)
+    bool compressed = loadCompressedCubemap(textureID, faces);
+    for (unsigned int i = 0; !compressed && i < faces.size(); i++)
     {
         unsigned char *data = stbi_load(faces[i].c_str(), &width, &height, &nrChannels, 0);
         if (data)
         {
-            GLenum format;
-            if (nrChannels == 1)
-                format = GL_RED;
-            else if (nrChannels == 3)
-                format = GL_RGB;
-            else if (nrChannels == 4)
-                format = GL_RGBA;
-
-            glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
+            // 只有一级的 mip 链
+            MipChain face;
+            face.components = nrChannels;
+            face.levels.push_back({ width, height, 0, size_t(width) * height * nrChannels });
+            face.data.assign(data, data + face.levels[0].size);
+            TextureStreamer::Instance().enqueue(textureID, std::move(face), nrChannels, TEXTURE_FLAG_NONE,
+                                                GL_TEXTURE_CUBE_MAP_POSITIVE_X + i);
             stbi_image_free(data);
         }
         else
@@ -87,14 +121,14 @@ protected:
         glEnable(GL_DEPTH_TEST);
         glDepthFunc(GL_LESS);
 
-        // 创建着色器程序
+        // 提交着色器程序（只提交不等待，编译和下面的立方体贴图加载重叠进行）
         std::string cubemapVertexPath = std::string(PROJECT_ROOT) + "/engine/src/lesson/lesson17/6.2.cubemaps.vs";
         std::string cubemapFragmentPath = std::string(PROJECT_ROOT) + "/engine/src/lesson/lesson17/6.2.cubemaps.fs";
-        m_shader = new Shader(cubemapVertexPath.c_str(), cubemapFragmentPath.c_str());
+        m_shader = m_shaders.submit(cubemapVertexPath, cubemapFragmentPath);
 
         std::string skyboxVertexPath = std::string(PROJECT_ROOT) + "/engine/src/lesson/lesson17/6.2.skybox.vs";
         std::string skyboxFragmentPath = std::string(PROJECT_ROOT) + "/engine/src/lesson/lesson17/6.2.skybox.fs";
-        m_skyboxShader = new Shader(skyboxVertexPath.c_str(), skyboxFragmentPath.c_str());
+        m_skyboxShader = m_shaders.submit(skyboxVertexPath, skyboxFragmentPath);
 
         // 设置顶点数据
         SetupVertices();
@@ -102,6 +136,9 @@ protected:
         // 加载立方体贴图
         LoadCubemap();
         
+        // 等待着色器编译完成（之后才能设置 uniform）
+        m_shaders.finishAll();
+        
         // 配置着色器
         m_shader->use();
         m_shader->setInt("skybox", 0);
@@ -184,8 +221,7 @@ protected:
         glDeleteBuffers(1, &m_cubeVBO);
         glDeleteBuffers(1, &m_skyboxVBO);
         glDeleteTextures(1, &m_cubemapTexture);
-        delete m_shader;
-        delete m_skyboxShader;
+        m_shaders.clear();
     }
 
 private:
@@ -336,6 +372,7 @@ private:
     // ========================================================================
     Shader* m_shader;
     Shader* m_skyboxShader;
+    ShaderLibrary m_shaders;    // 持有上面两个着色器
     unsigned int m_cubeVAO, m_skyboxVAO;
     unsigned int m_cubeVBO, m_skyboxVBO;
     unsigned int m_cubemapTexture;
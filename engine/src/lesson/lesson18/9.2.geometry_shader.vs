@@ -2,6 +2,7 @@
 layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec3 aNormal;
 layout (location = 2) in vec2 aTexCoord;
+layout (location = 8) in mat4 aInstanceMatrix;   // 网格所在节点的变换（Model 实例化绘制）
 
 out vec3 vPos;
 out vec3 vNormal;
@@ -13,8 +14,9 @@ uniform mat4 projection;
 
 void main()
 {
-    vPos = aPos;
-    vNormal = aNormal;
+    // 几何着色器再乘 model，这里只变换到模型根节点的空间
+    vPos = (aInstanceMatrix * vec4(aPos, 1.0)).xyz;
+    vNormal = mat3(transpose(inverse(aInstanceMatrix))) * aNormal;
     vTexCoord = aTexCoord;
-    gl_Position = projection * view * model * vec4(aPos, 1.0);
+    gl_Position = projection * view * model * vec4(vPos, 1.0);
 }
@@ -2,6 +2,7 @@
 layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec3 aNormal;
 layout (location = 2) in vec2 aTexCoord;
+layout (location = 8) in mat4 aInstanceMatrix;   // 网格所在节点的变换（Model 实例化绘制）
 
 out vec2 TexCoord;
 
@@ -12,5 +13,5 @@ uniform mat4 projection;
 void main()
 {
     TexCoord = aTexCoord;
-    gl_Position = projection * view * model * vec4(aPos, 1.0);
+    gl_Position = projection * view * model * aInstanceMatrix * vec4(aPos, 1.0);
 }
@@ -2,6 +2,7 @@
 layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec3 aNormal;
 layout (location = 2) in vec2 aTexCoord;
+layout (location = 8) in mat4 aInstanceMatrix;   // 网格所在节点的变换（Model 实例化绘制）
 
 out vec3 vPos;
 out vec3 vNormal;
@@ -12,7 +13,8 @@ uniform mat4 projection;
 
 void main()
 {
-    vPos = (model * vec4(aPos, 1.0)).xyz;
-    vNormal = mat3(transpose(inverse(model))) * aNormal;
-    gl_Position = projection * view * model * vec4(aPos, 1.0);
+    mat4 world = model * aInstanceMatrix;
+    vPos = (world * vec4(aPos, 1.0)).xyz;
+    vNormal = mat3(transpose(inverse(world))) * aNormal;
+    gl_Position = projection * view * world * vec4(aPos, 1.0);
 }
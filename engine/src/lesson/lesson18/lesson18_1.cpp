@@ -81,6 +81,8 @@ protected:
         m_shader->setMat4("model", model);
         m_shader->setFloat("time", GetTime());
 
+        // 模型在屏幕上的大小决定纹理需要的清晰度（见 common/texture_residency.h）
+        m_model->SetScreenSize(model, view, projection, m_height);
         m_model->Draw(*m_shader);
     }
 
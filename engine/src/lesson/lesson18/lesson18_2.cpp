@@ -83,6 +83,8 @@ protected:
         m_defaultShader->setMat4("projection", projection);
         m_defaultShader->setMat4("view", view);
         m_defaultShader->setMat4("model", model);
+        // 模型在屏幕上的大小决定纹理需要的清晰度（见 common/texture_residency.h）
+        m_model->SetScreenSize(model, view, projection, m_height);
         m_model->Draw(*m_defaultShader);
 
         // 2. 用法线可视化着色器绘制法线线段（叠加）
@@ -18,6 +18,7 @@
 #include <string>
 #include "common/camera_application.h"  // CameraApplication 基类
 #include "common/shader.h"               // Shader 类
+#include "common/texture_loader.h"       // LoadTextureFile（共享纹理、压缩纹理缓存、CPU mipmap）
 
 // ============================================================================
 // Lesson6Application 类 - 继承自 CameraApplication
@@ -120,7 +121,7 @@ protected:
     {
         glDeleteVertexArrays(1, &m_VAO);
         glDeleteBuffers(1, &m_VBO);
-        glDeleteTextures(1, &m_texture1);
+        TextureCache::Instance().release(m_texture1);
         glDeleteTextures(1, &m_texture2);
         delete m_shader;
     }
@@ -226,42 +227,8 @@ private:
     // ========================================================================
     unsigned int LoadTexture(const char* path, bool flipVertically = true)
     {
-        unsigned int textureID;
-        glGenTextures(1, &textureID);
-        
-        int width, height, nrChannels;
-        stbi_set_flip_vertically_on_load(flipVertically);
-        unsigned char *data = stbi_load(path, &width, &height, &nrChannels, 0);
-        
-        if (data)
-        {
-            GLenum format;
-            if (nrChannels == 1)
-                format = GL_RED;
-            else if (nrChannels == 3)
-                format = GL_RGB;
-            else if (nrChannels == 4)
-                format = GL_RGBA;
-            
-            glBindTexture(GL_TEXTURE_2D, textureID);
-            glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-            glGenerateMipmap(GL_TEXTURE_2D);
-            
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-            
-            stbi_image_free(data);
-        }
-        else
-        {
-            std::cout << "Failed to load texture: " << path << std::endl;
-            glDeleteTextures(1, &textureID);
-            return 0;
-        }
-        
-        return textureID;
+        // 共享、压缩纹理缓存和 mipmap 生成见 common/texture_loader.h
+        return LoadTextureFile(path, flipVertically ? TEXTURE_FLAG_FLIP : TEXTURE_FLAG_NONE);
     }
 
     // ========================================================================
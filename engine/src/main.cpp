@@ -2,14 +2,33 @@
 // OpenGL 学习项目 - 主入口
 // ============================================================================
 // 这个文件是程序的主入口，用于选择运行哪个 lesson
+// 也支持命令行基准测试模式：
+//   OpenGLLearning --bench <lesson> [--frames N] [--resolution WxH] [--out file.json|file.csv] [--windowed]
+//                  [--cold]（运行前清空着色器程序二进制缓存、模型缓存和压缩纹理缓存，测量冷启动）
+//                  [--no-batching]（关闭 Model 的 MultiDraw 批处理，对比绘制调用次数）
+//   OpenGLLearning --mip-bench [image] [--iterations N]（对比 CPU 生成 mipmap 和 glGenerateMipmap 的吞吐量）
 // ============================================================================
 
 #include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <chrono>
+#include <functional>
 #include <string>
 #include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <termios.h>
 #include <unistd.h>
 
+#include "common/application.h"
+#include "common/camera_application.h"
+#include "common/compressed_texture.h"
+#include "common/frame_profiler.h"
+#include "common/mip_generator.h"
+#include "common/model_cache.h"
+#include "common/program_cache.h"
+#include "common/texture_loader.h"
 #include "lesson/test/test.h"
 
 // 声明各个 lesson 的主函数
@@ -40,6 +59,267 @@ extern int lesson17_1_main();
 extern int lesson18_1_main();
 extern int lesson18_2_main();
 
+// ============================================================================
+// 可进行基准测试的 lesson（基于 Application 类的 lesson，键名与菜单输入一致）
+// ============================================================================
+struct BenchLesson {
+    const char* key;
+    int (*run)();
+};
+
+static const BenchLesson BENCH_LESSONS[] = {
+    {"6-1",  lesson6_1_oop_main},
+    {"7",    lesson7_1_main},
+    {"8",    lesson8_1_main},
+    {"8-2",  lesson8_2_main},
+    {"9",    lesson9_1_main},
+    {"10",   lesson10_1_main},
+    {"11",   lesson11_1_main},
+    {"11-2", lesson11_2_main},
+    {"11-3", lesson11_3_main},
+    {"12",   lesson12_1_main},
+    {"12-2", lesson12_2_main},
+    {"12-3", lesson12_3_main},
+    {"13-1", lesson13_1_main},
+    {"13-2", lesson13_2_main},
+    {"14",   lesson14_1_main},
+    {"15",   lesson15_1_main},
+    {"16",   lesson16_1_main},
+    {"17",   lesson17_1_main},
+    {"18",   lesson18_1_main},
+    {"18-2", lesson18_2_main},
+};
+
+// ============================================================================
+// 基准测试模式
+// ============================================================================
+// 无头模式（默认）下以固定时间步长渲染 N 帧，相机沿脚本化路径运动，
+// 记录每帧 CPU 时间、GPU 时间和绘制调用次数，输出 JSON 或 CSV 报告
+// ============================================================================
+static void printBenchUsage()
+{
+    std::cout << "用法: OpenGLLearning --bench <lesson> [--frames N] [--resolution WxH]"
+                 " [--out file.json|file.csv] [--windowed] [--cold] [--no-batching]\n";
+    std::cout << "可用 lesson:";
+    for (const BenchLesson& lesson : BENCH_LESSONS)
+        std::cout << ' ' << lesson.key;
+    std::cout << std::endl;
+}
+
+static int runBenchmark(int argc, char** argv)
+{
+    std::string lessonKey;
+    std::string outPath;
+    unsigned int frames = 300;
+    unsigned int width = 800;
+    unsigned int height = 600;
+    bool headless = true;
+    bool cold = false;
+    bool batching = true;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--bench" && hasValue)
+            lessonKey = argv[++i];
+        else if (arg == "--frames" && hasValue)
+            frames = static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 10));
+        else if (arg == "--resolution" && hasValue)
+        {
+            if (std::sscanf(argv[++i], "%ux%u", &width, &height) != 2)
+            {
+                std::cout << "无效的分辨率: " << argv[i] << std::endl;
+                return 1;
+            }
+        }
+        else if (arg == "--out" && hasValue)
+            outPath = argv[++i];
+        else if (arg == "--windowed")
+            headless = false;
+        else if (arg == "--cold")
+            cold = true;
+        else if (arg == "--no-batching")
+            batching = false;
+        else
+        {
+            printBenchUsage();
+            return 1;
+        }
+    }
+
+    const BenchLesson* lesson = nullptr;
+    for (const BenchLesson& candidate : BENCH_LESSONS)
+    {
+        if (lessonKey == candidate.key)
+            lesson = &candidate;
+    }
+    if (!lesson || frames == 0 || width == 0 || height == 0)
+    {
+        printBenchUsage();
+        return 1;
+    }
+
+    // 配置之后构造的 lesson 应用
+    Application::SetHeadlessDefault(headless, frames);
+    Application::SetResolutionDefault(width, height);
+    CameraApplication::SetScriptedCameraDefault(true);
+
+    // 冷启动：删除程序二进制缓存、模型缓存和压缩纹理缓存，所有着色器都要重新编译，
+    // 模型都要用 Assimp 导入，纹理都要重新压缩
+    if (cold)
+    {
+        ProgramCache::clear();
+        ModelCache::clear();
+        CompressedTextureCache::clear();
+    }
+
+    // 关闭批处理：Model 逐个网格绘制（见 common/model.h）
+    if (!batching)
+        setenv("OPENGL_MODEL_BATCHING", "0", 1);
+
+    FrameProfiler profiler;
+    FrameProfiler::SetActive(&profiler);
+    int result = lesson->run();
+    FrameProfiler::SetActive(nullptr);
+
+    if (result != 0 || profiler.GetSamples().empty())
+    {
+        std::cout << "基准测试失败: lesson " << lesson->key << std::endl;
+        return 1;
+    }
+
+    // 默认输出到 benchmark_<lesson>.json，扩展名为 .csv 时输出 CSV
+    if (outPath.empty())
+        outPath = std::string("benchmark_") + lesson->key + ".json";
+    std::ofstream out(outPath);
+    if (!out)
+    {
+        std::cout << "无法写入结果文件: " << outPath << std::endl;
+        return 1;
+    }
+    bool csv = outPath.size() >= 4 && outPath.compare(outPath.size() - 4, 4, ".csv") == 0;
+    if (csv)
+        profiler.WriteCsv(out, lesson->key, width, height);
+    else
+        profiler.WriteJson(out, lesson->key, width, height);
+
+    FrameStats cpu = profiler.CpuStats();
+    FrameStats gpu = profiler.GpuStats();
+    FrameStats draws = profiler.DrawCallStats();
+    const StartupSample& startup = profiler.GetStartup();
+    std::cout << "lesson " << lesson->key << ": " << profiler.GetSamples().size() << " 帧"
+              << ", CPU p50/p95/p99 = " << cpu.p50 << "/" << cpu.p95 << "/" << cpu.p99 << " ms"
+              << ", GPU p50/p95/p99 = " << gpu.p50 << "/" << gpu.p95 << "/" << gpu.p99 << " ms"
+              << ", 绘制调用 p50 = " << draws.p50 << (batching ? "" : "（未批处理）")
+              << ", 启动 " << startup.initMs << " ms（着色器 " << startup.shaderMs << " ms, "
+              << (startup.shaderCacheMisses == 0 ? "热" : "冷") << "缓存 命中/未命中 = "
+              << startup.shaderCacheHits << "/" << startup.shaderCacheMisses << "）"
+              << ", 结果: " << outPath << std::endl;
+    return 0;
+}
+
+// ============================================================================
+// mipmap 生成基准测试
+// ============================================================================
+// 在无头上下文中对比 MipGenerator 的各种滤波选项和 glTexImage2D + glGenerateMipmap，
+// 吞吐量按第 0 级的 RGBA 字节数计算（MB/s）
+// ============================================================================
+class MipBenchApplication : public Application
+{
+public:
+    MipBenchApplication(const std::string& imagePath, unsigned int iterations)
+        : Application(64, 64, "Mipmap Benchmark", true), m_imagePath(imagePath), m_iterations(iterations), m_succeeded(false) {}
+
+    bool Succeeded() const { return m_succeeded; }
+
+protected:
+    void OnInitialize() override
+    {
+        int width, height, channels;
+        unsigned char* pixels = stbi_load(m_imagePath.c_str(), &width, &height, &channels, STBI_rgb_alpha);
+        if (!pixels)
+        {
+            std::cout << "无法读取图片: " << m_imagePath << std::endl;
+            return;
+        }
+
+        double megabytes = double(width) * height * 4 / (1024.0 * 1024.0);
+        std::cout << "mipmap 基准测试: " << m_imagePath << "（" << width << "x" << height << " RGBA, "
+                  << MipGenerator::simdName() << ", " << ThreadPool::Instance().size() + 1 << " 线程, "
+                  << m_iterations << " 次）" << std::endl;
+
+        // 先执行一次预热，再取平均耗时
+        auto measure = [&](const char* name, const std::function<void()>& fn) {
+            fn();
+            auto start = std::chrono::steady_clock::now();
+            for (unsigned int i = 0; i < m_iterations; i++)
+                fn();
+            double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count()
+                        / m_iterations;
+            std::cout << "  " << std::left << std::setw(32) << name << std::right << std::fixed << std::setprecision(2)
+                      << std::setw(9) << ms << " ms " << std::setw(10) << megabytes * 1000.0 / ms << " MB/s" << std::endl;
+        };
+
+        MipOptions box, boxSrgb, kaiser, kaiserSrgb, coverage;
+        boxSrgb.srgb = kaiserSrgb.srgb = true;
+        kaiser.filter = kaiserSrgb.filter = MIP_FILTER_KAISER;
+        coverage.preserveAlphaCoverage = true;
+        MipChain chain;
+        measure("CPU box", [&] { MipGenerator::generate(pixels, width, height, 4, box, chain); });
+        measure("CPU box (sRGB)", [&] { MipGenerator::generate(pixels, width, height, 4, boxSrgb, chain); });
+        measure("CPU Kaiser", [&] { MipGenerator::generate(pixels, width, height, 4, kaiser, chain); });
+        measure("CPU Kaiser (sRGB)", [&] { MipGenerator::generate(pixels, width, height, 4, kaiserSrgb, chain); });
+        measure("CPU box + alpha coverage", [&] { MipGenerator::generate(pixels, width, height, 4, coverage, chain); });
+
+        // 上传并等待 GPU 完成，两种方式都包含第 0 级的上传
+        unsigned int texture;
+        glGenTextures(1, &texture);
+        measure("CPU box + upload", [&] {
+            MipGenerator::generate(pixels, width, height, 4, box, chain);
+            UploadTextureChain(texture, chain, 4, TEXTURE_FLAG_NONE);
+            glFinish();
+        });
+        measure("glTexImage2D + glGenerateMipmap", [&] {
+            glBindTexture(GL_TEXTURE_2D, texture);
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+            glGenerateMipmap(GL_TEXTURE_2D);
+            glFinish();
+        });
+        glDeleteTextures(1, &texture);
+
+        stbi_image_free(pixels);
+        m_succeeded = true;
+    }
+
+private:
+    std::string m_imagePath;
+    unsigned int m_iterations;
+    bool m_succeeded;
+};
+
+static int runMipBenchmark(int argc, char** argv)
+{
+    std::string imagePath = std::string(PROJECT_ROOT) + "/engine/assets/texture/lesson/container2.png";
+    unsigned int iterations = 20;
+    for (int i = 2; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg == "--iterations" && i + 1 < argc)
+            iterations = std::max(1u, static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 10)));
+        else
+            imagePath = arg;
+    }
+
+    MipBenchApplication app(imagePath, iterations);
+    if (!app.Initialize())
+    {
+        std::cout << "Failed to initialize application" << std::endl;
+        return 1;
+    }
+    return app.Succeeded() ? 0 : 1;
+}
+
 // ============================================================================
 // 显示菜单
 // ============================================================================
@@ -91,7 +371,13 @@ std::string getUserInput() {
 // ============================================================================
 // 主函数
 // ============================================================================
-int main() {
+int main(int argc, char** argv) {
+    // 命令行基准测试模式
+    if (argc > 1 && std::strcmp(argv[1], "--mip-bench") == 0)
+        return runMipBenchmark(argc, argv);
+    if (argc > 1)
+        return runBenchmark(argc, argv);
+
     int choice = -1;
     
     while (true) {
@@ -0,0 +1,198 @@
+// ============================================================================
+// MeshOptimizer 测试（common/mesh_optimizer.h）
+// ============================================================================
+// 纯 CPU 测试，不需要 OpenGL 上下文：
+//   - 重排后三角形的集合不变（允许三角形内顶点旋转，但绕序不能变）
+//   - optimizeVertexCache 之后 ACMR 不会变差
+//   - optimizeVertexFetch 之后索引都在范围内，并且指向原来的顶点数据
+//   - 退化输入：空网格、单个三角形、没有被引用的顶点
+// 全部通过时返回 0，否则打印失败的检查并返回 1
+// ============================================================================
+
+#include "common/mesh_optimizer.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+namespace
+{
+    int s_failures = 0;
+
+    void check(bool condition, const char* test, const char* what)
+    {
+        if (!condition)
+        {
+            std::printf("FAILED %s: %s\n", test, what);
+            s_failures++;
+        }
+    }
+
+    // 三角形的多重集合：每个三角形旋转到最小的顶点在前（保持绕序），再整体排序
+    std::vector<std::array<unsigned int, 3>> triangleSet(const std::vector<unsigned int>& indices)
+    {
+        std::vector<std::array<unsigned int, 3>> triangles;
+        for (size_t i = 0; i + 2 < indices.size(); i += 3)
+        {
+            std::array<unsigned int, 3> triangle = { indices[i], indices[i + 1], indices[i + 2] };
+            std::rotate(triangle.begin(), std::min_element(triangle.begin(), triangle.end()), triangle.end());
+            triangles.push_back(triangle);
+        }
+        std::sort(triangles.begin(), triangles.end());
+        return triangles;
+    }
+
+    // size x size 个格子的网格（每格两个三角形），三角形顺序随机打乱
+    std::vector<unsigned int> shuffledGrid(unsigned int size, size_t& vertexCount)
+    {
+        std::vector<std::array<unsigned int, 3>> triangles;
+        unsigned int row = size + 1;
+        for (unsigned int y = 0; y < size; y++)
+        {
+            for (unsigned int x = 0; x < size; x++)
+            {
+                unsigned int v = y * row + x;
+                triangles.push_back({ v, v + 1, v + row });
+                triangles.push_back({ v + 1, v + row + 1, v + row });
+            }
+        }
+        std::mt19937 random(42);
+        std::shuffle(triangles.begin(), triangles.end(), random);
+
+        std::vector<unsigned int> indices;
+        for (const auto& triangle : triangles)
+            indices.insert(indices.end(), triangle.begin(), triangle.end());
+        vertexCount = size_t(row) * row;
+        return indices;
+    }
+
+    // 顶点数据用编号本身，方便检查 optimizeVertexFetch 之后索引指向的是不是原来的顶点
+    std::vector<glm::vec3> numberedVertices(size_t count)
+    {
+        std::vector<glm::vec3> vertices;
+        for (size_t i = 0; i < count; i++)
+            vertices.push_back(glm::vec3(float(i), float(i % 7), float(i % 13)));
+        return vertices;
+    }
+
+    // optimizeVertexFetch 之后：索引在范围内、每个角的顶点数据与原来相同、没有多余的顶点
+    void checkVertexFetch(const char* test, std::vector<glm::vec3> vertices, std::vector<unsigned int> indices)
+    {
+        const std::vector<glm::vec3> originalVertices = vertices;
+        const std::vector<unsigned int> originalIndices = indices;
+        size_t referenced = MeshOptimizer::analyzeVertexCache(indices, vertices.size()).vertices;
+
+        size_t count = MeshOptimizer::optimizeVertexFetch(vertices, indices);
+        check(count == vertices.size(), test, "returned vertex count matches vertices.size()");
+        check(count == referenced, test, "unreferenced vertices are removed");
+        check(indices.size() == originalIndices.size(), test, "index count unchanged");
+
+        bool inRange = true, sameData = true, firstUseOrder = true;
+        unsigned int next = 0;
+        for (size_t i = 0; i < indices.size(); i++)
+        {
+            if (indices[i] >= vertices.size())
+            {
+                inRange = false;
+                continue;
+            }
+            sameData = sameData && vertices[indices[i]] == originalVertices[originalIndices[i]];
+            if (indices[i] == next)
+                next++;
+            else
+                firstUseOrder = firstUseOrder && indices[i] < next;
+        }
+        check(inRange, test, "indices are within the new vertex range");
+        check(sameData, test, "every index refers to the same vertex data as before");
+        check(firstUseOrder, test, "vertices are ordered by first use");
+    }
+
+    void testGrid()
+    {
+        const char* test = "grid";
+        size_t vertexCount = 0;
+        std::vector<unsigned int> indices = shuffledGrid(32, vertexCount);
+        const std::vector<unsigned int> original = indices;
+        double before = MeshOptimizer::analyzeVertexCache(indices, vertexCount).acmr();
+
+        MeshOptimizer::optimizeVertexCache(indices, vertexCount);
+        double after = MeshOptimizer::analyzeVertexCache(indices, vertexCount).acmr();
+        check(triangleSet(indices) == triangleSet(original), test, "optimizeVertexCache keeps the triangle set");
+        check(after <= before, test, "optimizeVertexCache does not make ACMR worse");
+        std::printf("grid: ACMR %.3f -> %.3f\n", before, after);
+
+        // 过度绘制优化只移动簇，三角形集合不变
+        std::vector<glm::vec3> vertices = numberedVertices(vertexCount);
+        MeshOptimizer::optimizeOverdraw(indices, vertices.data(), sizeof(glm::vec3));
+        check(triangleSet(indices) == triangleSet(original), test, "optimizeOverdraw keeps the triangle set");
+
+        checkVertexFetch(test, vertices, indices);
+    }
+
+    void testEmpty()
+    {
+        const char* test = "empty";
+        std::vector<unsigned int> indices;
+        std::vector<glm::vec3> vertices;
+        VertexCacheStats stats = MeshOptimizer::analyzeVertexCache(indices, 0);
+        check(stats.triangles == 0 && stats.misses == 0, test, "no triangles and no misses");
+        check(stats.acmr() == 0.0 && stats.atvr() == 0.0, test, "ACMR/ATVR are 0");
+
+        MeshOptimizer::optimizeVertexCache(indices, 0);
+        MeshOptimizer::optimizeOverdraw(indices, vertices.data(), sizeof(glm::vec3));
+        check(indices.empty(), test, "indices stay empty");
+        check(MeshOptimizer::optimizeVertexFetch(vertices, indices) == 0, test, "no vertices left");
+    }
+
+    void testSingleTriangle()
+    {
+        const char* test = "single triangle";
+        std::vector<unsigned int> indices = { 2, 0, 1 };
+        const std::vector<unsigned int> original = indices;
+
+        MeshOptimizer::optimizeVertexCache(indices, 3);
+        check(triangleSet(indices) == triangleSet(original), test, "optimizeVertexCache keeps the triangle");
+        check(MeshOptimizer::analyzeVertexCache(indices, 3).misses == 3, test, "three misses");
+
+        std::vector<glm::vec3> vertices = numberedVertices(3);
+        MeshOptimizer::optimizeOverdraw(indices, vertices.data(), sizeof(glm::vec3));
+        check(triangleSet(indices) == triangleSet(original), test, "optimizeOverdraw keeps the triangle");
+
+        checkVertexFetch(test, vertices, indices);
+    }
+
+    void testUnreferencedVertices()
+    {
+        const char* test = "unreferenced vertices";
+        // 顶点 0、3、6、9 没有被引用（包括第一个顶点和最后一个顶点）
+        size_t vertexCount = 10;
+        std::vector<unsigned int> indices = { 1, 2, 4, 4, 2, 5, 7, 8, 5, 5, 8, 1 };
+        const std::vector<unsigned int> original = indices;
+        double before = MeshOptimizer::analyzeVertexCache(indices, vertexCount).acmr();
+
+        MeshOptimizer::optimizeVertexCache(indices, vertexCount);
+        check(triangleSet(indices) == triangleSet(original), test, "optimizeVertexCache keeps the triangle set");
+        check(MeshOptimizer::analyzeVertexCache(indices, vertexCount).acmr() <= before, test,
+              "optimizeVertexCache does not make ACMR worse");
+
+        checkVertexFetch(test, numberedVertices(vertexCount), indices);
+    }
+}
+
+int main()
+{
+    testGrid();
+    testEmpty();
+    testSingleTriangle();
+    testUnreferencedVertices();
+
+    if (s_failures)
+    {
+        std::printf("%d check(s) failed\n", s_failures);
+        return 1;
+    }
+    std::printf("all MeshOptimizer tests passed\n");
+    return 0;
+}